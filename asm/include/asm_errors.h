@@ -21,6 +21,9 @@ enum asm_error_t {
     ASM_NO_LABEL                = 16,
     ASM_UNABLE_READ_ARGUMENT    = 17,
     ASM_MEMSET_ERROR            = 18,
+    ASM_DATA_ERROR              = 19,
+    ASM_BRANCH_PROFILE_ERROR    = 20,
+    ASM_COVERAGE_ERROR          = 21,
 };
 
 #endif
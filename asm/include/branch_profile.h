@@ -0,0 +1,16 @@
+#ifndef BRANCH_PROFILE_H
+#define BRANCH_PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "asm_errors.h"
+#include "source_lines.h"
+#include "spu_facilities.h"
+
+asm_error_t branch_profile_print(command_lines_t *command_lines,
+                                 const char      *profile_filename,
+                                 const char      *source_filename,
+                                 address_t        code_size);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef COVERAGE_LISTING_H
+#define COVERAGE_LISTING_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "asm_errors.h"
+#include "source_lines.h"
+#include "spu_facilities.h"
+
+asm_error_t coverage_print_listing(command_lines_t *command_lines,
+                                   const char      *coverage_filename,
+                                   const char      *source_code,
+                                   size_t           source_size,
+                                   const command_t *code,
+                                   address_t        code_size);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef DATA_H
+#define DATA_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "asm_errors.h"
+#include "spu_facilities.h"
+
+struct data_segment_t;
+
+//RAM initializer, which is filled by data directives. address is RAM cell
+//where the next value is placed, end is the first cell after all segments
+struct ram_data_t {
+    data_segment_t *segments;
+    size_t          segments_number;
+    size_t          segments_size;
+    argument_t     *values;
+    size_t          values_number;
+    size_t          values_size;
+    address_t       address;
+    address_t       end;
+};
+
+asm_error_t data_init        (ram_data_t *data);
+asm_error_t data_set_address (ram_data_t *data,
+                              address_t   address);
+asm_error_t data_add_double  (ram_data_t *data,
+                              argument_t  value);
+asm_error_t data_add_fill    (ram_data_t *data,
+                              address_t   cells_number,
+                              argument_t  value);
+uint64_t    data_size        (ram_data_t *data);
+asm_error_t data_write       (ram_data_t *data,
+                              FILE       *output_file);
+
+#endif
@@ -31,5 +31,8 @@ asm_error_t code_add_label                 (labels_array_t *labels_array,
                                             char           *label_name,
                                             address_t       instruction_pointer,
                                             bool            is_defined);
+uint64_t    labels_symbols_number          (labels_array_t *labels_array);
+asm_error_t write_labels_symbols           (labels_array_t *labels_array,
+                                            FILE           *output_file);
 
 #endif
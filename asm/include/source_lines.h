@@ -0,0 +1,32 @@
+#ifndef SOURCE_LINES_H
+#define SOURCE_LINES_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "asm_errors.h"
+#include "spu_facilities.h"
+
+//source lines of commands, they are collected only if profile or coverage
+//is read back by assembler. commands are added in order of code addresses
+struct command_line_t {
+    address_t site;
+    command_t command;
+    size_t    line;
+};
+
+struct command_lines_t {
+    command_line_t *lines;
+    size_t          lines_number;
+    size_t          lines_size;
+};
+
+asm_error_t     command_lines_init(command_lines_t *command_lines);
+asm_error_t     command_lines_add (command_lines_t *command_lines,
+                                   address_t        site,
+                                   command_t        command,
+                                   size_t           line);
+command_line_t *command_lines_find(command_lines_t *command_lines,
+                                   address_t        site);
+
+#endif
@@ -11,6 +11,8 @@
 #include "utils.h"
 #include "asm.h"
 #include "compiler.h"
+#include "branch_profile.h"
+#include "coverage_listing.h"
 
 /**
 ======================================================================================================
@@ -20,12 +22,21 @@
 */
 static const char *default_output_filename = "a.bin";
 
+/**
+======================================================================================================
+     @brief     Size of chunks of arena which keeps source, output code, labels and fixups.
+
+======================================================================================================
+*/
+static const size_t code_arena_chunk_size = 64 * 1024;
+
 //====================================================================================================
 //FUNCTIONS PROTOTYPES
 //====================================================================================================
 static asm_error_t parse_flags      (code_t     *code,
                                      int         argc,
                                      const char *argv[]);
+static asm_error_t init_code_memory (code_t     *code);
 static asm_error_t read_source_code (code_t     *code);
 static asm_error_t write_code       (code_t     *code);
 static asm_error_t destroy_code     (code_t     *code);
@@ -54,6 +65,10 @@ int main(int argc, const char *argv[]) {
         destroy_code(&code);
         return EXIT_FAILURE;
     }
+    if((error_code = init_code_memory(&code)            ) != ASM_SUCCESS) {
+        destroy_code(&code);
+        return EXIT_FAILURE;
+    }
     if((error_code = read_source_code(&code)            ) != ASM_SUCCESS) {
         destroy_code(&code);
         return EXIT_FAILURE;
@@ -66,6 +81,24 @@ int main(int argc, const char *argv[]) {
         destroy_code(&code);
         return EXIT_FAILURE;
     }
+    if(code.branch_profile_filename != NULL &&
+       (error_code = branch_profile_print(&code.command_lines,
+                                          code.branch_profile_filename,
+                                          code.input_filename,
+                                          code.output_code_size)) != ASM_SUCCESS) {
+        destroy_code(&code);
+        return EXIT_FAILURE;
+    }
+    if(code.coverage_filename != NULL &&
+       (error_code = coverage_print_listing(&code.command_lines,
+                                            code.coverage_filename,
+                                            code.source_code,
+                                            code.source_size,
+                                            code.output_code,
+                                            code.output_code_size)) != ASM_SUCCESS) {
+        destroy_code(&code);
+        return EXIT_FAILURE;
+    }
 
     destroy_code(&code);
     return EXIT_SUCCESS;
@@ -75,10 +108,17 @@ int main(int argc, const char *argv[]) {
 ======================================================================================================
     @brief      Parses flags from console.
 
-    @details    There are only two variants:
-                1. asm 'source'
-                2. asm 'source' -o 'output'
-                Default output file name is 'a.bin'
+    @details    asm 'source' [-o 'output'] [-g] [--ram-size N] [--stack-size N]
+                    [--branch-profile 'file'] [--coverage 'file'] [--mem-stats]
+                Default output file name is 'a.bin'.
+                '-g' writes labels to binary as symbols for profilers.
+                '--branch-profile' prints profile from 'run --branch-profile' by source lines.
+                '--coverage' prints source listing where lines which were never run
+                by 'run --coverage' are marked.
+                '--ram-size' writes number of RAM cells which program needs to header.
+                '--stack-size' writes capacity of stacks which program needs to header,
+                e.g. for deep recursion.
+                '--mem-stats' prints memory statistics after assembling.
 
     @param [in] code                Code structure.
     @param [in] argc                Number of arguments typed in by user.
@@ -93,32 +133,101 @@ asm_error_t parse_flags(code_t     *code,
                         const char *argv[]) {
     C_ASSERT(code != NULL, return ASM_NULL_CODE);
 
-    if(argc <= 1) {
-        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                     "No input files.\r\n");
-        return ASM_NO_INPUT_FILES;
-    }
-    if(argc == 2) {
-        code->input_filename  = argv[1];
-        code->output_filename = default_output_filename;
-        return ASM_SUCCESS;
-    }
-    if(argc == 4) {
-        if(strcmp(argv[2], "-o") != 0) {
+    code->output_filename = default_output_filename;
+
+    for(int arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+            code->output_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "--mem-stats") == 0) {
+            code->print_memory_stats = true;
+        }
+        else if(strcmp(argv[arg], "-g") == 0) {
+            code->write_symbols = true;
+        }
+        else if(strcmp(argv[arg], "--branch-profile") == 0 && arg + 1 < argc) {
+            code->branch_profile_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "--coverage") == 0 && arg + 1 < argc) {
+            code->coverage_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "--ram-size") == 0) {
+            char *end = NULL;
+            if(arg + 1 >= argc ||
+               (code->ram_size = strtoull(argv[arg + 1], &end, 10)) == 0 ||
+               *end != '\0') {
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "Flag '--ram-size' expected to have positive number after it.\r\n");
+                return ASM_FLAGS_ERROR;
+            }
+            arg++;
+        }
+        else if(strcmp(argv[arg], "--stack-size") == 0) {
+            char *end = NULL;
+            if(arg + 1 >= argc ||
+               (code->stack_size = strtoull(argv[arg + 1], &end, 10)) == 0 ||
+               *end != '\0') {
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "Flag '--stack-size' expected to have positive number after it.\r\n");
+                return ASM_FLAGS_ERROR;
+            }
+            arg++;
+        }
+        else if(argv[arg][0] == '-') {
             color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                          "Unknown flag '%s'.\r\n",
-                         argv[2]);
+                         argv[arg]);
+            return ASM_FLAGS_ERROR;
+        }
+        else if(code->input_filename == NULL) {
+            code->input_filename = argv[arg];
+        }
+        else {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Unexpected amount of flags.\r\n");
             return ASM_FLAGS_ERROR;
         }
+    }
 
-        code->input_filename  = argv[1];
-        code->output_filename = argv[3];
-        return ASM_SUCCESS;
+    if(code->input_filename == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "No input files.\r\n");
+        return ASM_NO_INPUT_FILES;
     }
 
-    color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                 "Unexpected amount of flags.\r\n");
-    return ASM_FLAGS_ERROR;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Creates arena for code structure.
+
+    @details    Source code, output code, labels, fixups and RAM initializer live until
+                the end of assembling, so they are allocated in one arena, which is freed
+                in destroy_code(...) with one operation.
+
+    @param [in] code                Code structure.
+
+    @return Error code.
+
+======================================================================================================
+*/
+asm_error_t init_code_memory(code_t *code) {
+    C_ASSERT(code != NULL, return ASM_NULL_CODE);
+
+    code->arena = memory_arena_create(code_arena_chunk_size);
+    if(code->arena == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory arena.\r\n");
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    memory_bind(MEMORY_TAG_SOURCE, code->arena);
+    memory_bind(MEMORY_TAG_CODE  , code->arena);
+    memory_bind(MEMORY_TAG_LABELS, code->arena);
+    memory_bind(MEMORY_TAG_FIXUPS, code->arena);
+    memory_bind(MEMORY_TAG_RAM   , code->arena);
+    return ASM_SUCCESS;
 }
 
 /**
@@ -148,7 +257,9 @@ asm_error_t read_source_code(code_t *code) {
 
     code->source_size = file_size(source_code_file);
 
-    code->source_code = (char *)_calloc(code->source_size, sizeof(char));
+    code->source_code = (char *)_calloc_tagged(MEMORY_TAG_SOURCE,
+                                               code->source_size,
+                                               sizeof(char));
     if(code->source_code == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Error while allocating memory to source code of file '%s'.\r\n",
@@ -176,8 +287,8 @@ asm_error_t read_source_code(code_t *code) {
 ======================================================================================================
     @brief      Writes compiled code to output file.
 
-    @details    Function writes assembler header and compiled code to file with name,
-                determined by parse_flags(...).
+    @details    Function writes assembler header, compiled code, RAM initializer
+                and symbols (if '-g' is set) to file with name, determined by parse_flags(...).
 
     @param [in] code                Code structure.
 
@@ -211,6 +322,21 @@ asm_error_t write_code(code_t *code) {
         return ASM_WRITING_FILE_ERROR;
     }
 
+    if(data_write(&code->data, output_file) != ASM_SUCCESS) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while writing RAM initializer to file '%s'.\r\n",
+                     code->output_filename);
+        return ASM_WRITING_FILE_ERROR;
+    }
+
+    if(code->write_symbols &&
+       write_labels_symbols(&code->labels, output_file) != ASM_SUCCESS) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while writing symbols to file '%s'.\r\n",
+                     code->output_filename);
+        return ASM_WRITING_FILE_ERROR;
+    }
+
     color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                  "Successfully wrote binary code to file '%s'.\r\n",
                  code->output_filename);
@@ -221,7 +347,11 @@ asm_error_t write_code(code_t *code) {
 ======================================================================================================
     @brief      Adds assembler header to binary code.
 
-    @details    Header contains of assembler name, version and number of elements in binary code.
+    @details    Header contains of assembler name, version, number of elements in binary code,
+                number of RAM cells and capacity of stacks which program needs,
+                size of RAM initializer and number of symbols.
+                If '--ram-size' is not set and RAM initializer does not fit default
+                RAM, RAM size is set to the end of RAM initializer.
                 It is written to the start of file.
 
     @param [in] code                Code structure.
@@ -235,9 +365,24 @@ asm_error_t write_header(code_t *code,
                          FILE   *output_file) {
     program_header_t header = {
         .assembler_version  = assembler_version,
-        .code_size          = code->output_code_size};
+        .code_size          = code->output_code_size,
+        .ram_size           = code->ram_size,
+        .stack_size         = code->stack_size,
+        .data_size          = data_size(&code->data),
+        .symbols_number     = code->write_symbols ? labels_symbols_number(&code->labels) : 0};
     strcpy(header.assembler_name, assembler_name);
 
+    if(code->ram_size != 0 && code->data.end > code->ram_size) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "RAM initializer needs %llu cells, but RAM size is %llu.\r\n",
+                     code->data.end,
+                     code->ram_size);
+        return ASM_DATA_ERROR;
+    }
+
+    if(code->ram_size == 0 && code->data.end > default_ram_size)
+        header.ram_size = code->data.end;
+
     if(fwrite(&header,
               sizeof(program_header_t),
               1,
@@ -255,7 +400,9 @@ asm_error_t write_header(code_t *code,
 ======================================================================================================
     @brief      Destroys code structure.
 
-    @details    Frees source_code, output_code, labels and fixups.
+    @details    Prints memory statistics if they were requested.
+                Frees source_code, output_code, labels, fixups, RAM initializer, jump lines
+                and their arena.
                 Closes memory dump file.
                 Sets code structure memory to zeros.
 
@@ -268,10 +415,17 @@ asm_error_t write_header(code_t *code,
 asm_error_t destroy_code(code_t *code) {
     C_ASSERT(code != NULL, return ASM_NULL_CODE);
 
+    if(code->print_memory_stats)
+        memory_print_stats(stdout);
+
     _free(code->source_code  );
     _free(code->output_code  );
     _free(code->labels.labels);
     _free(code->labels.fixup );
+    _free(code->data.segments);
+    _free(code->data.values  );
+    _free(code->command_lines.lines);
+    memory_allocator_destroy(&code->arena);
     _memory_destroy_log();
     memset(code, 0, sizeof(code_t));
     return ASM_SUCCESS;
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "branch_profile.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief Share of runs in percents after which jump is treated as biased.
+
+======================================================================================================
+*/
+static const double branch_bias_percent  = 90;
+
+/**
+======================================================================================================
+    @brief Maximum length of command name in branch profile.
+
+======================================================================================================
+*/
+static const size_t max_jump_name_length = 8;
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static asm_error_t read_profile_header(FILE       *profile_file,
+                                       const char *profile_filename,
+                                       address_t   code_size);
+
+/**
+======================================================================================================
+    @brief      Reads branch profile and prints it by source lines.
+
+    @details    Profile is written by 'run --branch-profile'. Sites which are not
+                conditional jumps of this source are counted as stale, it
+                means that source was changed after profile was collected.
+                Jump is biased if it is taken or not taken in branch_bias_percent
+                of runs, average trips are printed for backward jumps.
+
+    @param [in] command_lines       Command lines structure.
+    @param [in] profile_filename    Name of branch profile file.
+    @param [in] source_filename     Name of source file.
+    @param [in] code_size           Size of compiled code.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t branch_profile_print(command_lines_t *command_lines,
+                                 const char      *profile_filename,
+                                 const char      *source_filename,
+                                 address_t        code_size) {
+    C_ASSERT(command_lines    != NULL, return ASM_INPUT_ERROR);
+    C_ASSERT(profile_filename != NULL, return ASM_INPUT_ERROR);
+    C_ASSERT(source_filename  != NULL, return ASM_INPUT_ERROR);
+
+    FILE *profile_file = fopen(profile_filename, "rb");
+    if(profile_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening branch profile '%s'.\r\n",
+                     profile_filename);
+        return ASM_OPENING_FILE_ERROR;
+    }
+
+    asm_error_t error_code = ASM_SUCCESS;
+    if((error_code = read_profile_header(profile_file, profile_filename, code_size)) != ASM_SUCCESS) {
+        fclose(profile_file);
+        return error_code;
+    }
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Branch profile '%s':\r\n",
+                 profile_filename);
+    printf("line     command           taken       not taken  taken %%  avg trips  bias\r\n");
+
+    size_t stale_sites = 0;
+    while(true) {
+        address_t site                             = 0;
+        address_t target                           = 0;
+        uint64_t  taken                            = 0;
+        uint64_t  not_taken                        = 0;
+        uint64_t  exits                            = 0;
+        char      name[max_jump_name_length + 1]   = {};
+        int       fields = fscanf(profile_file, "%llx %8s %llx %llu %llu",
+                                  &site, name, &target, &taken, &not_taken);
+        if(fields == EOF)
+            break;
+
+        bool is_read = fields == 5;
+        for(size_t bucket = 0; bucket < branch_trip_buckets && is_read; bucket++) {
+            uint64_t trips = 0;
+            is_read = fscanf(profile_file, "%llu", &trips) == 1;
+            exits  += trips;
+        }
+
+        if(!is_read) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Wrong line in branch profile '%s'.\r\n",
+                         profile_filename);
+            fclose(profile_file);
+            return ASM_BRANCH_PROFILE_ERROR;
+        }
+
+        command_line_t *jump_line = command_lines_find(command_lines, site);
+        if(jump_line == NULL || jump_line->command < CMD_JA || jump_line->command > CMD_JNE ||
+           strcmp(spu_command_name(jump_line->command), name) != 0) {
+            stale_sites++;
+            continue;
+        }
+
+        uint64_t total         = taken + not_taken;
+        double   taken_percent = 100.0 * (double)taken / (double)(total == 0 ? 1 : total);
+        printf("%s:%-5zu %-7s %15llu %15llu %7.2f%% ",
+               source_filename,
+               jump_line->line,
+               name,
+               taken,
+               not_taken,
+               taken_percent);
+
+        if(target <= site && exits != 0)
+            printf("%10.1f  ", (double)total / (double)exits);
+        else
+            printf("%10s  ", "-");
+
+        if(taken_percent >= branch_bias_percent)
+            printf("taken\r\n");
+        else if(taken_percent <= 100 - branch_bias_percent)
+            printf("not taken\r\n");
+        else
+            printf("-\r\n");
+    }
+
+    if(stale_sites != 0)
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "%zu sites of branch profile are not conditional jumps of '%s', "
+                     "profile is stale.\r\n",
+                     stale_sites,
+                     source_filename);
+
+    fclose(profile_file);
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Reads and checks the first line of branch profile.
+
+    @details    Profile of code with other size is read, but warning is printed.
+
+======================================================================================================
+*/
+asm_error_t read_profile_header(FILE       *profile_file,
+                                const char *profile_filename,
+                                address_t   code_size) {
+    char      signature[32]      = {};
+    uint64_t  version            = 0;
+    address_t profile_code_size  = 0;
+    size_t    buckets            = 0;
+    if(fscanf(profile_file, "%31s %llu %llu %zu",
+              signature, &version, &profile_code_size, &buckets) != 4 ||
+       strcmp(signature, branch_profile_signature) != 0 ||
+       version != branch_profile_version ||
+       buckets != branch_trip_buckets) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "'%s' is not branch profile of version %llu.\r\n",
+                     profile_filename,
+                     branch_profile_version);
+        return ASM_BRANCH_PROFILE_ERROR;
+    }
+
+    if(profile_code_size != code_size)
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Branch profile was collected for code of %llu bytes, "
+                     "code has %llu bytes.\r\n",
+                     profile_code_size,
+                     code_size);
+
+    return ASM_SUCCESS;
+}
+
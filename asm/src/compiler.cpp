@@ -40,6 +40,13 @@ static address_t   get_register_number      (const char *register_name);
 static command_t   get_command_value        (const char *command_name);
 static asm_error_t code_add_argument        (code_t     *code,
                                              const void *item);
+static asm_error_t parse_directive          (code_t     *code,
+                                             const char *directive);
+static asm_error_t parse_org_directive      (code_t     *code);
+static asm_error_t parse_double_directive   (code_t     *code);
+static asm_error_t parse_fill_directive     (code_t     *code);
+static char       *skip_blanks              (char       *source);
+static bool        is_line_end              (char        symbol);
 
 
 /**
@@ -77,8 +84,9 @@ asm_error_t compile_code(code_t *code) {
 ======================================================================================================
     @brief      Parses one line of code.
 
-    @details    Reads one line and determines if it is label or command.
-                Runs functions that handles both variants.
+    @details    Reads one line and determines if it is label, directive or command.
+                Runs functions that handles these variants.
+                Commands are not allowed in data section.
 
     @param [in] code                Code structure.
 
@@ -106,13 +114,25 @@ asm_error_t parse_line(code_t *code) {
         return ASM_SUCCESS;
     }
 
-    if((error_code = parse_command(code, command)) != ASM_SUCCESS)
+    if(command[0] == '.') {
+        if((error_code = parse_directive(code, command)) != ASM_SUCCESS)
+            return error_code;
+    }
+    else if(code->is_data_section) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Command '%s' in data section %s:%llu.\r\n",
+                     command,
+                     code->input_filename,
+                     code->source_current_line);
+        return ASM_SYNTAX_ERROR;
+    }
+    else if((error_code = parse_command(code, command)) != ASM_SUCCESS) {
         return error_code;
+    }
 
     if((error_code = code_move_next_line(code)) != ASM_SUCCESS)
         return error_code;
 
-    code->source_current_line++;
     return ASM_SUCCESS;
 }
 
@@ -120,7 +140,8 @@ asm_error_t parse_line(code_t *code) {
 ======================================================================================================
     @brief      Allocates memory to code structure.
 
-    @details    Allocates output code array and initializes labels structure.
+    @details    Allocates output code array and initializes labels and RAM initializer structures.
+                Jump lines are initialized only if '--branch-profile' is set.
 
     @param [in] code                Code structure.
 
@@ -132,8 +153,9 @@ asm_error_t allocate_code_memory(code_t *code) {
     C_ASSERT(code              != NULL, return ASM_NULL_CODE  );
     C_ASSERT(code->source_code != NULL, return ASM_INPUT_ERROR);
 
-    code->output_code = (command_t *)_calloc(code->source_size,
-                                             sizeof(argument_t));
+    code->output_code = (command_t *)_calloc_tagged(MEMORY_TAG_CODE,
+                                                    code->source_size,
+                                                    sizeof(argument_t));
     if(code->output_code == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Error while allocating memory to exit code.\r\n");
@@ -144,6 +166,13 @@ asm_error_t allocate_code_memory(code_t *code) {
     if((error_code != ASM_SUCCESS))
         return error_code;
 
+    if((error_code = data_init(&code->data)) != ASM_SUCCESS)
+        return error_code;
+
+    if((code->branch_profile_filename != NULL || code->coverage_filename != NULL) &&
+       (error_code = command_lines_init(&code->command_lines)) != ASM_SUCCESS)
+        return error_code;
+
     code->source_current_line = 1;
     return ASM_SUCCESS;
 }
@@ -184,6 +213,7 @@ asm_error_t read_command(code_t *code,
 
     @details    Writes command number to last element in code array.
                 Runs parse_command_arguments(...) to add arguments.
+                Source lines of commands are kept for '--branch-profile' and '--coverage'.
 
     @param [in] code                Code structure.
     @param [in] command             String with command.
@@ -203,11 +233,17 @@ asm_error_t parse_command(code_t *code, char *command) {
         return ASM_SYNTAX_ERROR;
     }
 
+    asm_error_t error_code = ASM_SUCCESS;
+    if(code->command_lines.lines != NULL &&
+       (error_code = command_lines_add(&code->command_lines,
+                                       code->output_code_size,
+                                       operation_code,
+                                       code->source_current_line)) != ASM_SUCCESS)
+        return error_code;
 
     code->output_code[code->output_code_size] = operation_code;
     code->output_code_size++;
 
-    asm_error_t error_code = ASM_SUCCESS;
     if((error_code = parse_command_arguments(code, operation_code)) != ASM_SUCCESS)
         return error_code;
 
@@ -218,7 +254,9 @@ asm_error_t parse_command(code_t *code, char *command) {
 ======================================================================================================
     @brief      Cleans source code buffer.
 
-    @details    Moves source code position to next line.
+    @details    Moves source code position to next line, empty lines are skipped.
+                Every passed line is counted, so labels and empty lines are
+                included in line numbers of messages.
 
     @param [in] code                Code structure.
 
@@ -236,11 +274,17 @@ asm_error_t code_move_next_line(code_t *code) {
 
     if(code->source_code[code->source_code_position + 1] == '\0') {
         code->source_code_position++;
+        code->source_current_line++;
         return ASM_SUCCESS;
     }
 
-    while(!isprint(code->source_code[code->source_code_position]))
+    while(code->source_code[code->source_code_position] != '\0' &&
+          !isprint(code->source_code[code->source_code_position])) {
+        if(code->source_code[code->source_code_position] == '\n')
+            code->source_current_line++;
+
         code->source_code_position++;
+    }
 
     return ASM_SUCCESS;
 }
@@ -399,7 +443,7 @@ address_t get_register_number(const char *register_name) {
 ======================================================================================================
     @brief      Translates command as string to command enumerator.
 
-    @details    Runs through supported_commands array and
+    @details    Runs through spu_command_names array and
                 compares written names to command_name.
 
     @param [in] command_name        String with command.
@@ -411,12 +455,9 @@ address_t get_register_number(const char *register_name) {
 command_t get_command_value(const char *command_name) {
     C_ASSERT(command_name != NULL, return CMD_UNKNOWN);
 
-    size_t commands_number = sizeof(supported_commands) / sizeof(supported_commands[0]);
-    for(size_t index = 0; index < commands_number; index++) {
-        const command_prototype_t *current_command = supported_commands + index;
-        if(strcmp(command_name, current_command->command_name) == 0)
-            return current_command->command_value;
-    }
+    for(size_t command = processor_first_command; command <= processor_last_command; command++)
+        if(strcmp(command_name, spu_command_names[command]) == 0)
+            return (command_t)command;
 
     return CMD_UNKNOWN;
 }
@@ -683,6 +724,190 @@ asm_error_t verify_register(address_t register_number) {
     return ASM_SUCCESS;
 }
 
+/**
+======================================================================================================
+    @brief      Parses assembler directive.
+
+    @details    '.data' starts data section and '.text' returns to code section.
+                In data section RAM initializer is described by directives:
+                '.org address' sets RAM cell where the next values are placed,
+                '.double value, ...' places values in consecutive cells,
+                '.fill number, value' fills number of cells with value (0 by default).
+                RAM initializer is copied to RAM when program is loaded.
+
+    @param [in] code                Code structure.
+    @param [in] directive           String with directive.
+
+    @return Error code.
+
+======================================================================================================
+*/
+asm_error_t parse_directive(code_t     *code,
+                            const char *directive) {
+    if(strcmp(directive, ".data") == 0) {
+        code->is_data_section = true;
+        return ASM_SUCCESS;
+    }
+
+    if(strcmp(directive, ".text") == 0) {
+        code->is_data_section = false;
+        return ASM_SUCCESS;
+    }
+
+    bool is_data_directive = strcmp(directive, ".org"   ) == 0 ||
+                             strcmp(directive, ".double") == 0 ||
+                             strcmp(directive, ".fill"  ) == 0;
+    if(!is_data_directive) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Unknown directive '%s' %s:%llu.\r\n",
+                     directive,
+                     code->input_filename,
+                     code->source_current_line);
+        return ASM_SYNTAX_ERROR;
+    }
+
+    if(!code->is_data_section) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Directive '%s' out of data section %s:%llu.\r\n",
+                     directive,
+                     code->input_filename,
+                     code->source_current_line);
+        return ASM_SYNTAX_ERROR;
+    }
+
+    asm_error_t error_code = ASM_SUCCESS;
+    if(strcmp(directive, ".org") == 0)
+        error_code = parse_org_directive   (code);
+    else if(strcmp(directive, ".double") == 0)
+        error_code = parse_double_directive(code);
+    else
+        error_code = parse_fill_directive  (code);
+
+    if(error_code == ASM_UNEXPECTED_PARAMETER)
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Unexpected parameter of '%s' on %s:%llu\r\n",
+                     directive,
+                     code->input_filename,
+                     code->source_current_line);
+    return error_code;
+}
+
+/**
+======================================================================================================
+    @brief      Parses '.org address' directive.
+
+    @param [in] code                Code structure.
+
+    @return Error code.
+
+======================================================================================================
+*/
+asm_error_t parse_org_directive(code_t *code) {
+    char     *source_pointer = skip_blanks(code->source_code + code->source_code_position);
+    address_t address        = 0;
+
+    if(is_line_end(*source_pointer) ||
+       sscanf(source_pointer, "%llu", &address) != 1)
+        return ASM_UNEXPECTED_PARAMETER;
+
+    return data_set_address(&code->data, address);
+}
+
+/**
+======================================================================================================
+    @brief      Parses '.double value, ...' directive.
+
+    @details    Reads comma separated values until the end of line.
+
+    @param [in] code                Code structure.
+
+    @return Error code.
+
+======================================================================================================
+*/
+asm_error_t parse_double_directive(code_t *code) {
+    char       *source_pointer = code->source_code + code->source_code_position;
+    asm_error_t error_code     = ASM_SUCCESS;
+
+    while(true) {
+        argument_t value        = 0;
+        int        read_symbols = 0;
+
+        source_pointer = skip_blanks(source_pointer);
+        if(is_line_end(*source_pointer) ||
+           sscanf(source_pointer, "%lg%n", &value, &read_symbols) != 1)
+            return ASM_UNEXPECTED_PARAMETER;
+
+        if((error_code = data_add_double(&code->data, value)) != ASM_SUCCESS)
+            return error_code;
+
+        source_pointer = skip_blanks(source_pointer + read_symbols);
+        if(*source_pointer != ',')
+            break;
+
+        source_pointer++;
+    }
+
+    code->source_code_position = (size_t)(source_pointer - code->source_code);
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Parses '.fill number, value' directive.
+
+    @details    Value can be omitted, then cells are filled with zeros.
+
+    @param [in] code                Code structure.
+
+    @return Error code.
+
+======================================================================================================
+*/
+asm_error_t parse_fill_directive(code_t *code) {
+    char      *source_pointer = skip_blanks(code->source_code + code->source_code_position);
+    address_t  cells_number   = 0;
+    argument_t value          = 0;
+    int        read_symbols   = 0;
+
+    if(is_line_end(*source_pointer) ||
+       sscanf(source_pointer, "%llu%n", &cells_number, &read_symbols) != 1)
+        return ASM_UNEXPECTED_PARAMETER;
+
+    source_pointer = skip_blanks(source_pointer + read_symbols);
+    if(*source_pointer == ',') {
+        source_pointer = skip_blanks(source_pointer + 1);
+        if(is_line_end(*source_pointer) ||
+           sscanf(source_pointer, "%lg", &value) != 1)
+            return ASM_UNEXPECTED_PARAMETER;
+    }
+
+    return data_add_fill(&code->data, cells_number, value);
+}
+
+/**
+======================================================================================================
+    @brief      Skips spaces and tabs, but not line end.
+
+======================================================================================================
+*/
+char *skip_blanks(char *source) {
+    while(*source == ' ' || *source == '\t')
+        source++;
+
+    return source;
+}
+
+/**
+======================================================================================================
+    @brief      Checks if symbol ends line of source code.
+
+======================================================================================================
+*/
+bool is_line_end(char symbol) {
+    return symbol == '\n' || symbol == '\r' || symbol == '\0';
+}
+
 asm_error_t code_add_argument(code_t     *code,
                               const void *item) {
     command_t *code_pointer = code->output_code + code->output_code_size;
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "coverage_listing.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "utils.h"
+#include "spu_facilities.h"
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static asm_error_t read_coverage      (const char        *coverage_filename,
+                                       const command_t   *code,
+                                       address_t          code_size,
+                                       coverage_header_t *header,
+                                       uint8_t          **bitmap);
+static const char *line_marker        (command_lines_t   *command_lines,
+                                       size_t            *command_index,
+                                       size_t             line,
+                                       const uint8_t     *bitmap,
+                                       uint64_t          *run_commands);
+
+/**
+======================================================================================================
+    @brief      Reads coverage and prints annotated listing of source.
+
+    @details    Coverage is written by 'run --coverage'. Every line of source is
+                printed with marker: '+' if any command of line was run,
+                '#####' if commands of line were never run and '-' if there
+                are no commands on line.
+
+    @param [in] command_lines       Command lines structure.
+    @param [in] coverage_filename   Name of coverage file.
+    @param [in] source_code         Source code.
+    @param [in] source_size         Size of source code.
+    @param [in] code                Compiled code.
+    @param [in] code_size           Size of compiled code.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t coverage_print_listing(command_lines_t *command_lines,
+                                   const char      *coverage_filename,
+                                   const char      *source_code,
+                                   size_t           source_size,
+                                   const command_t *code,
+                                   address_t        code_size) {
+    C_ASSERT(command_lines     != NULL, return ASM_INPUT_ERROR);
+    C_ASSERT(coverage_filename != NULL, return ASM_INPUT_ERROR);
+    C_ASSERT(source_code       != NULL, return ASM_INPUT_ERROR);
+    C_ASSERT(code              != NULL, return ASM_INPUT_ERROR);
+
+    coverage_header_t header     = {};
+    uint8_t          *bitmap     = NULL;
+    asm_error_t       error_code = ASM_SUCCESS;
+    if((error_code = read_coverage(coverage_filename, code, code_size, &header, &bitmap)) != ASM_SUCCESS)
+        return error_code;
+
+    size_t   command_index = 0;
+    size_t   line          = 1;
+    size_t   line_start    = 0;
+    size_t   missed_lines  = 0;
+    uint64_t run_commands  = 0;
+    while(line_start < source_size) {
+        size_t line_end = line_start;
+        while(line_end < source_size && source_code[line_end] != '\n')
+            line_end++;
+
+        size_t text_end = line_end;
+        if(text_end > line_start && source_code[text_end - 1] == '\r')
+            text_end--;
+
+        const char *marker = line_marker(command_lines, &command_index, line, bitmap, &run_commands);
+        if(strcmp(marker, "#####") == 0)
+            missed_lines++;
+
+        printf("%5s:%5zu:%.*s\r\n",
+               marker,
+               line,
+               (int)(text_end - line_start),
+               source_code + line_start);
+
+        line_start = line_end + 1;
+        line++;
+    }
+
+    size_t commands_number = command_lines->lines_number;
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Coverage '%s': %llu of %zu commands (%.2f%%) in %llu runs, "
+                 "%zu lines were never run.\r\n",
+                 coverage_filename,
+                 run_commands,
+                 commands_number,
+                 100.0 * (double)run_commands / (double)(commands_number == 0 ? 1 : commands_number),
+                 header.runs,
+                 missed_lines);
+
+    _free(bitmap);
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Reads coverage header and bitmap.
+
+    @details    Coverage of code with other size or hash is treated as stale,
+                it means that source was changed after coverage was collected.
+
+    @param [in]  coverage_filename  Name of coverage file.
+    @param [in]  code               Compiled code.
+    @param [in]  code_size          Size of compiled code.
+    @param [out] header             Coverage header.
+    @param [out] bitmap             Allocated bitmap, it should be freed by caller.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t read_coverage(const char        *coverage_filename,
+                          const command_t   *code,
+                          address_t          code_size,
+                          coverage_header_t *header,
+                          uint8_t          **bitmap) {
+    FILE *coverage_file = fopen(coverage_filename, "rb");
+    if(coverage_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening coverage '%s'.\r\n",
+                     coverage_filename);
+        return ASM_OPENING_FILE_ERROR;
+    }
+
+    if(fread(header, sizeof(coverage_header_t), 1, coverage_file) != 1 ||
+       strncmp(header->signature, coverage_signature, coverage_signature_size) != 0 ||
+       header->version != coverage_version) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "'%s' is not coverage of this version.\r\n",
+                     coverage_filename);
+        fclose(coverage_file);
+        return ASM_COVERAGE_ERROR;
+    }
+
+    if(header->code_size != code_size) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Coverage '%s' was collected for code of size %llu, "
+                     "but code size is %llu, coverage is stale.\r\n",
+                     coverage_filename,
+                     header->code_size,
+                     code_size);
+        fclose(coverage_file);
+        return ASM_COVERAGE_ERROR;
+    }
+
+    if(header->code_hash != bytes_hash(code, code_size)) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Coverage '%s' was collected for other code of the same size, "
+                     "coverage is stale.\r\n",
+                     coverage_filename);
+        fclose(coverage_file);
+        return ASM_COVERAGE_ERROR;
+    }
+
+    size_t bitmap_size = (code_size + 7) / 8;
+    *bitmap = (uint8_t *)_calloc_tagged(MEMORY_TAG_CODE, bitmap_size + 1, sizeof(uint8_t));
+    if(*bitmap == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to coverage.\r\n");
+        fclose(coverage_file);
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    if(fread(*bitmap, sizeof(uint8_t), bitmap_size, coverage_file) != bitmap_size) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while reading coverage '%s'.\r\n",
+                     coverage_filename);
+        fclose(coverage_file);
+        _free(*bitmap);
+        *bitmap = NULL;
+        return ASM_READING_ERROR;
+    }
+
+    fclose(coverage_file);
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Returns marker of source line and moves to commands of the next line.
+
+    @details    Command lines go in order of source lines, so index of the first
+                command which was not checked yet is kept between calls.
+
+======================================================================================================
+*/
+const char *line_marker(command_lines_t *command_lines,
+                        size_t          *command_index,
+                        size_t           line,
+                        const uint8_t   *bitmap,
+                        uint64_t        *run_commands) {
+    bool has_commands = false;
+    bool is_run       = false;
+    while(*command_index < command_lines->lines_number &&
+          command_lines->lines[*command_index].line == line) {
+        address_t site = command_lines->lines[*command_index].site;
+        bool      bit  = (bitmap[site / 8] >> (site % 8)) & 1;
+
+        has_commands  = true;
+        is_run        = is_run || bit;
+        *run_commands += bit;
+        (*command_index)++;
+    }
+
+    if(!has_commands)
+        return "-";
+    return is_run ? "+" : "#####";
+}
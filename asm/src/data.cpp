@@ -0,0 +1,328 @@
+#include <string.h>
+#include <stdint.h>
+
+#include "data.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief Initializing size of segments array.
+
+======================================================================================================
+*/
+static const size_t segments_init_size = 8;
+
+/**
+======================================================================================================
+    @brief Initializing size of values array.
+
+======================================================================================================
+*/
+static const size_t values_init_size   = 64;
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static asm_error_t add_segment         (ram_data_t *data,
+                                        address_t   cells_number,
+                                        address_t   values_number);
+static asm_error_t check_segments_size (ram_data_t *data);
+static asm_error_t check_values_size   (ram_data_t *data);
+
+/**
+======================================================================================================
+    @brief Segment of RAM initializer and index of its first value in values array.
+
+======================================================================================================
+*/
+struct data_segment_t {
+    ram_segment_t   segment;
+    size_t          first_value;
+};
+
+/**
+======================================================================================================
+    @brief      Initializes RAM initializer structure.
+
+    @details    Allocates segments and values arrays, data is placed from the
+                first RAM cell until '.org' directive occurs.
+
+    @param [in] data                RAM initializer structure.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t data_init(ram_data_t *data) {
+    C_ASSERT(data != NULL, return ASM_INPUT_ERROR);
+
+    data->segments = (data_segment_t *)_calloc_tagged(MEMORY_TAG_RAM,
+                                                      segments_init_size,
+                                                      sizeof(data_segment_t));
+    data->values   = (argument_t     *)_calloc_tagged(MEMORY_TAG_RAM,
+                                                      values_init_size,
+                                                      sizeof(argument_t));
+    if(data->segments == NULL || data->values == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to RAM initializer.\r\n");
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    data->segments_size   = segments_init_size;
+    data->values_size     = values_init_size;
+    data->segments_number = 0;
+    data->values_number   = 0;
+    data->address         = 0;
+    data->end             = 0;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Sets RAM cell where the next value is placed ('.org' directive).
+
+    @param [in] data                RAM initializer structure.
+    @param [in] address             RAM address.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t data_set_address(ram_data_t *data,
+                             address_t   address) {
+    C_ASSERT(data != NULL, return ASM_INPUT_ERROR);
+
+    data->address = address;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Adds one value to RAM initializer ('.double' directive).
+
+    @details    If value is placed right after the last segment, this segment
+                is extended, so consecutive values are written as one segment.
+
+    @param [in] data                RAM initializer structure.
+    @param [in] value               Value of RAM cell.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t data_add_double(ram_data_t *data,
+                            argument_t  value) {
+    C_ASSERT(data != NULL, return ASM_INPUT_ERROR);
+
+    asm_error_t error_code = ASM_SUCCESS;
+    if((error_code = check_values_size(data)) != ASM_SUCCESS)
+        return error_code;
+
+    ram_segment_t *last_segment = NULL;
+    if(data->segments_number != 0)
+        last_segment = &data->segments[data->segments_number - 1].segment;
+
+    if(last_segment != NULL &&
+       last_segment->values_number == last_segment->cells_number &&
+       last_segment->address + last_segment->cells_number == data->address) {
+        last_segment->cells_number++;
+        last_segment->values_number++;
+        data->address++;
+    }
+    else if((error_code = add_segment(data, 1, 1)) != ASM_SUCCESS) {
+        return error_code;
+    }
+
+    data->values[data->values_number++] = value;
+    if(data->end < data->address)
+        data->end = data->address;
+
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Fills RAM cells with one value ('.fill' directive).
+
+    @details    Only one value is written to binary, it is copied to all cells
+                when program is loaded.
+
+    @param [in] data                RAM initializer structure.
+    @param [in] cells_number        Number of cells.
+    @param [in] value               Value of cells.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t data_add_fill(ram_data_t *data,
+                          address_t   cells_number,
+                          argument_t  value) {
+    C_ASSERT(data != NULL, return ASM_INPUT_ERROR);
+
+    if(cells_number == 0)
+        return ASM_SUCCESS;
+
+    asm_error_t error_code = ASM_SUCCESS;
+    if((error_code = check_values_size(data)) != ASM_SUCCESS)
+        return error_code;
+
+    if((error_code = add_segment(data, cells_number, 1)) != ASM_SUCCESS)
+        return error_code;
+
+    data->values[data->values_number++] = value;
+    if(data->end < data->address)
+        data->end = data->address;
+
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Returns size of RAM initializer in binary file in bytes.
+
+======================================================================================================
+*/
+uint64_t data_size(ram_data_t *data) {
+    C_ASSERT(data != NULL, return 0);
+
+    return data->segments_number * sizeof(ram_segment_t) +
+           data->values_number   * sizeof(argument_t);
+}
+
+/**
+======================================================================================================
+    @brief      Writes RAM initializer to binary file.
+
+    @details    Every segment is written as ram_segment_t followed by its values.
+
+    @param [in] data                RAM initializer structure.
+    @param [in] output_file         Binary file.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t data_write(ram_data_t *data,
+                       FILE       *output_file) {
+    C_ASSERT(data        != NULL, return ASM_INPUT_ERROR);
+    C_ASSERT(output_file != NULL, return ASM_INPUT_ERROR);
+
+    for(size_t index = 0; index < data->segments_number; index++) {
+        data_segment_t *segment = data->segments + index;
+        if(fwrite(&segment->segment,
+                  sizeof(ram_segment_t),
+                  1,
+                  output_file) != 1 ||
+           fwrite(data->values + segment->first_value,
+                  sizeof(argument_t),
+                  segment->segment.values_number,
+                  output_file) != segment->segment.values_number)
+            return ASM_WRITING_FILE_ERROR;
+    }
+
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Adds segment which starts on current address.
+
+    @details    It is expected that values of segment are added right after this call.
+                Moves current address to the end of segment.
+
+    @param [in] data                RAM initializer structure.
+    @param [in] cells_number        Number of cells in segment.
+    @param [in] values_number       Number of values in segment.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t add_segment(ram_data_t *data,
+                        address_t   cells_number,
+                        address_t   values_number) {
+    if(cells_number > UINT64_MAX - data->address) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "RAM initializer is out of address space.\r\n");
+        return ASM_DATA_ERROR;
+    }
+
+    asm_error_t error_code = ASM_SUCCESS;
+    if((error_code = check_segments_size(data)) != ASM_SUCCESS)
+        return error_code;
+
+    data_segment_t *segment        = data->segments + data->segments_number++;
+    segment->segment.address       = data->address;
+    segment->segment.cells_number  = cells_number;
+    segment->segment.values_number = values_number;
+    segment->first_value           = data->values_number;
+
+    data->address += cells_number;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Checks if size of segments array is sufficient.
+
+    @details    If number of segments is equal to size of array, it reallocates segments array.
+
+    @param [in] data                RAM initializer structure.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t check_segments_size(ram_data_t *data) {
+    if(data->segments_number < data->segments_size)
+        return ASM_SUCCESS;
+
+    data_segment_t *new_segments = (data_segment_t *)_recalloc(data->segments,
+                                                               data->segments_size,
+                                                               data->segments_size * 2,
+                                                               sizeof(data_segment_t));
+    if(new_segments == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while reallocating memory to RAM initializer.\r\n");
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    data->segments       = new_segments;
+    data->segments_size *= 2;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Checks if size of values array is sufficient.
+
+    @details    If number of values is equal to size of array, it reallocates values array.
+
+    @param [in] data                RAM initializer structure.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t check_values_size(ram_data_t *data) {
+    if(data->values_number < data->values_size)
+        return ASM_SUCCESS;
+
+    argument_t *new_values = (argument_t *)_recalloc(data->values,
+                                                     data->values_size,
+                                                     data->values_size * 2,
+                                                     sizeof(argument_t));
+    if(new_values == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while reallocating memory to RAM initializer.\r\n");
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    data->values       = new_values;
+    data->values_size *= 2;
+    return ASM_SUCCESS;
+}
@@ -76,14 +76,18 @@ struct fixup_t {
 ======================================================================================================
 */
 asm_error_t code_labels_init(labels_array_t *labels_array) {
-    labels_array->fixup = (fixup_t *)_calloc(fixups_init_size, sizeof(fixup_t));
+    labels_array->fixup = (fixup_t *)_calloc_tagged(MEMORY_TAG_FIXUPS,
+                                                    fixups_init_size,
+                                                    sizeof(fixup_t));
     if(labels_array->fixup == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Error while allocating memory to fixup's.\r\n");
         return ASM_MEMORY_ALLOCATING_ERROR;
     }
 
-    labels_array->labels = (label_t *)_calloc(labels_init_size, sizeof(label_t));
+    labels_array->labels = (label_t *)_calloc_tagged(MEMORY_TAG_LABELS,
+                                                     labels_init_size,
+                                                     sizeof(label_t));
     if(labels_array->labels == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Error while allocating memory to labels.\r\n");
@@ -252,8 +256,7 @@ asm_error_t check_labels_size(labels_array_t *labels_array) {
 
     label_t *new_labels = (label_t *)_recalloc(labels_array->labels,
                                                labels_array->labels_size,
-                                               labels_array->labels_size +
-                                               labels_init_size,
+                                               labels_array->labels_size * 2,
                                                sizeof(label_t));
     if(new_labels == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
@@ -262,7 +265,7 @@ asm_error_t check_labels_size(labels_array_t *labels_array) {
     }
 
     labels_array->labels      =  new_labels;
-    labels_array->labels_size += labels_init_size;
+    labels_array->labels_size *= 2;
     return ASM_SUCCESS;
 }
 
@@ -316,8 +319,7 @@ asm_error_t check_fixup_size(labels_array_t *labels_array) {
 
     fixup_t *new_fixup = (fixup_t *)_recalloc(labels_array->fixup,
                                               labels_array->fixup_size,
-                                              labels_array->fixup_size +
-                                              fixups_init_size,
+                                              labels_array->fixup_size * 2,
                                               sizeof(fixup_t));
     if(new_fixup == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
@@ -326,7 +328,65 @@ asm_error_t check_fixup_size(labels_array_t *labels_array) {
     }
 
     labels_array->fixup      =  new_fixup;
-    labels_array->fixup_size += fixups_init_size;
+    labels_array->fixup_size *= 2;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Counts labels which are written as symbols.
+
+    @param [in] labels_array        Labels structure pointer.
+
+    @return Number of defined labels.
+
+======================================================================================================
+*/
+uint64_t labels_symbols_number(labels_array_t *labels_array) {
+    C_ASSERT(labels_array != NULL, return 0);
+
+    uint64_t symbols_number = 0;
+    for(size_t index = 0; index < labels_array->labels_number; index++)
+        if(labels_array->labels[index].is_defined)
+            symbols_number++;
+
+    return symbols_number;
+}
+
+/**
+======================================================================================================
+    @brief      Writes defined labels to binary file as symbols.
+
+    @details    Symbols are used by SPU profilers to show names instead of addresses.
+                Names are written without ':'.
+
+    @param [in] labels_array        Labels structure pointer.
+    @param [in] output_file         Binary file.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t write_labels_symbols(labels_array_t *labels_array,
+                                 FILE           *output_file) {
+    C_ASSERT(labels_array != NULL, return ASM_NULL_CODE );
+    C_ASSERT(output_file  != NULL, return ASM_INPUT_ERROR);
+
+    for(size_t index = 0; index < labels_array->labels_number; index++) {
+        label_t *label = labels_array->labels + index;
+        if(!label->is_defined)
+            continue;
+
+        program_symbol_t symbol    = {.address = label->label_ip};
+        size_t           name_size = strcspn(label->label_name, ":");
+        if(name_size >= symbol_name_size)
+            name_size = symbol_name_size - 1;
+
+        memcpy(symbol.name, label->label_name, name_size);
+        if(fwrite(&symbol, sizeof(program_symbol_t), 1, output_file) != 1)
+            return ASM_WRITING_FILE_ERROR;
+    }
+
     return ASM_SUCCESS;
 }
 
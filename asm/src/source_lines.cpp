@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "source_lines.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief Initializing size of command lines array.
+
+======================================================================================================
+*/
+static const size_t command_lines_init_size = 64;
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static asm_error_t check_command_lines_size(command_lines_t *command_lines);
+
+/**
+======================================================================================================
+    @brief      Initializes command lines structure.
+
+    @param [in] command_lines       Command lines structure.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t command_lines_init(command_lines_t *command_lines) {
+    C_ASSERT(command_lines != NULL, return ASM_INPUT_ERROR);
+
+    command_lines->lines = (command_line_t *)_calloc_tagged(MEMORY_TAG_CODE,
+                                                            command_lines_init_size,
+                                                            sizeof(command_line_t));
+    if(command_lines->lines == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to command lines.\r\n");
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    command_lines->lines_size   = command_lines_init_size;
+    command_lines->lines_number = 0;
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Adds source line of command.
+
+    @param [in] command_lines       Command lines structure.
+    @param [in] site                Address of command.
+    @param [in] command             Operation code of command.
+    @param [in] line                Source line.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t command_lines_add(command_lines_t *command_lines,
+                              address_t        site,
+                              command_t        command,
+                              size_t           line) {
+    C_ASSERT(command_lines != NULL, return ASM_INPUT_ERROR);
+
+    asm_error_t error_code = ASM_SUCCESS;
+    if((error_code = check_command_lines_size(command_lines)) != ASM_SUCCESS)
+        return error_code;
+
+    command_lines->lines[command_lines->lines_number++] = {.site    = site,
+                                                           .command = command,
+                                                           .line    = line};
+    return ASM_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Finds command line by address of command.
+
+    @return Command line or NULL if there is no command on this address.
+
+======================================================================================================
+*/
+command_line_t *command_lines_find(command_lines_t *command_lines,
+                                   address_t        site) {
+    C_ASSERT(command_lines != NULL, return NULL);
+
+    size_t left  = 0;
+    size_t right = command_lines->lines_number;
+    while(left < right) {
+        size_t middle = left + (right - left) / 2;
+        if(command_lines->lines[middle].site < site)
+            left  = middle + 1;
+        else
+            right = middle;
+    }
+
+    if(left == command_lines->lines_number || command_lines->lines[left].site != site)
+        return NULL;
+
+    return command_lines->lines + left;
+}
+
+/**
+======================================================================================================
+    @brief      Checks if size of command lines array is sufficient.
+
+    @details    If number of lines is equal to size of array, it reallocates lines array.
+
+    @param [in] command_lines       Command lines structure.
+
+    @return Error code
+
+======================================================================================================
+*/
+asm_error_t check_command_lines_size(command_lines_t *command_lines) {
+    if(command_lines->lines_number < command_lines->lines_size)
+        return ASM_SUCCESS;
+
+    command_line_t *new_lines = (command_line_t *)_recalloc(command_lines->lines,
+                                                            command_lines->lines_size,
+                                                            command_lines->lines_size * 2,
+                                                            sizeof(command_line_t));
+    if(new_lines == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while reallocating memory to command lines.\r\n");
+        return ASM_MEMORY_ALLOCATING_ERROR;
+    }
+
+    command_lines->lines       = new_lines;
+    command_lines->lines_size *= 2;
+    return ASM_SUCCESS;
+}
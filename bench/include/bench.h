@@ -0,0 +1,45 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+//the biggest number of threads which bench_run_threads(...) can start
+static const size_t bench_max_threads = 64;
+
+//routine gets index of its thread and context which is shared by all threads
+typedef void (*bench_routine_t)(size_t thread_index, void *context);
+
+//starts threads_number threads and waits for all of them, returns wall time
+//in nanoseconds from start of the first thread to end of the last one,
+//0 if threads were not started
+uint64_t       bench_run_threads  (size_t           threads_number,
+                                   bench_routine_t  routine,
+                                   void            *context);
+
+//gives processor to other threads, waiting threads call it to let threads
+//which they wait for run on machines with few processors
+void           bench_yield        (void);
+
+struct bench_mutex_t;
+
+bench_mutex_t *bench_mutex_create (void);
+void           bench_mutex_lock   (bench_mutex_t   *mutex);
+void           bench_mutex_unlock (bench_mutex_t   *mutex);
+void           bench_mutex_destroy(bench_mutex_t  **mutex);
+
+//argument number index is number of operations per thread, default_value is
+//returned if there is no such argument, 0 if argument is not positive number
+uint64_t       bench_parse_number (int              argc,
+                                   const char      *argv[],
+                                   int              index,
+                                   uint64_t         default_value);
+
+void           bench_print_header (void);
+//prints name, number of threads, time of one operation and throughput
+void           bench_print        (const char      *name,
+                                   size_t           threads_number,
+                                   uint64_t         operations,
+                                   uint64_t         time);
+
+#endif
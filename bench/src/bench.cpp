@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "bench.h"
+#include "clocks.h"
+#include "memory.h"
+#include "custom_assert.h"
+
+//==============================================================================
+//THREAD PRIMITIVES OF PLATFORM
+//==============================================================================
+#ifdef _WIN32
+    typedef HANDLE           thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+#else
+    typedef pthread_t        thread_t;
+    typedef pthread_mutex_t  mutex_t;
+#endif
+
+struct bench_mutex_t {
+    mutex_t mutex;
+};
+
+//==============================================================================
+//ARGUMENTS OF ONE THREAD, ROUTINE AND CONTEXT ARE THE SAME FOR ALL THREADS
+//==============================================================================
+struct bench_thread_t {
+    thread_t        thread;
+    size_t          index;
+    bench_routine_t routine;
+    void           *context;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static bool thread_start(bench_thread_t *thread);
+static void thread_join (bench_thread_t *thread);
+
+//------------------------------------------------------------------------------
+//THREADS WHICH WERE STARTED ARE JOINED EVEN IF NEXT THREAD FAILED TO START
+//------------------------------------------------------------------------------
+uint64_t bench_run_threads(size_t           threads_number,
+                           bench_routine_t  routine,
+                           void            *context) {
+    C_ASSERT(routine        != NULL             , return 0);
+    C_ASSERT(threads_number <= bench_max_threads, return 0);
+
+    bench_thread_t threads[bench_max_threads] = {};
+
+    uint64_t start   = clocks_wall_ns();
+    size_t   started = 0;
+    for(; started < threads_number; started++) {
+        threads[started].index   = started;
+        threads[started].routine = routine;
+        threads[started].context = context;
+        if(!thread_start(&threads[started]))
+            break;
+    }
+
+    for(size_t thread = 0; thread < started; thread++)
+        thread_join(&threads[thread]);
+
+    if(started != threads_number)
+        return 0;
+
+    uint64_t time = clocks_wall_ns() - start;
+    return time == 0 ? 1 : time;
+}
+
+void bench_yield(void) {
+    #ifdef _WIN32
+        SwitchToThread();
+    #else
+        sched_yield();
+    #endif
+}
+
+bench_mutex_t *bench_mutex_create(void) {
+    bench_mutex_t *mutex = (bench_mutex_t *)_calloc(1, sizeof(bench_mutex_t));
+    if(mutex == NULL)
+        return NULL;
+
+    #ifdef _WIN32
+        InitializeCriticalSection(&mutex->mutex);
+    #else
+        pthread_mutex_init(&mutex->mutex, NULL);
+    #endif
+    return mutex;
+}
+
+void bench_mutex_lock(bench_mutex_t *mutex) {
+    #ifdef _WIN32
+        EnterCriticalSection(&mutex->mutex);
+    #else
+        pthread_mutex_lock(&mutex->mutex);
+    #endif
+}
+
+void bench_mutex_unlock(bench_mutex_t *mutex) {
+    #ifdef _WIN32
+        LeaveCriticalSection(&mutex->mutex);
+    #else
+        pthread_mutex_unlock(&mutex->mutex);
+    #endif
+}
+
+void bench_mutex_destroy(bench_mutex_t **mutex) {
+    C_ASSERT(mutex != NULL, return );
+
+    if(*mutex == NULL)
+        return ;
+
+    #ifdef _WIN32
+        DeleteCriticalSection(&(*mutex)->mutex);
+    #else
+        pthread_mutex_destroy(&(*mutex)->mutex);
+    #endif
+    _free(*mutex);
+    *mutex = NULL;
+}
+
+uint64_t bench_parse_number(int         argc,
+                            const char *argv[],
+                            int         index,
+                            uint64_t    default_value) {
+    if(index >= argc)
+        return default_value;
+
+    char              *end    = NULL;
+    unsigned long long number = strtoull(argv[index], &end, 10);
+    if(*end != '\0')
+        return 0;
+
+    return number;
+}
+
+void bench_print_header(void) {
+    printf("%-32s %8s %12s %12s\r\n", "benchmark", "threads", "ns/op", "Mops/s");
+}
+
+void bench_print(const char *name,
+                 size_t      threads_number,
+                 uint64_t    operations,
+                 uint64_t    time) {
+    C_ASSERT(name != NULL, return );
+
+    if(time == 0 || operations == 0) {
+        printf("%-32s %8zu %12s %12s\r\n", name, threads_number, "failed", "-");
+        return ;
+    }
+
+    //threads run at the same time, so time of one operation is wall time of
+    //one thread divided by operations of one thread
+    double operation_time = (double)time * (double)threads_number / (double)operations;
+    printf("%-32s %8zu %12.1f %12.2f\r\n",
+           name,
+           threads_number,
+           operation_time,
+           (double)operations * 1000 / (double)time);
+    fflush(stdout);
+}
+
+//==============================================================================
+//THREAD FUNCTIONS OF PLATFORM
+//==============================================================================
+#ifdef _WIN32
+    static DWORD WINAPI thread_routine(LPVOID argument) {
+        bench_thread_t *thread = (bench_thread_t *)argument;
+        thread->routine(thread->index, thread->context);
+        return 0;
+    }
+
+    bool thread_start(bench_thread_t *thread) {
+        thread->thread = CreateThread(NULL, 0, thread_routine, thread, 0, NULL);
+        return thread->thread != NULL;
+    }
+
+    void thread_join(bench_thread_t *thread) {
+        WaitForSingleObject(thread->thread, INFINITE);
+        CloseHandle(thread->thread);
+    }
+#else
+    static void *thread_routine(void *argument) {
+        bench_thread_t *thread = (bench_thread_t *)argument;
+        thread->routine(thread->index, thread->context);
+        return NULL;
+    }
+
+    bool thread_start(bench_thread_t *thread) {
+        return pthread_create(&thread->thread, NULL, thread_routine, thread) == 0;
+    }
+
+    void thread_join(bench_thread_t *thread) {
+        pthread_join(thread->thread, NULL);
+    }
+#endif
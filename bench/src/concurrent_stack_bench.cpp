@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "concurrent_stack.h"
+#include "stack.h"
+#include "memory.h"
+#include "utils.h"
+#include "colors.h"
+
+//==============================================================================
+//EVERY THREAD PUSHES ITS NUMBER AND POPS ANY NUMBER BACK operations TIMES,
+//SO STACK IS SHORT AND ALL THREADS FIGHT FOR ITS TOP
+//==============================================================================
+static const uint64_t default_operations = 200000;
+static const size_t   elimination_size   = 16;
+static const size_t   threads_numbers[]  = {1, 2, 4, 8};
+
+struct concurrent_context_t {
+    concurrent_stack_t *stack;
+    uint64_t            operations;
+    bool                has_error;
+};
+
+struct mutex_context_t {
+    stack_t            *stack;
+    bench_mutex_t      *mutex;
+    uint64_t            operations;
+    bool                has_error;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static void     concurrent_routine(size_t               thread_index,
+                                   void                *context);
+static void     mutex_routine     (size_t               thread_index,
+                                   void                *context);
+static uint64_t run_concurrent    (size_t               threads_number,
+                                   uint64_t             operations,
+                                   size_t               elimination);
+static uint64_t run_mutex         (size_t               threads_number,
+                                   uint64_t             operations);
+
+//------------------------------------------------------------------------------
+//concurrent_stack_bench [operations per thread]
+//COMPARES LOCK-FREE STACK WITH AND WITHOUT ELIMINATION TO stack_t UNDER MUTEX
+//------------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+    _memory_disable_log();
+
+    uint64_t operations = bench_parse_number(argc, argv, 1, default_operations);
+    if(operations == 0) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Expected positive number of operations per thread.\r\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_print_header();
+    for(size_t index = 0; index < sizeof(threads_numbers) / sizeof(threads_numbers[0]); index++) {
+        size_t   threads_number = threads_numbers[index];
+        uint64_t total          = 2 * operations * threads_number;
+
+        bench_print("concurrent_stack_t",
+                    threads_number, total, run_concurrent(threads_number, operations, 0));
+        bench_print("concurrent_stack_t elimination",
+                    threads_number, total, run_concurrent(threads_number, operations, elimination_size));
+        bench_print("stack_t under mutex",
+                    threads_number, total, run_mutex     (threads_number, operations));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void concurrent_routine(size_t thread_index,
+                        void  *context) {
+    concurrent_context_t *bench   = (concurrent_context_t *)context;
+    double                element = (double)thread_index;
+
+    for(uint64_t operation = 0; operation < bench->operations; operation++) {
+        if(concurrent_stack_push(bench->stack, &element) != STACK_SUCCESS) {
+            bench->has_error = true;
+            return ;
+        }
+
+        stack_error_t error_code = STACK_EMPTY;
+        while((error_code = concurrent_stack_pop(bench->stack, &element)) == STACK_EMPTY)
+            ;
+
+        if(error_code != STACK_SUCCESS) {
+            bench->has_error = true;
+            return ;
+        }
+    }
+}
+
+void mutex_routine(size_t thread_index,
+                   void  *context) {
+    mutex_context_t *bench   = (mutex_context_t *)context;
+    double           element = (double)thread_index;
+
+    for(uint64_t operation = 0; operation < bench->operations; operation++) {
+        bench_mutex_lock(bench->mutex);
+        stack_error_t error_code = stack_push(&bench->stack, &element);
+        bench_mutex_unlock(bench->mutex);
+        if(error_code != STACK_SUCCESS) {
+            bench->has_error = true;
+            return ;
+        }
+
+        bench_mutex_lock(bench->mutex);
+        error_code = stack_pop(&bench->stack, &element);
+        bench_mutex_unlock(bench->mutex);
+        if(error_code != STACK_SUCCESS) {
+            bench->has_error = true;
+            return ;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//RETURNS WALL TIME, 0 IF STACK WAS NOT CREATED OR OPERATION FAILED
+//------------------------------------------------------------------------------
+uint64_t run_concurrent(size_t   threads_number,
+                        uint64_t operations,
+                        size_t   elimination) {
+    concurrent_context_t context = {
+        .stack      = concurrent_stack_init(threads_number, sizeof(double), elimination),
+        .operations = operations,
+        .has_error  = false};
+    if(context.stack == NULL)
+        return 0;
+
+    uint64_t time = bench_run_threads(threads_number, concurrent_routine, &context);
+    concurrent_stack_destroy(&context.stack);
+    return context.has_error ? 0 : time;
+}
+
+uint64_t run_mutex(size_t   threads_number,
+                   uint64_t operations) {
+    mutex_context_t context = {
+        .stack      = stack_init(DUMP_INIT("bench_stack.log",
+                                           context.stack,
+                                           file_print_double)
+                                 threads_number,
+                                 sizeof(double)),
+        .mutex      = bench_mutex_create(),
+        .operations = operations,
+        .has_error  = false};
+
+    uint64_t time = 0;
+    if(context.stack != NULL && context.mutex != NULL)
+        time = bench_run_threads(threads_number, mutex_routine, &context);
+
+    stack_destroy      (&context.stack);
+    bench_mutex_destroy(&context.mutex);
+    return context.has_error ? 0 : time;
+}
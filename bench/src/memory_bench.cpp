@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "memory.h"
+#include "colors.h"
+
+//==============================================================================
+//CHURN FREES RANDOM BLOCK OF WINDOW AND ALLOCATES BLOCK OF RANDOM SIZE IN ITS
+//PLACE, GROWTH DOUBLES ARRAY WITH _recalloc AS LABELS, FIXUPS AND CODE DO
+//==============================================================================
+static const uint64_t default_operations = 1000000;
+static const size_t   window_size        = 512;
+static const size_t   min_block_size     = 16;
+static const size_t   max_block_size     = 4096;
+static const size_t   arena_chunk_size   = 64 * 1024;
+static const size_t   growth_start_size  = 32;
+static const size_t   growth_end_size    = 64 * 1024;
+
+enum bench_backend_t {
+    BACKEND_LIBC  ,
+    BACKEND_SYSTEM,
+    BACKEND_POOLS ,
+    BACKEND_ARENA ,
+};
+
+struct memory_context_t {
+    bench_backend_t backend;
+    uint64_t        operations;
+    bool            has_error;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static void     churn_routine (size_t           thread_index,
+                               void            *context);
+static void     growth_routine(size_t           thread_index,
+                               void            *context);
+static bool     grow_array    (bench_backend_t  backend);
+static uint64_t run_memory    (bench_backend_t  backend,
+                               uint64_t         operations,
+                               bench_routine_t  routine);
+static size_t   random_number (uint64_t        *state);
+
+//------------------------------------------------------------------------------
+//memory_bench [operations]
+//COMPARES _calloc/_recalloc/_free WITH SYSTEM, POOLS AND ARENA BACKENDS TO
+//calloc/realloc/free
+//------------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+    _memory_disable_log();
+
+    uint64_t operations = bench_parse_number(argc, argv, 1, default_operations);
+    if(operations == 0) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Expected positive number of operations.\r\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_print_header();
+    bench_print("churn calloc/free",
+                1, operations, run_memory(BACKEND_LIBC  , operations, churn_routine));
+    bench_print("churn _calloc system",
+                1, operations, run_memory(BACKEND_SYSTEM, operations, churn_routine));
+    bench_print("churn _calloc pools",
+                1, operations, run_memory(BACKEND_POOLS , operations, churn_routine));
+
+    //one operation is one array grown from growth_start_size to growth_end_size
+    uint64_t arrays = operations / 64 == 0 ? 1 : operations / 64;
+    bench_print("growth realloc",
+                1, arrays, run_memory(BACKEND_LIBC  , arrays, growth_routine));
+    bench_print("growth _recalloc system",
+                1, arrays, run_memory(BACKEND_SYSTEM, arrays, growth_routine));
+    bench_print("growth _recalloc pools",
+                1, arrays, run_memory(BACKEND_POOLS , arrays, growth_routine));
+    bench_print("growth _recalloc arena",
+                1, arrays, run_memory(BACKEND_ARENA , arrays, growth_routine));
+
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//ARENA DOES NOT FREE SEPARATE BLOCKS, SO IT IS NOT USED FOR CHURN
+//------------------------------------------------------------------------------
+void churn_routine(size_t /*thread_index*/,
+                   void  *context) {
+    memory_context_t   *bench     = (memory_context_t *)context;
+    memory_allocator_t *allocator = NULL;
+    if(bench->backend == BACKEND_POOLS) {
+        allocator = memory_pools_create();
+        if(allocator == NULL) {
+            bench->has_error = true;
+            return ;
+        }
+    }
+    memory_bind(MEMORY_TAG_DEFAULT, allocator);
+
+    void    *blocks[window_size] = {};
+    uint64_t state               = 1;
+    for(uint64_t operation = 0; operation < bench->operations && !bench->has_error; operation++) {
+        size_t slot = random_number(&state) % window_size;
+        size_t size = min_block_size + random_number(&state) % (max_block_size - min_block_size + 1);
+
+        if(bench->backend == BACKEND_LIBC) {
+            free(blocks[slot]);
+            blocks[slot] = calloc(size, 1);
+        }
+        else {
+            _free(blocks[slot]);
+            blocks[slot] = _calloc(size, 1);
+        }
+        bench->has_error = blocks[slot] == NULL;
+    }
+
+    for(size_t slot = 0; slot < window_size; slot++) {
+        if(bench->backend == BACKEND_LIBC)
+            free (blocks[slot]);
+        else
+            _free(blocks[slot]);
+    }
+
+    memory_bind(MEMORY_TAG_DEFAULT, NULL);
+    memory_allocator_destroy(&allocator);
+}
+
+//------------------------------------------------------------------------------
+//EVERY ARRAY GETS NEW ARENA AS EVERY ASSEMBLED PROGRAM DOES, POOLS ARE SHARED
+//------------------------------------------------------------------------------
+void growth_routine(size_t /*thread_index*/,
+                    void  *context) {
+    memory_context_t   *bench     = (memory_context_t *)context;
+    memory_allocator_t *allocator = NULL;
+    if(bench->backend == BACKEND_POOLS) {
+        allocator = memory_pools_create();
+        if(allocator == NULL) {
+            bench->has_error = true;
+            return ;
+        }
+    }
+    memory_bind(MEMORY_TAG_DEFAULT, allocator);
+
+    for(uint64_t operation = 0; operation < bench->operations && !bench->has_error; operation++) {
+        if(bench->backend == BACKEND_ARENA) {
+            allocator = memory_arena_create(arena_chunk_size);
+            if(allocator == NULL) {
+                bench->has_error = true;
+                break;
+            }
+            memory_bind(MEMORY_TAG_DEFAULT, allocator);
+        }
+
+        bench->has_error = !grow_array(bench->backend);
+
+        if(bench->backend == BACKEND_ARENA) {
+            memory_bind(MEMORY_TAG_DEFAULT, NULL);
+            memory_allocator_destroy(&allocator);
+        }
+    }
+
+    memory_bind(MEMORY_TAG_DEFAULT, NULL);
+    memory_allocator_destroy(&allocator);
+}
+
+bool grow_array(bench_backend_t backend) {
+    void  *array = NULL;
+    size_t size  = 0;
+    for(size_t new_size = growth_start_size; new_size <= growth_end_size; new_size *= 2) {
+        void *new_array = backend == BACKEND_LIBC ? realloc  (array, new_size) :
+                                                    _recalloc(array, size, new_size, 1);
+        if(new_array == NULL)
+            break;
+
+        array = new_array;
+        size  = new_size;
+    }
+
+    if(backend == BACKEND_LIBC)
+        free (array);
+    else
+        _free(array);
+    return size == growth_end_size;
+}
+
+//------------------------------------------------------------------------------
+//RETURNS WALL TIME, 0 IF ALLOCATOR WAS NOT CREATED OR ALLOCATION FAILED.
+//ALLOCATORS ARE BOUND TO THREAD, SO ROUTINE RUNS ON ITS OWN THREAD AND BINDS
+//THEM ITSELF
+//------------------------------------------------------------------------------
+uint64_t run_memory(bench_backend_t backend,
+                    uint64_t        operations,
+                    bench_routine_t routine) {
+    memory_context_t context = {
+        .backend    = backend,
+        .operations = operations,
+        .has_error  = false};
+
+    uint64_t time = bench_run_threads(1, routine, &context);
+    return context.has_error ? 0 : time;
+}
+
+//xorshift, the same sequence of blocks for every backend
+size_t random_number(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (size_t)*state;
+}
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "queue.h"
+#include "stack.h"
+#include "memory.h"
+#include "utils.h"
+#include "colors.h"
+
+//==============================================================================
+//EVEN THREADS ARE PRODUCERS AND ODD THREADS ARE CONSUMERS, EVERY PRODUCER
+//PUTS operations ELEMENTS AND EVERY CONSUMER TAKES THE SAME NUMBER
+//==============================================================================
+static const uint64_t default_operations = 20000;
+static const size_t   queue_capacity     = 1024;
+static const size_t   batch_size         = 16;
+static const size_t   pairs_numbers[]    = {1, 2, 4};
+
+//queue which could be made of existing code: two stack_t under one mutex,
+//elements are moved from input stack to output stack when output is empty.
+//it holds at most queue_capacity elements as ring queue does
+struct stack_queue_t {
+    stack_t       *input;
+    stack_t       *output;
+    bench_mutex_t *mutex;
+};
+
+struct ring_context_t {
+    queue_t       *queue;
+    size_t         batch;
+    uint64_t       operations;
+    bool           has_error;
+};
+
+struct stack_context_t {
+    stack_queue_t  queue;
+    uint64_t       operations;
+    bool           has_error;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static void          ring_routine       (size_t          thread_index,
+                                         void           *context);
+static void          stack_routine      (size_t          thread_index,
+                                         void           *context);
+static uint64_t      run_ring           (queue_kind_t    kind,
+                                         size_t          pairs_number,
+                                         uint64_t        operations,
+                                         size_t          batch);
+static uint64_t      run_stack_queue    (size_t          pairs_number,
+                                         uint64_t        operations);
+static stack_error_t stack_queue_enqueue(stack_queue_t  *queue,
+                                         double          element);
+static stack_error_t stack_queue_dequeue(stack_queue_t  *queue,
+                                         double         *element);
+
+//------------------------------------------------------------------------------
+//queue_bench [operations per thread]
+//COMPARES RING QUEUE WITH SINGLE AND BATCH OPERATIONS TO QUEUE MADE OF stack_t
+//------------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+    _memory_disable_log();
+
+    uint64_t operations = bench_parse_number(argc, argv, 1, default_operations);
+    if(operations == 0) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Expected positive number of operations per thread.\r\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_print_header();
+    for(size_t index = 0; index < sizeof(pairs_numbers) / sizeof(pairs_numbers[0]); index++) {
+        size_t   pairs_number = pairs_numbers[index];
+        uint64_t total        = 2 * operations * pairs_number;
+
+        if(pairs_number == 1) {
+            bench_print("queue_t SPSC",
+                        2, total, run_ring(QUEUE_SPSC, 1, operations, 1));
+            bench_print("queue_t SPSC batch",
+                        2, total, run_ring(QUEUE_SPSC, 1, operations, batch_size));
+        }
+        bench_print("queue_t MPMC",
+                    2 * pairs_number, total, run_ring(QUEUE_MPMC, pairs_number, operations, 1));
+        bench_print("queue_t MPMC batch",
+                    2 * pairs_number, total, run_ring(QUEUE_MPMC, pairs_number, operations, batch_size));
+        bench_print("two stack_t under mutex",
+                    2 * pairs_number, total, run_stack_queue(pairs_number, operations));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//FULL OR EMPTY QUEUE MAKES THREAD YIELD, SO THAT OTHER SIDE CAN RUN
+//------------------------------------------------------------------------------
+void ring_routine(size_t thread_index,
+                  void  *context) {
+    ring_context_t *bench                = (ring_context_t *)context;
+    double          elements[batch_size] = {};
+    bool            is_producer          = thread_index % 2 == 0;
+
+    for(uint64_t moved = 0; moved < bench->operations;) {
+        size_t count = bench->operations - moved < bench->batch ?
+                       (size_t)(bench->operations - moved) : bench->batch;
+        size_t done  = 0;
+
+        if(count == 1) {
+            queue_error_t error_code = is_producer ? queue_enqueue(bench->queue, elements) :
+                                                     queue_dequeue(bench->queue, elements);
+            if(error_code == QUEUE_SUCCESS)
+                done = 1;
+            else if(error_code != QUEUE_FULL && error_code != QUEUE_EMPTY) {
+                bench->has_error = true;
+                return ;
+            }
+        }
+        else
+            done = is_producer ? queue_enqueue_batch(bench->queue, elements, count) :
+                                 queue_dequeue_batch(bench->queue, elements, count);
+
+        if(done == 0)
+            bench_yield();
+        moved += done;
+    }
+}
+
+void stack_routine(size_t thread_index,
+                   void  *context) {
+    stack_context_t *bench       = (stack_context_t *)context;
+    double           element     = (double)thread_index;
+    bool             is_producer = thread_index % 2 == 0;
+
+    for(uint64_t moved = 0; moved < bench->operations;) {
+        stack_error_t error_code = is_producer ? stack_queue_enqueue(&bench->queue,  element) :
+                                                 stack_queue_dequeue(&bench->queue, &element);
+        if(error_code == STACK_SUCCESS)
+            moved++;
+        else if(error_code == STACK_EMPTY || error_code == STACK_OVERFLOW)
+            bench_yield();
+        else {
+            bench->has_error = true;
+            return ;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//RETURNS WALL TIME, 0 IF QUEUE WAS NOT CREATED OR OPERATION FAILED
+//------------------------------------------------------------------------------
+uint64_t run_ring(queue_kind_t kind,
+                  size_t       pairs_number,
+                  uint64_t     operations,
+                  size_t       batch) {
+    ring_context_t context = {
+        .queue      = queue_init(DUMP_INIT("bench_queue.log",
+                                           context.queue,
+                                           file_print_double)
+                                 kind,
+                                 queue_capacity,
+                                 sizeof(double)),
+        .batch      = batch,
+        .operations = operations,
+        .has_error  = false};
+    if(context.queue == NULL)
+        return 0;
+
+    uint64_t time = bench_run_threads(2 * pairs_number, ring_routine, &context);
+    queue_destroy(&context.queue);
+    return context.has_error ? 0 : time;
+}
+
+uint64_t run_stack_queue(size_t   pairs_number,
+                         uint64_t operations) {
+    stack_context_t context = {
+        .queue      = {
+            .input  = stack_init(DUMP_INIT("bench_stack.log",
+                                           context.queue.input,
+                                           file_print_double)
+                                 queue_capacity,
+                                 sizeof(double)),
+            .output = stack_init(DUMP_INIT("bench_stack.log",
+                                           context.queue.output,
+                                           file_print_double)
+                                 queue_capacity,
+                                 sizeof(double)),
+            .mutex  = bench_mutex_create()},
+        .operations = operations,
+        .has_error  = false};
+
+    uint64_t time = 0;
+    if(context.queue.input  != NULL &&
+       context.queue.output != NULL &&
+       context.queue.mutex  != NULL)
+        time = bench_run_threads(2 * pairs_number, stack_routine, &context);
+
+    stack_destroy      (&context.queue.input );
+    stack_destroy      (&context.queue.output);
+    bench_mutex_destroy(&context.queue.mutex );
+    return context.has_error ? 0 : time;
+}
+
+stack_error_t stack_queue_enqueue(stack_queue_t *queue,
+                                  double         element) {
+    bench_mutex_lock(queue->mutex);
+    stack_error_t error_code = STACK_OVERFLOW;
+    if(stack_get_size(queue->input) + stack_get_size(queue->output) < queue_capacity)
+        error_code = stack_push(&queue->input, &element);
+    bench_mutex_unlock(queue->mutex);
+    return error_code;
+}
+
+stack_error_t stack_queue_dequeue(stack_queue_t *queue,
+                                  double        *element) {
+    stack_error_t error_code = STACK_SUCCESS;
+    bench_mutex_lock(queue->mutex);
+
+    if(stack_get_size(queue->output) == 0) {
+        while(error_code == STACK_SUCCESS && stack_get_size(queue->input) != 0) {
+            double moved = 0;
+            error_code = stack_pop(&queue->input, &moved);
+            if(error_code == STACK_SUCCESS)
+                error_code = stack_push(&queue->output, &moved);
+        }
+    }
+
+    if(error_code == STACK_SUCCESS)
+        error_code = stack_get_size(queue->output) == 0 ? STACK_EMPTY :
+                                                          stack_pop(&queue->output, element);
+
+    bench_mutex_unlock(queue->mutex);
+    return error_code;
+}
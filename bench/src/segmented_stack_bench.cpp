@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "segmented_stack.h"
+#include "stack.h"
+#include "memory.h"
+#include "utils.h"
+#include "colors.h"
+
+//==============================================================================
+//EVERY ROUND PUSHES depth ELEMENTS AND POPS ALL OF THEM BACK, SO stack_t GROWS
+//AND SHRINKS BY ITS POLICY AND SEGMENTED STACK LINKS AND FREES CHUNKS.
+//stack_t WITH STACK_HASH_PROTECTION REHASHES ITS DATA ON EVERY OPERATION, SO
+//ITS TIME GROWS WITH depth AND DEFAULT depth IS SMALL
+//==============================================================================
+static const uint64_t default_depth      = 2048;
+static const uint64_t rounds_number      = 8;
+static const size_t   chunk_capacities[] = {16, 64, 1024};
+
+struct flat_context_t {
+    stack_t            *stack;
+    uint64_t            depth;
+    bool                has_error;
+};
+
+struct segmented_context_t {
+    segmented_stack_t  *stack;
+    uint64_t            depth;
+    bool                has_error;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static void     flat_routine     (size_t               thread_index,
+                                  void                *context);
+static void     segmented_routine(size_t               thread_index,
+                                  void                *context);
+static uint64_t run_flat         (uint64_t             depth);
+static uint64_t run_segmented    (uint64_t             depth,
+                                  size_t               chunk_capacity);
+
+//------------------------------------------------------------------------------
+//segmented_stack_bench [depth]
+//COMPARES SEGMENTED STACK WITH DIFFERENT CHUNK CAPACITIES TO stack_t WHICH
+//IS REALLOCATED WHEN IT GROWS AND SHRINKS
+//------------------------------------------------------------------------------
+int main(int argc, const char *argv[]) {
+    _memory_disable_log();
+
+    uint64_t depth = bench_parse_number(argc, argv, 1, default_depth);
+    if(depth == 0) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Expected positive depth of stack.\r\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t total = 2 * depth * rounds_number;
+
+    bench_print_header();
+    bench_print("stack_t", 1, total, run_flat(depth));
+    for(size_t index = 0; index < sizeof(chunk_capacities) / sizeof(chunk_capacities[0]); index++) {
+        char name[64] = {};
+        snprintf(name, sizeof(name), "segmented_stack_t chunk %zu", chunk_capacities[index]);
+        bench_print(name, 1, total, run_segmented(depth, chunk_capacities[index]));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void flat_routine(size_t /*thread_index*/,
+                  void  *context) {
+    flat_context_t *bench   = (flat_context_t *)context;
+    double          element = 0;
+
+    for(uint64_t round = 0; round < rounds_number; round++) {
+        for(uint64_t index = 0; index < bench->depth; index++) {
+            element = (double)index;
+            if(stack_push(&bench->stack, &element) != STACK_SUCCESS) {
+                bench->has_error = true;
+                return ;
+            }
+        }
+
+        for(uint64_t index = 0; index < bench->depth; index++) {
+            if(stack_pop(&bench->stack, &element) != STACK_SUCCESS) {
+                bench->has_error = true;
+                return ;
+            }
+        }
+    }
+}
+
+void segmented_routine(size_t /*thread_index*/,
+                       void  *context) {
+    segmented_context_t *bench   = (segmented_context_t *)context;
+    double               element = 0;
+
+    for(uint64_t round = 0; round < rounds_number; round++) {
+        for(uint64_t index = 0; index < bench->depth; index++) {
+            element = (double)index;
+            if(segmented_stack_push(bench->stack, &element) != STACK_SUCCESS) {
+                bench->has_error = true;
+                return ;
+            }
+        }
+
+        for(uint64_t index = 0; index < bench->depth; index++) {
+            if(segmented_stack_pop(bench->stack, &element) != STACK_SUCCESS) {
+                bench->has_error = true;
+                return ;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//RETURNS WALL TIME, 0 IF STACK WAS NOT CREATED OR OPERATION FAILED
+//------------------------------------------------------------------------------
+uint64_t run_flat(uint64_t depth) {
+    flat_context_t context = {
+        .stack     = stack_init(DUMP_INIT("bench_stack.log",
+                                          context.stack,
+                                          file_print_double)
+                                1,
+                                sizeof(double)),
+        .depth     = depth,
+        .has_error = false};
+    if(context.stack == NULL)
+        return 0;
+
+    uint64_t time = bench_run_threads(1, flat_routine, &context);
+    stack_destroy(&context.stack);
+    return context.has_error ? 0 : time;
+}
+
+uint64_t run_segmented(uint64_t depth,
+                       size_t   chunk_capacity) {
+    segmented_context_t context = {
+        .stack     = segmented_stack_init(DUMP_INIT("bench_segmented_stack.log",
+                                                    context.stack,
+                                                    file_print_double)
+                                          chunk_capacity,
+                                          sizeof(double)),
+        .depth     = depth,
+        .has_error = false};
+    if(context.stack == NULL)
+        return 0;
+
+    uint64_t time = bench_run_threads(1, segmented_routine, &context);
+    segmented_stack_destroy(&context.stack);
+    return context.has_error ? 0 : time;
+}
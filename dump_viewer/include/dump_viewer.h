@@ -0,0 +1,33 @@
+#ifndef DUMP_VIEWER_H
+#define DUMP_VIEWER_H
+
+#include <stdio.h>
+
+enum viewer_error_t {
+    VIEWER_SUCCESS        = 0,
+    VIEWER_FLAGS_ERROR    = 1,
+    VIEWER_OPENING_ERROR  = 2,
+    VIEWER_READING_ERROR  = 3,
+    VIEWER_MEMORY_ERROR   = 4,
+    VIEWER_WRITING_ERROR  = 5,
+    VIEWER_INVALID_RECORD = 6,
+};
+
+//stack element type is unknown to viewer, so it is chosen by user
+enum element_format_t {
+    ELEMENT_FORMAT_HEX   ,
+    ELEMENT_FORMAT_DOUBLE,
+    ELEMENT_FORMAT_INT   ,
+};
+
+struct viewer_t {
+    const char *     input_filename;
+    const char *     output_filename;
+    FILE *           input;
+    FILE *           output;
+    element_format_t format;
+    char *           strings;
+    char *           data;
+};
+
+#endif
@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "stack.h"
+#include "stack_dump.h"
+#include "dump_viewer.h"
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static viewer_error_t parse_flags     (viewer_t                  *viewer,
+                                       int                        argc,
+                                       const char                *argv[]);
+static viewer_error_t open_files      (viewer_t                  *viewer);
+static viewer_error_t render_records  (viewer_t                  *viewer);
+static viewer_error_t render_record   (viewer_t                  *viewer,
+                                       const stack_dump_record_t *record);
+static viewer_error_t render_members  (viewer_t                  *viewer,
+                                       const stack_dump_record_t *record);
+static viewer_error_t render_element  (viewer_t                  *viewer,
+                                       const char                *element,
+                                       uint64_t                   element_size);
+static const char *   get_reason_text (int64_t                    call_reason);
+static viewer_error_t destroy_viewer  (viewer_t                  *viewer);
+
+/**
+======================================================================================================
+    @brief      Runs dump viewer.
+
+    @details    Reads binary stack dump records written in STACK_BINARY_DUMP mode
+                and writes them in the same text form as stack_dump(...) writes
+                in text mode.
+
+    @param [in] argc                Number of arguments typed in by user.
+    @param [in] argv                Arguments from console.
+
+    @return Exit code.
+
+======================================================================================================
+*/
+int main(int argc, const char *argv[]) {
+    viewer_t viewer = {};
+    if(parse_flags   (&viewer, argc, argv) != VIEWER_SUCCESS ||
+       open_files    (&viewer)             != VIEWER_SUCCESS ||
+       render_records(&viewer)             != VIEWER_SUCCESS) {
+        destroy_viewer(&viewer);
+        return EXIT_FAILURE;
+    }
+
+    destroy_viewer(&viewer);
+    return EXIT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Parses flags from console.
+
+    @details    dump_viewer 'dump' [-o 'output'] [-t hex|double|int]
+                Text is written to stdout if output is not set.
+                Elements are written as bytes in hex if type is not set.
+
+======================================================================================================
+*/
+viewer_error_t parse_flags(viewer_t   *viewer,
+                           int         argc,
+                           const char *argv[]) {
+    C_ASSERT(viewer != NULL, return VIEWER_FLAGS_ERROR);
+    C_ASSERT(argv   != NULL, return VIEWER_FLAGS_ERROR);
+
+    viewer->format = ELEMENT_FORMAT_HEX;
+
+    for(int arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+            viewer->output_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            arg++;
+            if     (strcmp(argv[arg], "hex"   ) == 0)
+                viewer->format = ELEMENT_FORMAT_HEX;
+            else if(strcmp(argv[arg], "double") == 0)
+                viewer->format = ELEMENT_FORMAT_DOUBLE;
+            else if(strcmp(argv[arg], "int"   ) == 0)
+                viewer->format = ELEMENT_FORMAT_INT;
+            else {
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "Unknown element type '%s'.\r\n",
+                             argv[arg]);
+                return VIEWER_FLAGS_ERROR;
+            }
+        }
+        else if(viewer->input_filename == NULL && argv[arg][0] != '-') {
+            viewer->input_filename = argv[arg];
+        }
+        else {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Unexpected flag '%s'.\r\n",
+                         argv[arg]);
+            return VIEWER_FLAGS_ERROR;
+        }
+    }
+
+    if(viewer->input_filename == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Usage: dump_viewer 'dump' [-o 'output'] [-t hex|double|int]\r\n");
+        return VIEWER_FLAGS_ERROR;
+    }
+
+    return VIEWER_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Opens binary dump and output text file.
+
+======================================================================================================
+*/
+viewer_error_t open_files(viewer_t *viewer) {
+    C_ASSERT(viewer != NULL, return VIEWER_OPENING_ERROR);
+
+    viewer->input = fopen(viewer->input_filename, "rb");
+    if(viewer->input == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening file '%s'.\r\n",
+                     viewer->input_filename);
+        return VIEWER_OPENING_ERROR;
+    }
+
+    if(viewer->output_filename == NULL) {
+        viewer->output = stdout;
+        return VIEWER_SUCCESS;
+    }
+
+    viewer->output = fopen(viewer->output_filename, "wb");
+    if(viewer->output == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening file '%s'.\r\n",
+                     viewer->output_filename);
+        return VIEWER_OPENING_ERROR;
+    }
+
+    return VIEWER_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Reads and renders records until the end of dump.
+
+    @details    Strings and data of record are read in buffers of viewer,
+                which are reallocated when record does not fit in them.
+
+======================================================================================================
+*/
+viewer_error_t render_records(viewer_t *viewer) {
+    C_ASSERT(viewer != NULL, return VIEWER_READING_ERROR);
+
+    stack_dump_record_t record = {};
+    size_t strings_capacity = 0;
+    size_t data_capacity    = 0;
+
+    while(fread(&record, sizeof(record), 1, viewer->input) == 1) {
+        size_t strings_size = record.initialized_file_length     +
+                              record.initialized_varname_length  +
+                              record.initialized_function_length +
+                              record.file_name_length            +
+                              record.function_name_length;
+        size_t data_size    = 0;
+        if(record.flags & STACK_DUMP_HAS_DATA)
+            data_size = record.capacity * record.element_size;
+
+        if(record.signature != stack_dump_signature ||
+           record.record_size != sizeof(record) + strings_size + data_size) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Invalid record in '%s'.\r\n",
+                         viewer->input_filename);
+            return VIEWER_INVALID_RECORD;
+        }
+
+        if(strings_size > strings_capacity) {
+            _free(viewer->strings);
+            viewer->strings  = (char *)_calloc(strings_size, 1);
+            strings_capacity = strings_size;
+        }
+        if(data_size > data_capacity) {
+            _free(viewer->data);
+            viewer->data  = (char *)_calloc(data_size, 1);
+            data_capacity = data_size;
+        }
+        if((strings_size != 0 && viewer->strings == NULL) ||
+           (data_size    != 0 && viewer->data    == NULL)) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating memory for record.\r\n");
+            return VIEWER_MEMORY_ERROR;
+        }
+
+        if(fread(viewer->strings, 1, strings_size, viewer->input) != strings_size ||
+           fread(viewer->data   , 1, data_size   , viewer->input) != data_size   ) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Unexpected end of file '%s'.\r\n",
+                         viewer->input_filename);
+            return VIEWER_READING_ERROR;
+        }
+
+        viewer_error_t error_code = render_record(viewer, &record);
+        if(error_code != VIEWER_SUCCESS)
+            return error_code;
+    }
+
+    return VIEWER_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Writes record in the same form as text stack_dump(...).
+
+======================================================================================================
+*/
+viewer_error_t render_record(viewer_t                  *viewer,
+                             const stack_dump_record_t *record) {
+    const char *initialized_file     = viewer->strings;
+    const char *initialized_varname  = initialized_file     + record->initialized_file_length;
+    const char *initialized_function = initialized_varname  + record->initialized_varname_length;
+    const char *file_name            = initialized_function + record->initialized_function_length;
+    const char *function_name        = file_name            + record->file_name_length;
+
+    if(fprintf(viewer->output,
+               "stack_t[0x%p] initialized in %.*s:%llu as "
+               "'stack_t %.*s' in function '%.*s'\r\n"
+               "dump called from %.*s:%llu '%.*s'\r\n"
+               "ERROR = '%s'\r\n",
+               (void *)(uintptr_t)record->stack_address,
+               (int)record->initialized_file_length, initialized_file,
+               record->initialized_line,
+               (int)record->initialized_varname_length, initialized_varname,
+               (int)record->initialized_function_length, initialized_function,
+               (int)record->file_name_length, file_name,
+               record->line,
+               (int)record->function_name_length, function_name,
+               get_reason_text(record->call_reason)) < 0)
+        return VIEWER_WRITING_ERROR;
+
+    if(record->flags & STACK_DUMP_HAS_CANARIES) {
+        if(fprintf(viewer->output,
+                   "{\r\n"
+                   "\t\t---CANARIES---\r\n"
+                   "\tcanary_left       = 0x%llx;\r\n"
+                   "\tdata_canary_left [0x%p] = 0x%llx;\r\n"
+                   "\tdata_canary_right[0x%p] = 0x%llx;\r\n"
+                   "\tcanary_right      = 0x%llx;\r\n",
+                   record->structure_left_canary,
+                   (void *)(uintptr_t)record->data_left_canary_address,
+                   record->data_left_canary,
+                   (void *)(uintptr_t)record->data_right_canary_address,
+                   record->data_right_canary,
+                   record->structure_right_canary) < 0)
+            return VIEWER_WRITING_ERROR;
+    }
+
+    if(record->flags & STACK_DUMP_HAS_HASHES) {
+        if(fprintf(viewer->output,
+                   "\t\t---HASHES---\r\n"
+                   "\tstructure_hash    = 0x%llx;\r\n"
+                   "\tdata_hash         = 0x%llx;\r\n",
+                   record->structure_hash,
+                   record->data_hash) < 0)
+            return VIEWER_WRITING_ERROR;
+    }
+
+    if(fprintf(viewer->output,
+               "\t\t---DEFAULT_INFO---\r\n"
+               "\tsize              =   %llu;\r\n"
+               "\tcapacity          =   %llu;\r\n"
+               "\telement_size      =   %llu;\r\n"
+               "\t\t---POLICY---\r\n"
+               "\tgrowth_factor     =   %llu;\r\n"
+               "\tshrink_threshold  =   %llu;\r\n"
+               "\tshrink_factor     =   %llu;\r\n"
+               "\tmin_capacity      =   %llu;\r\n"
+               "\tis_pinned         =   %d;\r\n"
+               "\t\t---MEMBERS---\r\n"
+               "\tdata[0x%p]:\r\n",
+               record->size,
+               record->capacity,
+               record->element_size,
+               record->growth_factor,
+               record->shrink_threshold,
+               record->shrink_factor,
+               record->min_capacity,
+               (int)record->is_pinned,
+               (void *)(uintptr_t)record->data_address) < 0)
+        return VIEWER_WRITING_ERROR;
+
+    viewer_error_t error_code = render_members(viewer, record);
+    if(error_code != VIEWER_SUCCESS)
+        return error_code;
+
+    if(fprintf(viewer->output,
+               "}\r\n\r\n") < 0)
+        return VIEWER_WRITING_ERROR;
+
+    return VIEWER_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Writes stack members with * before index and (POISON) after
+                elements out of stack size.
+
+======================================================================================================
+*/
+viewer_error_t render_members(viewer_t                  *viewer,
+                              const stack_dump_record_t *record) {
+    if(record->data_address == 0) {
+        if(fprintf(viewer->output,
+                   "\t\t--- (POISON)\r\n") < 0)
+            return VIEWER_WRITING_ERROR;
+
+        return VIEWER_SUCCESS;
+    }
+    if(!(record->flags & STACK_DUMP_HAS_DATA)) {
+        if(fprintf(viewer->output,
+                   "\t\tincorrect size\r\n") < 0)
+            return VIEWER_WRITING_ERROR;
+
+        return VIEWER_SUCCESS;
+    }
+
+    for(uint64_t element = 0; element < record->capacity; element++) {
+        bool is_poison = element >= record->size;
+
+        if(fprintf(viewer->output,
+                   "\t   %s[%llu] = ",
+                   is_poison ? "*" : " ",
+                   element) < 0)
+            return VIEWER_WRITING_ERROR;
+
+        viewer_error_t error_code = render_element(viewer,
+                                                   viewer->data + element * record->element_size,
+                                                   record->element_size);
+        if(error_code != VIEWER_SUCCESS)
+            return error_code;
+
+        if(fprintf(viewer->output,
+                   "%s;\r\n",
+                   is_poison ? " (POISON)" : "") < 0)
+            return VIEWER_WRITING_ERROR;
+    }
+
+    return VIEWER_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Writes one element in format chosen by user.
+
+    @details    double and int formats are used only for 8 byte elements,
+                other elements are written as bytes in hex.
+
+======================================================================================================
+*/
+viewer_error_t render_element(viewer_t   *viewer,
+                              const char *element,
+                              uint64_t    element_size) {
+    if(element_size == sizeof(double) && viewer->format == ELEMENT_FORMAT_DOUBLE) {
+        double value = 0;
+        memcpy(&value, element, sizeof(value));
+        if(fprintf(viewer->output, "%lg", value) < 0)
+            return VIEWER_WRITING_ERROR;
+
+        return VIEWER_SUCCESS;
+    }
+
+    if(element_size == sizeof(int64_t) && viewer->format == ELEMENT_FORMAT_INT) {
+        int64_t value = 0;
+        memcpy(&value, element, sizeof(value));
+        if(fprintf(viewer->output, "%lld", value) < 0)
+            return VIEWER_WRITING_ERROR;
+
+        return VIEWER_SUCCESS;
+    }
+
+    for(uint64_t byte = 0; byte < element_size; byte++)
+        if(fprintf(viewer->output, "%02x", (unsigned char)element[byte]) < 0)
+            return VIEWER_WRITING_ERROR;
+
+    return VIEWER_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Returns text of dump reason in the same form as text dump.
+
+======================================================================================================
+*/
+const char *get_reason_text(int64_t call_reason) {
+    const char *text = NULL;
+    #ifdef STACK_WRITE_DUMP
+        text = stack_error_text((stack_error_t)call_reason);
+    #endif
+
+    if(text == NULL)
+        return "'unknown error'";
+
+    return text;
+}
+
+/**
+======================================================================================================
+    @brief      Closes files and frees buffers.
+
+======================================================================================================
+*/
+viewer_error_t destroy_viewer(viewer_t *viewer) {
+    if(viewer->input != NULL)
+        fclose(viewer->input);
+
+    if(viewer->output != NULL && viewer->output != stdout)
+        fclose(viewer->output);
+
+    _free(viewer->strings);
+    _free(viewer->data);
+    memset(viewer, 0, sizeof(viewer_t));
+    _memory_destroy_log();
+    return VIEWER_SUCCESS;
+}
@@ -0,0 +1,13 @@
+#ifndef CLOCKS_H
+#define CLOCKS_H
+
+#include <stdint.h>
+
+//monotonic wall clock in nanoseconds, its start point is unspecified,
+//so only differences of values make sense
+uint64_t clocks_wall_ns(void);
+
+//processor time of the whole process (user and system) in nanoseconds
+uint64_t clocks_cpu_ns (void);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef CONCURRENT_STACK_H
+#define CONCURRENT_STACK_H
+
+#include <stdio.h>
+
+#include "stack.h"
+
+//lock-free stack (Treiber stack) which can be shared between threads.
+//all nodes are preallocated in pool of capacity elements, push to stack
+//with empty pool returns STACK_OVERFLOW. node references are tagged to
+//avoid ABA problem. if elimination_size is not zero, push and pop that
+//failed on contended top try to meet each other in elimination array.
+struct concurrent_stack_t;
+
+concurrent_stack_t *concurrent_stack_init   (size_t               capacity,
+                                             size_t               element_size,
+                                             size_t               elimination_size);
+stack_error_t       concurrent_stack_push   (concurrent_stack_t  *stack,
+                                             const void          *element);
+stack_error_t       concurrent_stack_pop    (concurrent_stack_t  *stack,
+                                             void                *output);
+stack_error_t       concurrent_stack_destroy(concurrent_stack_t **stack);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef DUMP_WRITER_H
+#define DUMP_WRITER_H
+
+#include <stdio.h>
+
+enum dump_writer_error_t {
+    DUMP_WRITER_SUCCESS      = 0,
+    DUMP_WRITER_NULL         = 1,
+    DUMP_WRITER_MEMORY_ERROR = 2,
+    DUMP_WRITER_FILE_ERROR   = 3,
+    DUMP_WRITER_THREAD_ERROR = 4,
+};
+
+//asynchronous file writer: records are copied into ring buffer and written
+//to file by background thread, so writing record costs one memory copy.
+//one writer can be used by one thread at a time.
+struct dump_writer_t;
+
+//record is written as concatenation of parts
+struct dump_writer_part_t {
+    const void *data;
+    size_t      size;
+};
+
+dump_writer_t *     dump_writer_open (const char               *filename,
+                                      size_t                    buffer_size);
+dump_writer_error_t dump_writer_write(dump_writer_t            *writer,
+                                      const dump_writer_part_t *parts,
+                                      size_t                    parts_number);
+//waits until background thread writes everything to file
+dump_writer_error_t dump_writer_flush(dump_writer_t            *writer);
+dump_writer_error_t dump_writer_close(dump_writer_t           **writer);
+
+#endif
@@ -4,13 +4,84 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+//subsystem which owns allocated memory, every tag can be bound to its own
+//allocator with memory_bind(...)
+enum memory_tag_t {
+    MEMORY_TAG_DEFAULT,
+    MEMORY_TAG_CODE   ,
+    MEMORY_TAG_STACK  ,
+    MEMORY_TAG_RAM    ,
+    MEMORY_TAG_LABELS ,
+    MEMORY_TAG_FIXUPS ,
+    MEMORY_TAG_SOURCE ,
+    MEMORY_TAGS_NUMBER,
+};
+
+//allocator backend: arena hands out memory by bumping pointer and frees
+//everything only in memory_allocator_destroy(...), pools keep free lists of
+//blocks of size classes and fall back to system allocator for big blocks.
+//blocks of 1 MiB and more are always mapped as pages and must be freed.
+//allocator is not thread safe, it must be used by one thread at a time.
+struct memory_allocator_t;
+
+//counters of operations are merged from all threads, live and peak bytes
+//are counted for whole process, so peak is the biggest amount of memory
+//which was allocated at one moment. blocks of arena are counted as freed
+//when arena is destroyed, _free of such block does not change statistics
+struct memory_tag_stats_t {
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t allocations;
+    size_t frees;
+};
+
+struct memory_stats_t {
+    size_t             live_bytes;
+    size_t             peak_bytes;
+    size_t             allocations;
+    size_t             frees;
+    size_t             reallocations;
+    size_t             realloc_moves;
+    memory_tag_stats_t tags[MEMORY_TAGS_NUMBER];
+};
+
 void *_recalloc         (void * memory_cell,
                          size_t old_size,
                          size_t new_size,
                          size_t element_size);
 void *_calloc           (size_t number,
                          size_t element_size);
+void *_calloc_tagged    (memory_tag_t tag,
+                         size_t       number,
+                         size_t       element_size);
 void _free              (void *memory_cell);
+//alignment must be power of two, memory must be freed with _aligned_free
+void *_aligned_calloc   (size_t number,
+                         size_t element_size,
+                         size_t alignment);
+void _aligned_free      (void *memory_cell);
+//allocations are traced to memory.trace in debug builds, destroying log
+//writes everything traced so far, disabled log is not written any more
 void _memory_destroy_log(void);
+void _memory_disable_log(void);
+
+memory_allocator_t *memory_arena_create     (size_t               chunk_size);
+memory_allocator_t *memory_pools_create     (void);
+void                memory_allocator_destroy(memory_allocator_t **allocator);
+
+//binding is set for calling thread, NULL allocator means system allocator
+void                memory_bind             (memory_tag_t         tag,
+                                             memory_allocator_t  *allocator);
+memory_allocator_t *memory_bound            (memory_tag_t         tag);
+
+//counts memory which is not taken from _calloc (e.g. mapped with pages_map)
+//in statistics of tag, add is counted as allocation and remove as free
+void                memory_stats_add        (memory_tag_t         tag,
+                                             size_t               bytes);
+void                memory_stats_remove     (memory_tag_t         tag,
+                                             size_t               bytes);
+void                memory_get_stats        (memory_stats_t      *stats);
+void                memory_print_stats      (FILE                *stream);
+const char *        memory_tag_name         (memory_tag_t         tag);
 
 #endif
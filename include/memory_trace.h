@@ -0,0 +1,42 @@
+#ifndef MEMORY_TRACE_H
+#define MEMORY_TRACE_H
+
+#include <stdint.h>
+
+//binary allocation trace, it is written by memory subsystem in debug builds
+//and processed by memory_report. file starts with memory_trace_header_t and
+//is followed by records of record_size bytes. records of different threads
+//are interleaved and must be ordered by timestamp before processing.
+static const uint32_t memory_trace_signature = 0x4352544D; //"MTRC"
+static const uint32_t memory_trace_version   = 2;
+
+enum memory_trace_operation_t {
+    MEMORY_TRACE_ALLOCATION  ,
+    MEMORY_TRACE_REALLOCATION,
+    MEMORY_TRACE_FREE        ,
+};
+
+//load_bias is address where executable is loaded minus address it is linked
+//for (nonzero for PIE and ASLR), call_site - load_bias can be given to addr2line
+struct memory_trace_header_t {
+    uint32_t signature;
+    uint32_t version;
+    uint64_t record_size;
+    uint64_t load_bias;
+};
+
+//sizes are in bytes, timestamp is monotonic time in nanoseconds,
+//call_site is return address of _calloc, _recalloc or _free call
+struct memory_trace_record_t {
+    uint32_t operation;
+    uint32_t tag;
+    uint64_t thread;
+    uint64_t timestamp;
+    uint64_t call_site;
+    uint64_t memory;
+    uint64_t size;
+    uint64_t old_memory;
+    uint64_t old_size;
+};
+
+#endif
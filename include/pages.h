@@ -0,0 +1,61 @@
+#ifndef PAGES_H
+#define PAGES_H
+
+#include <stdio.h>
+
+enum pages_error_t {
+    PAGES_SUCCESS          = 0,
+    PAGES_MAPPING_ERROR    = 1,
+    PAGES_PROTECTION_ERROR = 2,
+    PAGES_HANDLER_ERROR    = 3,
+    PAGES_ADVICE_ERROR     = 4,
+};
+
+enum pages_access_t {
+    PAGES_NO_ACCESS ,
+    PAGES_READ_ONLY ,
+    PAGES_READ_WRITE,
+};
+
+enum pages_fault_action_t {
+    PAGES_FAULT_IGNORED   = 0, //address does not belong to handler
+    PAGES_FAULT_TERMINATE = 1, //process is terminated with default action
+    PAGES_FAULT_CONTINUE  = 2, //handler made address accessible, access is repeated
+};
+
+//fault handler gets address of faulting access and tells what to do with it,
+//it is called from signal handler (vectored exception handler on Windows), so
+//it must not jump out of it
+typedef pages_fault_action_t (*pages_fault_handler_t)(void *fault_address, void *context);
+
+size_t        pages_size                (void);
+size_t        pages_round_up            (size_t                size);
+void *        pages_map                 (size_t                size,
+                                         pages_access_t        access);
+pages_error_t pages_protect             (void                 *address,
+                                         size_t                size,
+                                         pages_access_t        access);
+pages_error_t pages_unmap               (void                 *address,
+                                         size_t                size);
+//contents are kept, new pages are zeroed, mapping can be moved
+void *        pages_remap               (void                 *address,
+                                         size_t                old_size,
+                                         size_t                new_size);
+//maps file with shared read-write access, so changes are written to file by
+//system. file is created if it does not exist and is extended with zeros to
+//size. if address is not NULL, mapping replaces pages at this address (it is
+//not supported on Windows)
+void *        pages_map_file            (const char           *file_name,
+                                         size_t                size,
+                                         void                 *address);
+pages_error_t pages_unmap_file          (void                 *address,
+                                         size_t                size);
+//asks system to back mapping with transparent huge pages, it is only advice
+pages_error_t pages_advise_huge         (void                 *address,
+                                         size_t                size);
+pages_error_t pages_add_fault_handler   (pages_fault_handler_t handler,
+                                         void                 *context);
+pages_error_t pages_remove_fault_handler(pages_fault_handler_t handler,
+                                         void                 *context);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdio.h>
+
+#include "stack.h"
+
+#define QUEUE_CANARY_PROTECTION
+
+enum queue_error_t {
+    QUEUE_SUCCESS                      = 0 ,
+    QUEUE_MEMORY_ERROR                 = 1 ,
+    QUEUE_DUMP_ERROR                   = 2 ,
+    QUEUE_NULL                         = 3 ,
+    QUEUE_EMPTY                        = 4 ,
+    QUEUE_FULL                         = 5 ,
+    QUEUE_INVALID_CAPACITY             = 6 ,
+    QUEUE_INVALID_INPUT                = 7 ,
+    QUEUE_INVALID_OUTPUT               = 8 ,
+    QUEUE_UNEXPECTED_LEFT_CANARY       = 9 ,
+    QUEUE_UNEXPECTED_RIGHT_CANARY      = 10,
+    QUEUE_UNEXPECTED_DATA_LEFT_CANARY  = 11,
+    QUEUE_UNEXPECTED_DATA_RIGHT_CANARY = 12,
+};
+
+//single producer single consumer queue can be used only by one enqueuing
+//and one dequeuing thread, multiple producer multiple consumer queue can be
+//shared by any number of threads
+enum queue_kind_t {
+    QUEUE_SPSC,
+    QUEUE_MPMC,
+};
+
+//bounded lock-free ring queue, capacity must be power of two.
+//queue is never reallocated, enqueue to full queue returns QUEUE_FULL.
+struct queue_t;
+
+#ifdef STACK_WRITE_DUMP
+    #define QUEUE_DUMP(__queue_pointer, __error)\
+        queue_dump(__queue_pointer,             \
+                   __FILE_NAME__,               \
+                   __PRETTY_FUNCTION__,         \
+                   __LINE__,                    \
+                   __error)
+
+    queue_error_t queue_dump(queue_t      *queue,
+                             const char   *file_name,
+                             const char   *function_name,
+                             size_t        line,
+                             queue_error_t call_reason);
+#endif
+
+queue_t *     queue_init   (STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                                const char *initialized_file,
+                                                const char *initialized_varname,
+                                                const char *initialized_function,
+                                                size_t      initialized_line,
+                                                int       (*print_func)(FILE *, void *),)
+                            queue_kind_t kind,
+                            size_t       capacity,
+                            size_t       element_size);
+
+queue_error_t queue_enqueue(queue_t    *queue,
+                            const void *element);
+queue_error_t queue_dequeue(queue_t    *queue,
+                            void       *output);
+
+//batch functions move up to count elements with one update of shared index
+//and return number of moved elements
+size_t        queue_enqueue_batch(queue_t    *queue,
+                                  const void *elements,
+                                  size_t      count);
+size_t        queue_dequeue_batch(queue_t    *queue,
+                                  void       *output,
+                                  size_t      count);
+
+size_t        queue_size   (queue_t  *queue);
+queue_error_t queue_destroy(queue_t **queue);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SAMPLE_TIMER_H
+#define SAMPLE_TIMER_H
+
+#include <stdio.h>
+
+enum sample_timer_error_t {
+    SAMPLE_TIMER_SUCCESS       = 0,
+    SAMPLE_TIMER_STARTED_ERROR = 1,
+    SAMPLE_TIMER_START_ERROR   = 2,
+};
+
+//callback is called with frequency in Hz while thread which started timer
+//uses processor. it interrupts this thread (SIGPROF handler on POSIX, the
+//thread is suspended by timer thread on Windows), so callback must not
+//allocate memory, lock or call non async-signal-safe functions.
+//SIGPROF is sent to process, so background threads of memory trace and dump
+//writer block it and it is handled by the thread which runs program.
+//only one timer can be started at a time
+typedef void (*sample_timer_callback_t)(void *context);
+
+sample_timer_error_t sample_timer_start(size_t                  frequency,
+                                        sample_timer_callback_t callback,
+                                        void                   *context);
+void                 sample_timer_stop (void);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SEGMENTED_STACK_H
+#define SEGMENTED_STACK_H
+
+#include <stdio.h>
+
+#include "stack.h"
+
+//segmented stack stores elements in linked fixed-size chunks, so it is never
+//reallocated and pointer to it stays valid until segmented_stack_destroy(...).
+//init returns NULL if size of chunk with its elements does not fit in size_t.
+struct segmented_stack_t;
+
+#ifdef STACK_WRITE_DUMP
+    #define SEGMENTED_STACK_DUMP(__stack_pointer, __error)\
+        segmented_stack_dump(__stack_pointer,             \
+                             __FILE_NAME__,               \
+                             __PRETTY_FUNCTION__,         \
+                             __LINE__,                    \
+                             __error)
+
+    stack_error_t segmented_stack_dump(segmented_stack_t *stack,
+                                       const char        *file_name,
+                                       const char        *function_name,
+                                       size_t             line,
+                                       stack_error_t      call_reason);
+#endif
+
+segmented_stack_t *segmented_stack_init   (STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                                               const char *initialized_file,
+                                                               const char *initialized_varname,
+                                                               const char *initialized_function,
+                                                               size_t      initialized_line,
+                                                               int       (*print_func)(FILE *, void *),)
+                                           size_t chunk_capacity,
+                                           size_t element_size);
+
+stack_error_t      segmented_stack_push   (segmented_stack_t  *stack,
+                                           const void         *element);
+stack_error_t      segmented_stack_pop    (segmented_stack_t  *stack,
+                                           void               *output);
+size_t             segmented_stack_size   (segmented_stack_t  *stack);
+stack_error_t      segmented_stack_destroy(segmented_stack_t **stack);
+
+#endif
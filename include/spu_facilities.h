@@ -32,7 +32,7 @@ enum command_t : uint8_t {
     CMD_RET     = 0x16,
     CMD_DRAW    = 0x17,
     CMD_CHAI    = 0x18,
-//CHANGE PROCESSOR_FIRST_COMMAND AND PROCESSOR_LAST_COMMAND WHEN CHANGING THIS ENUM!!!
+//CHANGE PROCESSOR_FIRST_COMMAND, PROCESSOR_LAST_COMMAND AND SPU_COMMAND_NAMES WHEN CHANGING THIS ENUM!!!
 };
 
 #pragma GCC diagnostic push
@@ -40,6 +40,12 @@ enum command_t : uint8_t {
 
 static const command_t  processor_first_command   = CMD_PUSH;
 static const command_t  processor_last_command    = CMD_CHAI;
+//names of commands in assembler, indexed by operation code
+static const char      *spu_command_names[]       = {"unknown", "push", "add" , "sub" , "mul" ,
+                                                     "div"    , "out" , "in"  , "sqrt", "sin" ,
+                                                     "cos"    , "dump", "hlt" , "jmp" , "ja"  ,
+                                                     "jb"     , "jae" , "jbe" , "je"  , "jne" ,
+                                                     "pop"    , "call", "ret" , "draw", "chai"};
 //when changing register names array, it is necessary to change formats in compiler.
 static const char      *spu_register_names[]      = {"ax", "bx", "cx", "sp",
                                                      "bp", "di", "si", "dx"};
@@ -52,17 +58,76 @@ static const command_t  argument_type_mask        = (command_t)0xe0;
 static const address_t  spu_drawing_width         = 96;
 static const address_t  spu_drawing_height        = 36;
 static const char      *assembler_name            = "CHTO ZA MASHINA ETOT PROCESSOR";
-static const uint64_t   assembler_version         = 228;
+static const uint64_t   assembler_version         = 232;
 static const size_t     assembler_name_size       = 64;
-static const size_t     random_access_memory_size = 16384;
+static const size_t     default_ram_size          = 16384;
 static const size_t     max_register_name_length  = 3;
+static const size_t     symbol_name_size          = 32;
+static const char      *branch_profile_signature  = "spu-branch-profile";
+static const uint64_t   branch_profile_version    = 1;
+static const size_t     branch_trip_buckets       = 16;
+static const char      *coverage_signature        = "spu-coverage";
+static const uint64_t   coverage_version          = 2;
+static const size_t     coverage_signature_size   = 16;
 
 #pragma GCC diagnostic pop
 
+//returns name of command by command byte, argument type bits are ignored
+inline const char *spu_command_name(command_t command) {
+    command_t operation_code = (command_t)(command & operation_code_mask);
+    if(operation_code > processor_last_command)
+        return spu_command_names[CMD_UNKNOWN];
+
+    return spu_command_names[operation_code];
+}
+
+//ram_size is number of RAM cells which program needs, 0 means default_ram_size,
+//stack_size is capacity of value stack and call stack, 0 means default of SPU,
+//data_size is size of RAM initializer in bytes, it is written right after code,
+//symbols_number is number of program_symbol_t after RAM initializer ('asm -g')
 struct program_header_t {
     char     assembler_name[assembler_name_size];
     uint64_t assembler_version;
     size_t   code_size;
+    uint64_t ram_size;
+    uint64_t stack_size;
+    uint64_t data_size;
+    uint64_t symbols_number;
+};
+
+//label of program, name is written without ':'
+struct program_symbol_t {
+    uint64_t address;
+    char     name[symbol_name_size];
+};
+
+//branch profile is text file which is written by 'run --branch-profile' and
+//read by 'asm --branch-profile'. the first line is signature, version, code
+//size and number of trip buckets, then every conditional jump which was run
+//is line 'offset command target taken not_taken bucket_0 ... bucket_15'.
+//offsets are hex, bucket k counts exits from loop of backward jump after
+//2^k..2^(k+1)-1 iterations, the last bucket counts all longer loops
+
+//coverage file is written by 'run --coverage' and read by 'asm --coverage'.
+//header is followed by (code_size + 7) / 8 bytes of bitmap, bit (offset % 8)
+//of byte (offset / 8) is set if command on this offset was run at least once
+//in any of runs runs. code_hash is bytes_hash(...) of code, new runs of code
+//with the same size and hash are merged to existing file
+struct coverage_header_t {
+    char     signature[coverage_signature_size];
+    uint64_t version;
+    uint64_t code_size;
+    uint64_t code_hash;
+    uint64_t runs;
+};
+
+//RAM initializer consists of segments, every segment is ram_segment_t followed
+//by values_number values, which are copied to cells_number cells from address.
+//values_number is equal to cells_number, or it is 1 and this value fills all cells
+struct ram_segment_t {
+    uint64_t address;
+    uint64_t cells_number;
+    uint64_t values_number;
 };
 
 #endif
@@ -6,6 +6,8 @@
 #define STACK_HASH_PROTECTION
 #define STACK_CANARY_PROTECTION
 #define STACK_WRITE_DUMP
+// #define STACK_BINARY_DUMP
+// #define STACK_GUARD_PAGE_PROTECTION
 
 enum stack_error_t {
     STACK_SUCCESS                      = 0 ,
@@ -26,10 +28,34 @@ enum stack_error_t {
     STACK_UNEXPECTED_DATA_RIGHT_CANARY = 15,
     STACK_UNEXPECTED_STRUCTURE_HASH    = 16,
     STACK_UNEXPECTED_DATA_HASH         = 17,
+    STACK_OVERFLOW                     = 18,
+    STACK_INVALID_POLICY               = 19,
 };
 
 struct stack_t;
 
+//capacity policy: stack grows by growth_factor when it is full and
+//shrinks by shrink_factor only when size * shrink_threshold <= capacity,
+//so every reallocation is separated by at least capacity / 2 operations.
+//capacity is never shrunk below min_capacity. pinned stack is never
+//reallocated automatically, push to full pinned stack returns STACK_OVERFLOW.
+struct stack_policy_t {
+    size_t growth_factor;
+    size_t shrink_threshold;
+    size_t shrink_factor;
+    size_t min_capacity;
+    bool   is_pinned;
+};
+
+//min_capacity = 0 in default policy is replaced with initial capacity
+static const stack_policy_t stack_default_policy = {
+    .growth_factor    = 2    ,
+    .shrink_threshold = 4    ,
+    .shrink_factor    = 2    ,
+    .min_capacity     = 0    ,
+    .is_pinned        = false,
+};
+
 #ifdef STACK_WRITE_DUMP
     #define STACK_WRITE_DUMP_ON(...) __VA_ARGS__
     #define DUMP_INIT(__dump_filename, __var, __print)\
@@ -52,6 +78,8 @@ struct stack_t;
                              const char   *function_name,
                              size_t        line,
                              stack_error_t call_reason);
+
+    const char *  stack_error_text(stack_error_t error);
 #else
     #define STACK_WRITE_DUMP_ON(...)
     #define DUMP_INIT(...)
@@ -66,8 +94,40 @@ stack_t *stack_init        (STACK_WRITE_DUMP_ON(const char *dump_filename,
                             size_t capacity,
                             size_t element_size);
 
+//storage must be aligned as alignof(max_align_t), stack takes the biggest
+//capacity that fits storage_size bytes and never reallocates
+stack_t *stack_init_in_place(STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                                 const char *initialized_file,
+                                                 const char *initialized_varname,
+                                                 const char *initialized_function,
+                                                 size_t      initialized_line,
+                                                 int       (*print_func)(FILE *, void *),)
+                             void * storage,
+                             size_t storage_size,
+                             size_t element_size);
+
+size_t   stack_storage_size (size_t capacity,
+                             size_t element_size);
+
 stack_error_t stack_push   (stack_t **stack, void *element);
 stack_error_t stack_pop    (stack_t **stack, void *output);
 stack_error_t stack_destroy(stack_t **stack);
+size_t        stack_get_size(const stack_t *stack);
+
+//peak_size is the biggest size since stack was initialized, reallocations
+//counts changes of capacity after initialization
+struct stack_stats_t {
+    size_t peak_size;
+    size_t reallocations;
+};
+
+stack_error_t stack_get_stats(const stack_t       *stack,
+                              stack_stats_t       *stats);
+
+stack_error_t stack_reserve      (stack_t             **stack,
+                                  size_t                capacity);
+stack_error_t stack_shrink_to_fit(stack_t             **stack);
+stack_error_t stack_set_policy   (stack_t             **stack,
+                                  const stack_policy_t *policy);
 
 #endif
@@ -0,0 +1,58 @@
+#ifndef STACK_DUMP_H
+#define STACK_DUMP_H
+
+#include <stdint.h>
+
+//binary stack dump record, it is written by stack_dump(...) in
+//STACK_BINARY_DUMP mode and rendered to text by dump_viewer.
+//record is followed by initialized_file, initialized_varname,
+//initialized_function, file_name and function_name strings without
+//terminating zeros and then by capacity * element_size bytes of stack data
+//if STACK_DUMP_HAS_DATA flag is set.
+static const uint32_t stack_dump_signature = 0x504D5544; //"DUMP"
+
+enum stack_dump_flags_t {
+    STACK_DUMP_HAS_CANARIES = 1 << 0,
+    STACK_DUMP_HAS_HASHES   = 1 << 1,
+    STACK_DUMP_HAS_DATA     = 1 << 2,
+};
+
+struct stack_dump_record_t {
+    uint32_t signature;
+    uint32_t flags;
+    uint64_t record_size;
+
+    uint64_t stack_address;
+    uint64_t data_address;
+    int64_t  call_reason;
+    uint64_t initialized_line;
+    uint64_t line;
+
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t element_size;
+
+    uint64_t growth_factor;
+    uint64_t shrink_threshold;
+    uint64_t shrink_factor;
+    uint64_t min_capacity;
+    uint64_t is_pinned;
+
+    uint64_t structure_left_canary;
+    uint64_t data_left_canary_address;
+    uint64_t data_left_canary;
+    uint64_t data_right_canary_address;
+    uint64_t data_right_canary;
+    uint64_t structure_right_canary;
+
+    uint64_t structure_hash;
+    uint64_t data_hash;
+
+    uint64_t initialized_file_length;
+    uint64_t initialized_varname_length;
+    uint64_t initialized_function_length;
+    uint64_t file_name_length;
+    uint64_t function_name_length;
+};
+
+#endif
@@ -2,8 +2,11 @@
 #define UTILS_H
 
 #include <stdio.h>
+#include <stdint.h>
 
-size_t file_size         (FILE *file);
-int    file_print_double (FILE *output, void *item);
+size_t   file_size         (FILE *file);
+int      file_print_double (FILE *output, void *item);
+//djb2 hash of bytes, it is written to files which are matched to code
+uint64_t bytes_hash        (const void *bytes, size_t size);
 
 #endif
@@ -0,0 +1,76 @@
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "memory.h"
+#include "memory_trace.h"
+
+enum report_error_t {
+    REPORT_SUCCESS       = 0,
+    REPORT_FLAGS_ERROR   = 1,
+    REPORT_OPENING_ERROR = 2,
+    REPORT_READING_ERROR = 3,
+    REPORT_MEMORY_ERROR  = 4,
+    REPORT_WRITING_ERROR = 5,
+    REPORT_INVALID_TRACE = 6,
+};
+
+//block which is allocated at current point of trace, zero address means
+//empty slot of hash table
+struct live_block_t {
+    uint64_t address;
+    uint64_t size;
+    uint64_t call_site;
+    uint64_t tag;
+};
+
+struct call_site_t {
+    uint64_t address;
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t bytes;
+    uint64_t leaked_blocks;
+    uint64_t leaked_bytes;
+};
+
+//records are sorted by timestamp, index keeps order of records with the
+//same timestamp
+struct record_order_t {
+    uint64_t timestamp;
+    uint64_t index;
+};
+
+struct report_t {
+    const char *           input_filename;
+    const char *           output_filename;
+    FILE *                 input;
+    FILE *                 output;
+    size_t                 top_number;
+
+    memory_trace_record_t *records;
+    size_t                 records_number;
+    record_order_t *       order;
+
+    live_block_t *         blocks;
+    size_t                 blocks_capacity;
+    size_t                 blocks_number;
+
+    call_site_t *          sites;
+    size_t                 sites_capacity;
+    size_t                 sites_number;
+
+    uint64_t               threads;
+    uint64_t               allocations;
+    uint64_t               reallocations;
+    uint64_t               frees;
+    uint64_t               unknown_frees;
+    uint64_t               live_bytes;
+    uint64_t               peak_bytes;
+    uint64_t               peak_timestamp;
+    uint64_t               tag_live_bytes[MEMORY_TAGS_NUMBER];
+    uint64_t               tag_peak_bytes[MEMORY_TAGS_NUMBER];
+};
+
+#endif
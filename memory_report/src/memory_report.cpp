@@ -0,0 +1,714 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "memory_trace.h"
+#include "memory_report.h"
+
+static const size_t   default_top_number = 10;
+static const size_t   min_table_capacity = 1024;
+static const uint64_t hash_multiplier    = 0x9E3779B97F4A7C15;
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static report_error_t parse_flags     (report_t                    *report,
+                                       int                          argc,
+                                       const char                  *argv[]);
+static report_error_t open_files      (report_t                    *report);
+static report_error_t read_trace      (report_t                    *report);
+static report_error_t replay_trace    (report_t                    *report);
+static report_error_t apply_record    (report_t                    *report,
+                                       const memory_trace_record_t *record);
+static report_error_t add_block       (report_t                    *report,
+                                       const memory_trace_record_t *record);
+static size_t         find_block      (report_t                    *report,
+                                       uint64_t                     address);
+static void           remove_block    (report_t                    *report,
+                                       size_t                       index);
+static report_error_t grow_blocks     (report_t                    *report);
+static call_site_t *  get_site        (report_t                    *report,
+                                       uint64_t                     address);
+static report_error_t grow_sites      (report_t                    *report);
+static uint64_t       hash_address    (uint64_t                     address);
+static report_error_t write_report    (report_t                    *report);
+static report_error_t write_leaks     (report_t                    *report);
+static report_error_t write_hot_spots (report_t                    *report);
+static int            compare_order   (const void                  *first,
+                                       const void                  *second);
+static int            compare_leaks   (const void                  *first,
+                                       const void                  *second);
+static int            compare_sites   (const void                  *first,
+                                       const void                  *second);
+static report_error_t destroy_report  (report_t                    *report);
+
+/**
+======================================================================================================
+    @brief      Runs memory report.
+
+    @details    Reads binary allocation trace written by memory subsystem in
+                debug builds and reports leaks, peak memory usage and call
+                sites which allocate most often.
+
+    @param [in] argc                Number of arguments typed in by user.
+    @param [in] argv                Arguments from console.
+
+    @return Exit code.
+
+======================================================================================================
+*/
+int main(int argc, const char *argv[]) {
+    _memory_disable_log();
+
+    report_t report = {};
+    if(parse_flags (&report, argc, argv) != REPORT_SUCCESS ||
+       open_files  (&report)             != REPORT_SUCCESS ||
+       read_trace  (&report)             != REPORT_SUCCESS ||
+       replay_trace(&report)             != REPORT_SUCCESS ||
+       write_report(&report)             != REPORT_SUCCESS) {
+        destroy_report(&report);
+        return EXIT_FAILURE;
+    }
+
+    destroy_report(&report);
+    return EXIT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Parses flags from console.
+
+    @details    memory_report 'trace' [-o 'output'] [-n 'number']
+                Report is written to stdout if output is not set.
+                Number sets how many leaks and call sites are listed.
+
+======================================================================================================
+*/
+report_error_t parse_flags(report_t   *report,
+                           int         argc,
+                           const char *argv[]) {
+    C_ASSERT(report != NULL, return REPORT_FLAGS_ERROR);
+    C_ASSERT(argv   != NULL, return REPORT_FLAGS_ERROR);
+
+    report->top_number = default_top_number;
+
+    for(int arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+            report->output_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            arg++;
+            char *end = NULL;
+            report->top_number = strtoull(argv[arg], &end, 10);
+            if(*end != '\0') {
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "Invalid number '%s'.\r\n",
+                             argv[arg]);
+                return REPORT_FLAGS_ERROR;
+            }
+        }
+        else if(report->input_filename == NULL && argv[arg][0] != '-') {
+            report->input_filename = argv[arg];
+        }
+        else {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Unexpected flag '%s'.\r\n",
+                         argv[arg]);
+            return REPORT_FLAGS_ERROR;
+        }
+    }
+
+    if(report->input_filename == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Usage: memory_report 'trace' [-o 'output'] [-n 'number']\r\n");
+        return REPORT_FLAGS_ERROR;
+    }
+
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Opens binary trace and output text file.
+
+======================================================================================================
+*/
+report_error_t open_files(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_OPENING_ERROR);
+
+    report->input = fopen(report->input_filename, "rb");
+    if(report->input == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening file '%s'.\r\n",
+                     report->input_filename);
+        return REPORT_OPENING_ERROR;
+    }
+
+    if(report->output_filename == NULL) {
+        report->output = stdout;
+        return REPORT_SUCCESS;
+    }
+
+    report->output = fopen(report->output_filename, "wb");
+    if(report->output == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening file '%s'.\r\n",
+                     report->output_filename);
+        return REPORT_OPENING_ERROR;
+    }
+
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Reads all trace records and orders them by timestamp.
+
+    @details    Records of different threads are written in the order in
+                which background thread drains rings of threads, so they are
+                sorted. Records of one thread keep their order. Load bias
+                from header is subtracted from call sites.
+
+======================================================================================================
+*/
+report_error_t read_trace(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_READING_ERROR);
+
+    memory_trace_header_t header = {};
+    if(fread(&header, sizeof(header), 1, report->input) != 1 ||
+       header.signature   != memory_trace_signature            ||
+       header.version     != memory_trace_version              ||
+       header.record_size != sizeof(memory_trace_record_t)) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "File '%s' is not a memory trace.\r\n",
+                     report->input_filename);
+        return REPORT_INVALID_TRACE;
+    }
+
+    size_t capacity = min_table_capacity;
+    report->records = (memory_trace_record_t *)_calloc(capacity, sizeof(memory_trace_record_t));
+    if(report->records == NULL)
+        return REPORT_MEMORY_ERROR;
+
+    while(true) {
+        if(report->records_number == capacity) {
+            memory_trace_record_t *records = (memory_trace_record_t *)_recalloc(report->records,
+                                                                               capacity,
+                                                                               capacity * 2,
+                                                                               sizeof(memory_trace_record_t));
+            if(records == NULL)
+                return REPORT_MEMORY_ERROR;
+
+            report->records = records;
+            capacity       *= 2;
+        }
+
+        size_t read = fread(report->records + report->records_number,
+                            sizeof(memory_trace_record_t),
+                            capacity - report->records_number,
+                            report->input);
+        report->records_number += read;
+        if(report->records_number != capacity)
+            break;
+    }
+
+    if(ferror(report->input)) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while reading file '%s'.\r\n",
+                     report->input_filename);
+        return REPORT_READING_ERROR;
+    }
+
+    report->order = (record_order_t *)_calloc(report->records_number + 1, sizeof(record_order_t));
+    if(report->order == NULL)
+        return REPORT_MEMORY_ERROR;
+
+    for(size_t index = 0; index < report->records_number; index++) {
+        report->records[index].call_site -= header.load_bias;
+        report->order[index].timestamp = report->records[index].timestamp;
+        report->order[index].index     = index;
+
+        if(report->records[index].thread >= report->threads)
+            report->threads = report->records[index].thread + 1;
+    }
+
+    qsort(report->order, report->records_number, sizeof(record_order_t), compare_order);
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Applies records in time order and counts leaked blocks of
+                call sites.
+
+======================================================================================================
+*/
+report_error_t replay_trace(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_MEMORY_ERROR);
+
+    report->blocks_capacity = min_table_capacity;
+    report->blocks          = (live_block_t *)_calloc(report->blocks_capacity, sizeof(live_block_t));
+    report->sites_capacity  = min_table_capacity;
+    report->sites           = (call_site_t  *)_calloc(report->sites_capacity,  sizeof(call_site_t ));
+    if(report->blocks == NULL || report->sites == NULL)
+        return REPORT_MEMORY_ERROR;
+
+    report_error_t error_code = REPORT_SUCCESS;
+    for(size_t index = 0; index < report->records_number; index++)
+        if((error_code = apply_record(report, &report->records[report->order[index].index])) != REPORT_SUCCESS)
+            return error_code;
+
+    for(size_t index = 0; index < report->blocks_capacity; index++) {
+        live_block_t *block = &report->blocks[index];
+        if(block->address == 0)
+            continue;
+
+        call_site_t *site = get_site(report, block->call_site);
+        if(site == NULL)
+            return REPORT_MEMORY_ERROR;
+
+        site->leaked_blocks++;
+        site->leaked_bytes += block->size;
+    }
+
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Updates live blocks, usage and call site counters with one record.
+
+    @details    Failed allocations have zero memory and change nothing.
+                Reallocated block is counted as allocated by call site of
+                reallocation.
+
+======================================================================================================
+*/
+report_error_t apply_record(report_t                    *report,
+                            const memory_trace_record_t *record) {
+    C_ASSERT(report != NULL, return REPORT_MEMORY_ERROR);
+    C_ASSERT(record != NULL, return REPORT_MEMORY_ERROR);
+
+    if(record->tag >= MEMORY_TAGS_NUMBER)
+        return REPORT_INVALID_TRACE;
+
+    uint64_t grown_bytes = 0;
+    if(record->old_memory != 0) {
+        size_t index = find_block(report, record->old_memory);
+        if(report->blocks[index].address == 0) {
+            if(record->operation == MEMORY_TRACE_FREE)
+                report->unknown_frees++;
+        }
+        else {
+            if(record->size > report->blocks[index].size)
+                grown_bytes = record->size - report->blocks[index].size;
+
+            report->live_bytes                                 -= report->blocks[index].size;
+            report->tag_live_bytes[report->blocks[index].tag] -= report->blocks[index].size;
+            remove_block(report, index);
+        }
+    }
+
+    switch(record->operation) {
+        case MEMORY_TRACE_ALLOCATION:   {
+            report->allocations++;
+            break;
+        }
+        case MEMORY_TRACE_REALLOCATION: {
+            report->reallocations++;
+            break;
+        }
+        case MEMORY_TRACE_FREE:         {
+            report->frees++;
+            return REPORT_SUCCESS;
+        }
+        default:                        {
+            return REPORT_INVALID_TRACE;
+        }
+    }
+
+    if(record->memory == 0)
+        return REPORT_SUCCESS;
+
+    call_site_t *site = get_site(report, record->call_site);
+    if(site == NULL)
+        return REPORT_MEMORY_ERROR;
+
+    if(record->operation == MEMORY_TRACE_ALLOCATION) {
+        site->allocations++;
+        site->bytes += record->size;
+    }
+    else {
+        site->reallocations++;
+        site->bytes += grown_bytes;
+    }
+
+    report_error_t error_code = add_block(report, record);
+    if(error_code != REPORT_SUCCESS)
+        return error_code;
+
+    report->live_bytes                  += record->size;
+    report->tag_live_bytes[record->tag] += record->size;
+
+    if(report->live_bytes > report->peak_bytes) {
+        report->peak_bytes     = report->live_bytes;
+        report->peak_timestamp = record->timestamp;
+    }
+    if(report->tag_live_bytes[record->tag] > report->tag_peak_bytes[record->tag])
+        report->tag_peak_bytes[record->tag] = report->tag_live_bytes[record->tag];
+
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Puts block to live blocks table, table is kept at most half full.
+
+======================================================================================================
+*/
+report_error_t add_block(report_t                    *report,
+                         const memory_trace_record_t *record) {
+    C_ASSERT(report != NULL, return REPORT_MEMORY_ERROR);
+    C_ASSERT(record != NULL, return REPORT_MEMORY_ERROR);
+
+    if((report->blocks_number + 1) * 2 > report->blocks_capacity) {
+        report_error_t error_code = grow_blocks(report);
+        if(error_code != REPORT_SUCCESS)
+            return error_code;
+    }
+
+    size_t index = find_block(report, record->memory);
+    if(report->blocks[index].address == 0)
+        report->blocks_number++;
+    else {
+        report->live_bytes                                 -= report->blocks[index].size;
+        report->tag_live_bytes[report->blocks[index].tag] -= report->blocks[index].size;
+    }
+
+    report->blocks[index].address   = record->memory;
+    report->blocks[index].size      = record->size;
+    report->blocks[index].call_site = record->call_site;
+    report->blocks[index].tag       = record->tag;
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Returns index of block with address or index of empty slot
+                where it must be placed.
+
+======================================================================================================
+*/
+size_t find_block(report_t *report,
+                  uint64_t  address) {
+    size_t mask  = report->blocks_capacity - 1;
+    size_t index = hash_address(address) & mask;
+
+    while(report->blocks[index].address != 0 &&
+          report->blocks[index].address != address)
+        index = (index + 1) & mask;
+
+    return index;
+}
+
+/**
+======================================================================================================
+    @brief      Removes block and shifts next blocks of the same probe
+                sequence back, so that table does not need deleted marks.
+
+======================================================================================================
+*/
+void remove_block(report_t *report,
+                  size_t    index) {
+    size_t mask = report->blocks_capacity - 1;
+    size_t hole = index;
+
+    for(size_t next = (hole + 1) & mask;
+        report->blocks[next].address != 0;
+        next = (next + 1) & mask) {
+        size_t home = hash_address(report->blocks[next].address) & mask;
+        if(((next - home) & mask) >= ((next - hole) & mask)) {
+            report->blocks[hole] = report->blocks[next];
+            hole                 = next;
+        }
+    }
+
+    memset(&report->blocks[hole], 0, sizeof(live_block_t));
+    report->blocks_number--;
+}
+
+report_error_t grow_blocks(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_MEMORY_ERROR);
+
+    live_block_t *old_blocks   = report->blocks;
+    size_t        old_capacity = report->blocks_capacity;
+
+    report->blocks = (live_block_t *)_calloc(old_capacity * 2, sizeof(live_block_t));
+    if(report->blocks == NULL) {
+        report->blocks = old_blocks;
+        return REPORT_MEMORY_ERROR;
+    }
+
+    report->blocks_capacity = old_capacity * 2;
+    for(size_t index = 0; index < old_capacity; index++)
+        if(old_blocks[index].address != 0)
+            report->blocks[find_block(report, old_blocks[index].address)] = old_blocks[index];
+
+    _free(old_blocks);
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Returns counters of call site, creates them on the first call.
+
+======================================================================================================
+*/
+call_site_t *get_site(report_t *report,
+                      uint64_t  address) {
+    C_ASSERT(report != NULL, return NULL);
+
+    if((report->sites_number + 1) * 2 > report->sites_capacity &&
+       grow_sites(report) != REPORT_SUCCESS)
+        return NULL;
+
+    size_t mask  = report->sites_capacity - 1;
+    size_t index = hash_address(address) & mask;
+
+    while(report->sites[index].allocations + report->sites[index].reallocations != 0 &&
+          report->sites[index].address != address)
+        index = (index + 1) & mask;
+
+    call_site_t *site = &report->sites[index];
+    if(site->allocations + site->reallocations == 0 && site->address != address) {
+        memset(site, 0, sizeof(call_site_t));
+        site->address = address;
+        report->sites_number++;
+    }
+
+    return site;
+}
+
+report_error_t grow_sites(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_MEMORY_ERROR);
+
+    call_site_t *old_sites    = report->sites;
+    size_t       old_capacity = report->sites_capacity;
+
+    report->sites = (call_site_t *)_calloc(old_capacity * 2, sizeof(call_site_t));
+    if(report->sites == NULL) {
+        report->sites = old_sites;
+        return REPORT_MEMORY_ERROR;
+    }
+
+    report->sites_capacity = old_capacity * 2;
+    report->sites_number   = 0;
+    for(size_t index = 0; index < old_capacity; index++) {
+        if(old_sites[index].allocations + old_sites[index].reallocations == 0)
+            continue;
+
+        call_site_t *site = get_site(report, old_sites[index].address);
+        *site             = old_sites[index];
+    }
+
+    _free(old_sites);
+    return REPORT_SUCCESS;
+}
+
+uint64_t hash_address(uint64_t address) {
+    uint64_t hash = address * hash_multiplier;
+    return hash ^ (hash >> 32);
+}
+
+/**
+======================================================================================================
+    @brief      Writes totals, usage by tags, leaks and hot spots.
+
+    @details    Call sites are return addresses in traced program moved to
+                addresses it is linked for, so they can be turned into source
+                lines with addr2line even if program was loaded at random address.
+
+======================================================================================================
+*/
+report_error_t write_report(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_WRITING_ERROR);
+
+    uint64_t start    = report->records_number == 0 ? 0 : report->order[0].timestamp;
+    uint64_t finish   = report->records_number == 0 ? 0 : report->order[report->records_number - 1].timestamp;
+    uint64_t leaked   = 0;
+    for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++)
+        leaked += report->tag_live_bytes[tag];
+
+    if(fprintf(report->output,
+               "Memory trace '%s'\r\n"
+               "Records:        %llu from %llu threads in %.3f ms\r\n"
+               "Allocations:    %llu\r\n"
+               "Reallocations:  %llu\r\n"
+               "Frees:          %llu (%llu of unknown blocks)\r\n"
+               "Peak usage:     %llu bytes at %.3f ms\r\n"
+               "Leaked:         %llu bytes in %llu blocks\r\n\r\n"
+               "%-10s %16s %16s\r\n",
+               report->input_filename,
+               (unsigned long long)report->records_number,
+               (unsigned long long)report->threads,
+               (double)(finish - start) / 1e6,
+               (unsigned long long)report->allocations,
+               (unsigned long long)report->reallocations,
+               (unsigned long long)report->frees,
+               (unsigned long long)report->unknown_frees,
+               (unsigned long long)report->peak_bytes,
+               (double)(report->peak_timestamp - start) / 1e6,
+               (unsigned long long)leaked,
+               (unsigned long long)report->blocks_number,
+               "tag", "peak bytes", "leaked bytes") < 0)
+        return REPORT_WRITING_ERROR;
+
+    for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++)
+        if(fprintf(report->output,
+                   "%-10s %16llu %16llu\r\n",
+                   memory_tag_name((memory_tag_t)tag),
+                   (unsigned long long)report->tag_peak_bytes[tag],
+                   (unsigned long long)report->tag_live_bytes[tag]) < 0)
+            return REPORT_WRITING_ERROR;
+
+    report_error_t error_code = REPORT_SUCCESS;
+    if((error_code = write_leaks    (report)) != REPORT_SUCCESS ||
+       (error_code = write_hot_spots(report)) != REPORT_SUCCESS)
+        return error_code;
+
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Writes the biggest leaked blocks.
+
+    @details    Blocks are moved to the beginning of table, so table can not
+                be used for searching after it.
+
+======================================================================================================
+*/
+report_error_t write_leaks(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_WRITING_ERROR);
+
+    size_t leaks_number = 0;
+    for(size_t index = 0; index < report->blocks_capacity; index++)
+        if(report->blocks[index].address != 0)
+            report->blocks[leaks_number++] = report->blocks[index];
+
+    qsort(report->blocks, leaks_number, sizeof(live_block_t), compare_leaks);
+
+    if(fprintf(report->output,
+               "\r\nLeaked blocks:\r\n"
+               "%-18s %16s %-10s %-18s\r\n",
+               "block", "bytes", "tag", "call site") < 0)
+        return REPORT_WRITING_ERROR;
+
+    for(size_t index = 0; index < leaks_number && index < report->top_number; index++)
+        if(fprintf(report->output,
+                   "0x%016llx %16llu %-10s 0x%016llx\r\n",
+                   (unsigned long long)report->blocks[index].address,
+                   (unsigned long long)report->blocks[index].size,
+                   memory_tag_name((memory_tag_t)report->blocks[index].tag),
+                   (unsigned long long)report->blocks[index].call_site) < 0)
+            return REPORT_WRITING_ERROR;
+
+    return REPORT_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Writes call sites which allocate and reallocate most often.
+
+    @details    Call sites are sorted in place, so table can not be used for
+                searching after it.
+
+======================================================================================================
+*/
+report_error_t write_hot_spots(report_t *report) {
+    C_ASSERT(report != NULL, return REPORT_WRITING_ERROR);
+
+    qsort(report->sites, report->sites_capacity, sizeof(call_site_t), compare_sites);
+
+    if(fprintf(report->output,
+               "\r\nHot spots:\r\n"
+               "%-18s %12s %14s %16s %16s\r\n",
+               "call site", "allocations", "reallocations", "bytes", "leaked bytes") < 0)
+        return REPORT_WRITING_ERROR;
+
+    for(size_t index = 0; index < report->sites_number && index < report->top_number; index++)
+        if(fprintf(report->output,
+                   "0x%016llx %12llu %14llu %16llu %16llu\r\n",
+                   (unsigned long long)report->sites[index].address,
+                   (unsigned long long)report->sites[index].allocations,
+                   (unsigned long long)report->sites[index].reallocations,
+                   (unsigned long long)report->sites[index].bytes,
+                   (unsigned long long)report->sites[index].leaked_bytes) < 0)
+            return REPORT_WRITING_ERROR;
+
+    return REPORT_SUCCESS;
+}
+
+int compare_order(const void *first,
+                  const void *second) {
+    const record_order_t *first_order  = (const record_order_t *)first;
+    const record_order_t *second_order = (const record_order_t *)second;
+
+    if(first_order->timestamp != second_order->timestamp)
+        return first_order->timestamp < second_order->timestamp ? -1 : 1;
+
+    return first_order->index < second_order->index ? -1 : 1;
+}
+
+int compare_leaks(const void *first,
+                  const void *second) {
+    const live_block_t *first_block  = (const live_block_t *)first;
+    const live_block_t *second_block = (const live_block_t *)second;
+
+    if(first_block->size != second_block->size)
+        return first_block->size > second_block->size ? -1 : 1;
+
+    return first_block->address < second_block->address ? -1 : 1;
+}
+
+//empty slots have no calls, so they are moved to the end
+int compare_sites(const void *first,
+                  const void *second) {
+    const call_site_t *first_site  = (const call_site_t *)first;
+    const call_site_t *second_site = (const call_site_t *)second;
+
+    uint64_t first_calls  = first_site ->allocations + first_site ->reallocations;
+    uint64_t second_calls = second_site->allocations + second_site->reallocations;
+    if(first_calls != second_calls)
+        return first_calls > second_calls ? -1 : 1;
+
+    if(first_site->address != second_site->address)
+        return first_site->address < second_site->address ? -1 : 1;
+
+    return 0;
+}
+
+/**
+======================================================================================================
+    @brief      Closes files and frees tables.
+
+======================================================================================================
+*/
+report_error_t destroy_report(report_t *report) {
+    if(report->input != NULL)
+        fclose(report->input);
+
+    if(report->output != NULL && report->output != stdout)
+        fclose(report->output);
+
+    _free(report->records);
+    _free(report->order);
+    _free(report->blocks);
+    _free(report->sites);
+    memset(report, 0, sizeof(report_t));
+    return REPORT_SUCCESS;
+}
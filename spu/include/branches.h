@@ -0,0 +1,37 @@
+#ifndef BRANCHES_H
+#define BRANCHES_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+
+//branch profiler is built only with -DSPU_PROFILE and is enabled by
+//'--branch-profile file'. it counts taken and not taken conditional jumps
+//and loop trip counts of backward jumps for every jump site
+#ifdef SPU_PROFILE
+    struct spu_branches_t;
+
+    spu_branches_t *branches_create (const char             *filename,
+                                     address_t               code_size);
+    void            branches_add    (spu_branches_t         *branches,
+                                     const command_t        *code,
+                                     address_t               site,
+                                     bool                    is_taken);
+    void            branches_report (spu_branches_t         *branches,
+                                     const program_symbol_t *symbols,
+                                     uint64_t                symbols_number);
+    void            branches_destroy(spu_branches_t        **branches);
+
+    //instruction pointer is on argument of jump, command is right before it
+    #define SPU_BRANCH_PROFILE(spu, is_taken)                                   \
+        if((spu)->branches != NULL)                                             \
+            branches_add((spu)->branches,                                       \
+                         (spu)->code,                                           \
+                         (spu)->instruction_pointer - 1,                        \
+                         is_taken)
+#else
+    #define SPU_BRANCH_PROFILE(spu, is_taken)
+#endif
+
+#endif
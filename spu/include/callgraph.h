@@ -0,0 +1,49 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+#include "profile.h"
+
+//call-graph profiler is built only with -DSPU_PROFILE and is enabled by
+//'--callgraph file'. it keeps shadow call stack which is changed by call and
+//ret, counts inclusive and exclusive commands and cycles of every function
+//and calls of every call site, and writes callgrind file
+#ifdef SPU_PROFILE
+    struct spu_callgraph_t;
+
+    spu_callgraph_t *callgraph_create(const char             *filename,
+                                      address_t               code_size,
+                                      address_t               max_depth,
+                                      uint64_t                commands_number);
+    void             callgraph_call  (spu_callgraph_t        *callgraph,
+                                      address_t               call_site,
+                                      address_t               function,
+                                      uint64_t                commands_number);
+    void             callgraph_ret   (spu_callgraph_t        *callgraph,
+                                      uint64_t                commands_number);
+    void             callgraph_report(spu_callgraph_t        *callgraph,
+                                      const program_symbol_t *symbols,
+                                      uint64_t                symbols_number,
+                                      const char             *binary_name,
+                                      uint64_t                commands_number);
+    void             callgraph_destroy(spu_callgraph_t      **callgraph);
+
+    #define SPU_CALLGRAPH_CALL(spu, call_site)                                  \
+        if((spu)->callgraph != NULL)                                            \
+            callgraph_call((spu)->callgraph,                                    \
+                           call_site,                                           \
+                           (spu)->instruction_pointer,                          \
+                           (spu)->commands_number)
+
+    #define SPU_CALLGRAPH_RET(spu)                                              \
+        if((spu)->callgraph != NULL)                                            \
+            callgraph_ret((spu)->callgraph, (spu)->commands_number)
+#else
+    #define SPU_CALLGRAPH_CALL(spu, call_site)
+    #define SPU_CALLGRAPH_RET(spu)
+#endif
+
+#endif
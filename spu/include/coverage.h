@@ -0,0 +1,34 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+
+//coverage is built only with -DSPU_PROFILE and is enabled by '--coverage file'.
+//byte of every code offset is set when command on it is run, so run loop
+//pays one store per command. bytes are packed to bitmap and merged with
+//existing file when SPU is destroyed
+#ifdef SPU_PROFILE
+    struct spu_coverage_t {
+        const char *filename;
+        address_t   code_size;
+        uint8_t    *executed;
+    };
+
+    spu_coverage_t *coverage_create (const char      *filename,
+                                     address_t        code_size);
+    void            coverage_write  (spu_coverage_t  *coverage,
+                                     const command_t *code);
+    void            coverage_destroy(spu_coverage_t **coverage);
+
+    #define SPU_COVERAGE_COMMAND(spu)                                           \
+        if((spu)->coverage != NULL &&                                           \
+           (spu)->instruction_pointer < (spu)->coverage->code_size)             \
+            (spu)->coverage->executed[(spu)->instruction_pointer] = 1
+#else
+    #define SPU_COVERAGE_COMMAND(spu)
+#endif
+
+#endif
@@ -6,6 +6,7 @@
 
 spu_error_t  write_code_dump      (spu_t    *spu);
 spu_error_t  write_registers_dump (spu_t    *spu);
+spu_error_t  write_call_stack_dump(spu_t    *spu);
 spu_error_t  write_ram_dump       (spu_t    *spu);
 
 #endif
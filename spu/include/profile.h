@@ -0,0 +1,75 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+
+//profiler is built only with -DSPU_PROFILE and is enabled by '--profile file',
+//without SPU_PROFILE all hooks in run loop are empty
+#ifdef SPU_PROFILE
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #else
+        #include <time.h>
+    #endif
+
+    static const size_t profile_command_values = 256;
+
+    //counters are indexed by the whole command byte, so every combination
+    //of operation code and argument type is counted separately
+    struct spu_profile_t {
+        const char *filename;
+        uint64_t    command_counts[profile_command_values];
+        uint64_t    command_cycles[profile_command_values];
+        uint64_t   *ip_counts;
+        uint64_t   *ip_cycles;
+        address_t   code_size;
+    };
+
+    //TSC on x86, monotonic nanoseconds on other processors
+    inline uint64_t profile_timestamp(void) {
+        #if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+        #else
+            timespec time = {};
+            clock_gettime(CLOCK_MONOTONIC, &time);
+            return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+        #endif
+    }
+
+    inline void profile_add_command(spu_profile_t *profile,
+                                    command_t      command,
+                                    address_t      instruction_pointer,
+                                    uint64_t       cycles) {
+        profile->command_counts[command]++;
+        profile->command_cycles[command] += cycles;
+        profile->ip_counts[instruction_pointer]++;
+        profile->ip_cycles[instruction_pointer] += cycles;
+    }
+
+    spu_profile_t *profile_create (const char     *filename,
+                                   address_t       code_size);
+    void           profile_report (spu_profile_t  *profile,
+                                   const command_t *code);
+    void           profile_destroy(spu_profile_t **profile);
+
+    //timestamp is taken only with '--profile', so other facilities of
+    //profiling build do not pay for it on every command
+    #define SPU_PROFILE_COMMAND_BEGIN(spu)                                      \
+        address_t profile_pointer = (spu)->instruction_pointer;                 \
+        uint64_t  profile_start   = (spu)->profile != NULL ? profile_timestamp() : 0
+
+    #define SPU_PROFILE_COMMAND_END(spu)                                        \
+        if((spu)->profile != NULL)                                              \
+            profile_add_command((spu)->profile,                                 \
+                                (spu)->code[profile_pointer],                   \
+                                profile_pointer,                                \
+                                profile_timestamp() - profile_start)
+#else
+    #define SPU_PROFILE_COMMAND_BEGIN(spu)
+    #define SPU_PROFILE_COMMAND_END(spu)
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef RAM_PROFILE_H
+#define RAM_PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+
+//RAM profiler is built only with -DSPU_PROFILE and is enabled by
+//'--ram-profile name'. it counts reads and writes of every RAM cell by
+//push and pop with [...] argument and working set (number of different
+//cells) of every window of '--ram-window' commands. name.csv and heatmap
+//name.ppm are written when SPU is destroyed
+#ifdef SPU_PROFILE
+    struct spu_ram_profile_t;
+
+    spu_ram_profile_t *ram_profile_create (const char         *name,
+                                           address_t           ram_size,
+                                           uint64_t            window_size);
+    void               ram_profile_add    (spu_ram_profile_t  *ram_profile,
+                                           address_t           cell,
+                                           bool                is_write,
+                                           uint64_t            commands_number);
+    void               ram_profile_report (spu_ram_profile_t  *ram_profile);
+    void               ram_profile_destroy(spu_ram_profile_t **ram_profile);
+
+    #define SPU_RAM_PROFILE(spu, cell_pointer, is_write)                        \
+        if((spu)->ram_profile != NULL && (cell_pointer) != NULL)                \
+            ram_profile_add((spu)->ram_profile,                                 \
+                            (address_t)((cell_pointer) -                        \
+                                        (spu)->random_access_memory),           \
+                            is_write,                                           \
+                            (spu)->commands_number)
+#else
+    #define SPU_RAM_PROFILE(spu, cell_pointer, is_write)
+#endif
+
+#endif
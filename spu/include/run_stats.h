@@ -0,0 +1,39 @@
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+#include "stack.h"
+#include "clocks.h"
+
+//statistics are enabled by '--stats' in every build and are printed when SPU
+//is destroyed. commands are counted by SPU anyway, statistics add one byte
+//store per RAM access and clock reads around in, out, draw and dump
+struct spu_run_stats_t {
+    uint64_t  start_wall_time;
+    uint64_t  start_cpu_time;
+    uint64_t  io_time;
+    uint8_t  *touched_cells;
+    address_t ram_size;
+    size_t    mapping_size;
+};
+
+spu_run_stats_t *run_stats_create (address_t         ram_size);
+void             run_stats_start  (spu_run_stats_t  *stats);
+void             run_stats_report (spu_run_stats_t  *stats,
+                                   uint64_t          commands_number,
+                                   const stack_t    *stack,
+                                   address_t         max_call_depth);
+void             run_stats_destroy(spu_run_stats_t **stats);
+
+//access out of RAM is not counted, it is stopped by protected RAM
+#define SPU_STATS_RAM(spu, cell_pointer)                                        \
+    if((spu)->stats != NULL && (cell_pointer) != NULL &&                        \
+       (address_t)((cell_pointer) - (spu)->random_access_memory) <              \
+       (spu)->stats->ram_size)                                                  \
+        (spu)->stats->touched_cells[(cell_pointer) -                            \
+                                    (spu)->random_access_memory] = 1
+
+#endif
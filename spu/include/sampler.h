@@ -0,0 +1,12 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "spu_commands.h"
+
+//sampling profiler is enabled by '--sample file', it interrupts SPU with
+//'--sample-rate' frequency, takes SPU call stack and writes folded stacks
+//('main;fact;fact 42') for flamegraph tools when SPU is destroyed
+spu_error_t sampler_start(spu_t *spu);
+spu_error_t sampler_stop (spu_t *spu);
+
+#endif
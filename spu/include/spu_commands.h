@@ -6,33 +6,108 @@
 
 #include "stack.h"
 #include "spu_facilities.h"
+#include "memory.h"
+#include "profile.h"
+#include "callgraph.h"
+#include "branches.h"
+#include "ram_profile.h"
+#include "coverage.h"
+#include "trace.h"
+#include "run_stats.h"
 
 enum spu_error_t {
-    SPU_SUCCESS         = 0 ,
-    SPU_EXIT_SUCCESS    = 1 ,
-    SPU_STACK_ERROR     = 2 ,
-    SPU_CODE_SIZE_ERROR = 3 ,
-    SPU_NULL_POINTER    = 4 ,
-    SPU_READING_ERROR   = 5 ,
-    SPU_MEMORY_ERROR    = 6 ,
-    SPU_UNKNOWN_COMMAND = 7 ,
-    SPU_INPUT_ERROR     = 8 ,
-    SPU_REGISTER_ERROR  = 9 ,
-    SPU_WRONG_VERSION   = 10,
-    SPU_WRONG_ASSEMBLER = 11,
-    SPU_MEMSET_ERROR    = 12,
-    SPU_DUMP_ERROR      = 13,
-    SPU_COMMANDS_ERROR  = 14,
+    SPU_SUCCESS            = 0 ,
+    SPU_EXIT_SUCCESS       = 1 ,
+    SPU_STACK_ERROR        = 2 ,
+    SPU_CODE_SIZE_ERROR    = 3 ,
+    SPU_NULL_POINTER       = 4 ,
+    SPU_READING_ERROR      = 5 ,
+    SPU_MEMORY_ERROR       = 6 ,
+    SPU_UNKNOWN_COMMAND    = 7 ,
+    SPU_INPUT_ERROR        = 8 ,
+    SPU_REGISTER_ERROR     = 9 ,
+    SPU_WRONG_VERSION      = 10,
+    SPU_WRONG_ASSEMBLER    = 11,
+    SPU_MEMSET_ERROR       = 12,
+    SPU_DUMP_ERROR         = 13,
+    SPU_COMMANDS_ERROR     = 14,
+    SPU_FLAGS_ERROR        = 15,
+    SPU_CALL_STACK_ERROR   = 16,
+    SPU_RAM_FAULT          = 17,
+    SPU_SAMPLER_ERROR      = 18,
+    SPU_INSTRUCTIONS_LIMIT = 19,
+    SPU_TIMEOUT            = 20,
 };
 
-struct spu_t {
-    stack_t     *stack;
-    command_t   *code;
-    address_t    code_size;
-    address_t    instruction_pointer;
-    argument_t   registers[registers_number];
-    argument_t  *random_access_memory;
-    argument_t   push_register;
+//ram_size is 0 and ram_filename is NULL if they are not set in command line
+struct spu_flags_t {
+    const char *code_filename;
+    const char *ram_filename;
+    const char *profile_filename;
+    const char *callgraph_filename;
+    const char *branches_filename;
+    const char *ram_profile_name;
+    size_t      ram_window;
+    const char *coverage_filename;
+    const char *trace_filename;
+    size_t      trace_events;
+    size_t      max_instructions;
+    size_t      timeout;
+    const char *sample_filename;
+    size_t      sample_rate;
+    size_t      stack_size;
+    size_t      ram_size;
+    bool        huge_pages;
+    bool        protected_ram;
+    bool        print_memory_stats;
+    bool        print_run_stats;
+};
+
+static const size_t spu_region_alignment = 64;
+
+struct spu_sampler_t;
+
+//SPU is one region which is allocated with one call: this structure, value
+//stack, call stack, code and symbols. fields which are used by every command fill the
+//first cache line of region. command_pointer is instruction pointer of the
+//first byte of running command, errors are reported at it. RAM is mapped
+//separately, so pages are committed on the first touch
+struct alignas(spu_region_alignment) spu_t {
+    address_t           instruction_pointer;
+    command_t          *code;
+    stack_t            *stack;
+    argument_t          registers[registers_number];
+    argument_t          push_register;
+
+    address_t          *call_stack;
+    uint64_t            commands_number;
+    address_t           command_pointer;
+    uint64_t            limits_check;
+    address_t           call_stack_size;
+    address_t           max_call_depth;
+    address_t           call_stack_capacity;
+    argument_t         *random_access_memory;
+    address_t           ram_size;
+    address_t           ram_address_mask;
+    size_t              ram_mapping_size;
+    address_t           code_size;
+    program_symbol_t   *symbols;
+    uint64_t            symbols_number;
+    size_t              region_size;
+    spu_flags_t         flags;
+    bool                has_ram_fault;
+    address_t           ram_fault_cell;
+    spu_sampler_t      *sampler;
+    spu_run_stats_t    *stats;
+    uint64_t            deadline;
+#ifdef SPU_PROFILE
+    spu_profile_t      *profile;
+    spu_callgraph_t    *callgraph;
+    spu_branches_t     *branches;
+    spu_ram_profile_t  *ram_profile;
+    spu_coverage_t     *coverage;
+    spu_trace_t        *trace;
+#endif
 };
 
 spu_error_t run_command_chai     (spu_t    *spu);
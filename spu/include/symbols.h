@@ -0,0 +1,21 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+
+//symbols are labels which are written to binary by 'asm -g',
+//they are sorted by address once after they are read
+void                    symbols_sort (program_symbol_t       *symbols,
+                                      uint64_t                symbols_number);
+const program_symbol_t *symbols_find (const program_symbol_t *symbols,
+                                      uint64_t                symbols_number,
+                                      address_t               address);
+void                    symbols_print(FILE                   *output_file,
+                                      const program_symbol_t *symbols,
+                                      uint64_t                symbols_number,
+                                      address_t               address);
+
+#endif
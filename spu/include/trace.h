@@ -0,0 +1,94 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "spu_facilities.h"
+#include "clocks.h"
+
+//tracer is built only with -DSPU_PROFILE and is enabled by '--trace file'.
+//call, ret, in, out, draw and dump are written to preallocated buffer as
+//binary events with value stack size and call depth at this moment. buffer is
+//serialized to Chrome trace-event JSON when SPU is destroyed, events after
+//'--trace-events' are dropped
+#ifdef SPU_PROFILE
+    enum trace_event_type_t {
+        TRACE_EVENT_CALL    = 0,
+        TRACE_EVENT_RET     = 1,
+        TRACE_EVENT_COMMAND = 2,
+    };
+
+    struct trace_event_t {
+        uint64_t  timestamp;
+        address_t address;
+        uint64_t  stack_size;
+        uint32_t  call_depth;
+        uint8_t   type;
+        command_t command;
+    };
+
+    struct spu_trace_t {
+        const char    *filename;
+        trace_event_t *events;
+        size_t         events_number;
+        size_t         events_capacity;
+        size_t         mapping_size;
+        uint64_t       dropped_events;
+        uint64_t       start_time;
+    };
+
+    spu_trace_t *trace_create (const char             *filename,
+                               size_t                  events_capacity);
+    void         trace_report (spu_trace_t            *trace,
+                               const program_symbol_t *symbols,
+                               uint64_t                symbols_number,
+                               const char             *binary_name);
+    void         trace_destroy(spu_trace_t           **trace);
+
+    inline void trace_add(spu_trace_t        *trace,
+                          trace_event_type_t  type,
+                          address_t           address,
+                          command_t           command,
+                          uint64_t            stack_size,
+                          address_t           call_depth) {
+        if(trace->events_number == trace->events_capacity) {
+            trace->dropped_events++;
+            return ;
+        }
+
+        trace->events[trace->events_number++] = {.timestamp  = clocks_wall_ns(),
+                                                 .address    = address,
+                                                 .stack_size = stack_size,
+                                                 .call_depth = (uint32_t)call_depth,
+                                                 .type       = (uint8_t)type,
+                                                 .command    = command};
+    }
+
+    //callee is instruction pointer after jump of call
+    #define SPU_TRACE_CALL(spu)                                                 \
+        if((spu)->trace != NULL)                                                \
+            trace_add((spu)->trace, TRACE_EVENT_CALL,                           \
+                      (spu)->instruction_pointer, CMD_CALL,                     \
+                      stack_get_size((spu)->stack), (spu)->call_stack_size)
+
+    //it is placed before return address is popped
+    #define SPU_TRACE_RET(spu)                                                  \
+        if((spu)->trace != NULL)                                                \
+            trace_add((spu)->trace, TRACE_EVENT_RET,                            \
+                      (spu)->instruction_pointer - 1, CMD_RET,                  \
+                      stack_get_size((spu)->stack), (spu)->call_stack_size - 1)
+
+    //it is placed in the beginning of command handler
+    #define SPU_TRACE_COMMAND(spu, command)                                     \
+        if((spu)->trace != NULL)                                                \
+            trace_add((spu)->trace, TRACE_EVENT_COMMAND,                        \
+                      (spu)->instruction_pointer - 1, command,                  \
+                      stack_get_size((spu)->stack), (spu)->call_stack_size)
+#else
+    #define SPU_TRACE_CALL(spu)
+    #define SPU_TRACE_RET(spu)
+    #define SPU_TRACE_COMMAND(spu, command)
+#endif
+
+#endif
@@ -0,0 +1,346 @@
+#ifdef SPU_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "branches.h"
+#include "symbols.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief      Initializing size of jump sites array.
+
+======================================================================================================
+*/
+static const size_t branches_init_size = 64;
+
+/**
+======================================================================================================
+    @brief      Conditional jump site.
+
+    @details    Iterations counts number of taken backward jumps since the last
+                exit from loop, exit adds iterations + 1 to trips histogram.
+
+======================================================================================================
+*/
+struct branch_site_t {
+    address_t site;
+    command_t command;
+    address_t target;
+    uint64_t  taken;
+    uint64_t  not_taken;
+    uint64_t  iterations;
+    uint64_t  trips[branch_trip_buckets];
+};
+
+/**
+======================================================================================================
+    @brief      Branch profiler.
+
+    @details    Indexes of sites are kept for every code address, index 0 means
+                that jump on this address was not run yet.
+
+======================================================================================================
+*/
+struct spu_branches_t {
+    const char    *filename;
+    address_t      code_size;
+    size_t        *site_indexes;
+    branch_site_t *sites;
+    size_t         sites_number;
+    size_t         sites_size;
+    bool           is_failed;
+};
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static branch_site_t *find_site         (spu_branches_t         *branches,
+                                         const command_t        *code,
+                                         address_t               site);
+static bool           check_sites_size  (spu_branches_t         *branches);
+static void           add_trip          (branch_site_t          *site);
+static void           print_sites       (spu_branches_t         *branches,
+                                         const program_symbol_t *symbols,
+                                         uint64_t                symbols_number);
+static void           write_branches    (spu_branches_t         *branches);
+
+/**
+======================================================================================================
+    @brief      Creates branch profiler.
+
+    @param [in] filename            Name of branch profile file.
+    @param [in] code_size           Size of code.
+
+    @return Profiler or NULL if it was not allocated.
+
+======================================================================================================
+*/
+spu_branches_t *branches_create(const char *filename,
+                                address_t   code_size) {
+    C_ASSERT(filename != NULL, return NULL);
+
+    spu_branches_t *branches = (spu_branches_t *)_calloc(1, sizeof(spu_branches_t));
+    if(branches == NULL)
+        return NULL;
+
+    //site with index 0 is not used
+    branches->filename     = filename;
+    branches->code_size    = code_size;
+    branches->site_indexes = (size_t        *)_calloc(code_size, sizeof(size_t));
+    branches->sites        = (branch_site_t *)_calloc(branches_init_size, sizeof(branch_site_t));
+    branches->sites_size   = branches_init_size;
+    branches->sites_number = 1;
+    if(branches->site_indexes == NULL || branches->sites == NULL) {
+        branches_destroy(&branches);
+        return NULL;
+    }
+
+    return branches;
+}
+
+/**
+======================================================================================================
+    @brief      Counts conditional jump.
+
+    @param [in] branches            Profiler.
+    @param [in] code                Code of SPU.
+    @param [in] site                Address of jump command.
+    @param [in] is_taken            Result of condition.
+
+======================================================================================================
+*/
+void branches_add(spu_branches_t  *branches,
+                  const command_t *code,
+                  address_t        site,
+                  bool             is_taken) {
+    branch_site_t *branch = find_site(branches, code, site);
+    if(branch == NULL)
+        return ;
+
+    bool is_backward = branch->target <= site;
+    if(is_taken) {
+        branch->taken++;
+        if(is_backward)
+            branch->iterations++;
+    }
+    else {
+        branch->not_taken++;
+        if(is_backward)
+            add_trip(branch);
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Prints jump sites and writes branch profile file.
+
+    @details    Loops which were running when program halted are counted
+                as exits from loops.
+
+    @param [in] branches            Profiler.
+    @param [in] symbols             Sorted symbols of program.
+    @param [in] symbols_number      Number of symbols.
+
+======================================================================================================
+*/
+void branches_report(spu_branches_t         *branches,
+                     const program_symbol_t *symbols,
+                     uint64_t                symbols_number) {
+    C_ASSERT(branches != NULL, return );
+
+    if(branches->is_failed) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to branch profile, it is not written.\r\n");
+        return ;
+    }
+
+    for(size_t index = 1; index < branches->sites_number; index++)
+        if(branches->sites[index].iterations != 0)
+            add_trip(branches->sites + index);
+
+    print_sites   (branches, symbols, symbols_number);
+    write_branches(branches);
+}
+
+/**
+======================================================================================================
+    @brief      Frees branch profiler and sets pointer to NULL.
+
+======================================================================================================
+*/
+void branches_destroy(spu_branches_t **branches) {
+    C_ASSERT(branches != NULL, return );
+    if(*branches == NULL)
+        return ;
+
+    _free((*branches)->site_indexes);
+    _free((*branches)->sites);
+    _free(*branches);
+    *branches = NULL;
+}
+
+/**
+======================================================================================================
+    @brief      Returns jump site, site is added on the first run of jump.
+
+    @return Jump site or NULL if memory was not allocated.
+
+======================================================================================================
+*/
+branch_site_t *find_site(spu_branches_t  *branches,
+                         const command_t *code,
+                         address_t        site) {
+    if(branches->is_failed || site >= branches->code_size)
+        return NULL;
+
+    if(branches->site_indexes[site] != 0)
+        return branches->sites + branches->site_indexes[site];
+
+    if(!check_sites_size(branches)) {
+        branches->is_failed = true;
+        return NULL;
+    }
+
+    size_t         index  = branches->sites_number++;
+    branch_site_t *branch = branches->sites + index;
+    branch->site          = site;
+    branch->command       = (command_t)(code[site] & operation_code_mask);
+    memcpy(&branch->target, code + site + 1, sizeof(address_t));
+
+    branches->site_indexes[site] = index;
+    return branch;
+}
+
+/**
+======================================================================================================
+    @brief      Checks if size of sites array is sufficient.
+
+    @details    If number of sites is equal to size of array, it reallocates sites array.
+
+    @return false if array was not reallocated.
+
+======================================================================================================
+*/
+bool check_sites_size(spu_branches_t *branches) {
+    if(branches->sites_number < branches->sites_size)
+        return true;
+
+    branch_site_t *new_sites = (branch_site_t *)_recalloc(branches->sites,
+                                                          branches->sites_size,
+                                                          branches->sites_size * 2,
+                                                          sizeof(branch_site_t));
+    if(new_sites == NULL)
+        return false;
+
+    branches->sites       = new_sites;
+    branches->sites_size *= 2;
+    return true;
+}
+
+/**
+======================================================================================================
+    @brief      Adds exit from loop with iterations + 1 trips to histogram.
+
+======================================================================================================
+*/
+void add_trip(branch_site_t *site) {
+    uint64_t trips  = site->iterations + 1;
+    size_t   bucket = 0;
+    while(bucket + 1 < branch_trip_buckets && (trips >> (bucket + 1)) != 0)
+        bucket++;
+
+    site->trips[bucket]++;
+    site->iterations = 0;
+}
+
+/**
+======================================================================================================
+    @brief      Prints jump sites in order of addresses.
+
+    @details    Average trips of backward jump is number of runs of jump
+                divided by number of exits from loop.
+
+======================================================================================================
+*/
+void print_sites(spu_branches_t         *branches,
+                 const program_symbol_t *symbols,
+                 uint64_t                symbols_number) {
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Branch profile: %zu conditional jumps.\r\n",
+                 branches->sites_number - 1);
+    printf("site     command           taken       not taken  taken %%  avg trips  target\r\n");
+    for(address_t address = 0; address < branches->code_size; address++) {
+        if(branches->site_indexes[address] == 0)
+            continue;
+
+        branch_site_t *site  = branches->sites + branches->site_indexes[address];
+        uint64_t       total = site->taken + site->not_taken;
+        printf("0x%-6llx %-7s %15llu %15llu %7.2f%% ",
+               site->site,
+               spu_command_name(site->command),
+               site->taken,
+               site->not_taken,
+               100.0 * (double)site->taken / (double)total);
+
+        uint64_t exits = 0;
+        for(size_t bucket = 0; bucket < branch_trip_buckets; bucket++)
+            exits += site->trips[bucket];
+
+        if(site->target <= site->site && exits != 0)
+            printf("%10.1f  ", (double)total / (double)exits);
+        else
+            printf("%10s  ", "-");
+
+        symbols_print(stdout, symbols, symbols_number, site->target);
+        printf("\r\n");
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Writes branch profile file.
+
+======================================================================================================
+*/
+void write_branches(spu_branches_t *branches) {
+    FILE *branches_file = fopen(branches->filename, "wb");
+    if(branches_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening branch profile file '%s'.\r\n",
+                     branches->filename);
+        return ;
+    }
+
+    fprintf(branches_file, "%s %llu %llu %zu\n",
+            branch_profile_signature,
+            branch_profile_version,
+            branches->code_size,
+            branch_trip_buckets);
+    for(address_t address = 0; address < branches->code_size; address++) {
+        if(branches->site_indexes[address] == 0)
+            continue;
+
+        branch_site_t *site = branches->sites + branches->site_indexes[address];
+        fprintf(branches_file, "0x%llx %s 0x%llx %llu %llu",
+                site->site,
+                spu_command_name(site->command),
+                site->target,
+                site->taken,
+                site->not_taken);
+        for(size_t bucket = 0; bucket < branch_trip_buckets; bucket++)
+            fprintf(branches_file, " %llu", site->trips[bucket]);
+
+        fputc('\n', branches_file);
+    }
+
+    fclose(branches_file);
+}
+
+#endif
@@ -0,0 +1,573 @@
+#ifdef SPU_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "callgraph.h"
+#include "symbols.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief      Initializing size of functions and call sites arrays.
+
+======================================================================================================
+*/
+static const size_t callgraph_init_size = 64;
+
+/**
+======================================================================================================
+    @brief      Function which is called at least once (or program entry) with its costs.
+
+    @details    Inclusive costs of recursive function are counted only for the
+                outermost frame, so they are not counted twice.
+                Call sites of function are linked list in call sites array.
+
+======================================================================================================
+*/
+struct callgraph_function_t {
+    address_t entry;
+    uint64_t  calls;
+    uint64_t  inclusive_commands;
+    uint64_t  exclusive_commands;
+    uint64_t  inclusive_cycles;
+    uint64_t  exclusive_cycles;
+    size_t    active_frames;
+    size_t    first_call_site;
+};
+
+/**
+======================================================================================================
+    @brief      Call from one call site of caller to callee with inclusive costs of calls.
+
+======================================================================================================
+*/
+struct callgraph_call_site_t {
+    address_t call_site;
+    size_t    callee;
+    uint64_t  calls;
+    uint64_t  inclusive_commands;
+    uint64_t  inclusive_cycles;
+    size_t    next_call_site;
+};
+
+/**
+======================================================================================================
+    @brief      Frame of shadow call stack.
+
+======================================================================================================
+*/
+struct callgraph_frame_t {
+    size_t    function;
+    size_t    call_site;
+    uint64_t  start_commands;
+    uint64_t  start_cycles;
+    uint64_t  child_commands;
+    uint64_t  child_cycles;
+};
+
+/**
+======================================================================================================
+    @brief      Call-graph profiler.
+
+    @details    Indexes of functions are kept for every code address, so function
+                is found with one access. Index 0 means that there is no function,
+                the same is used for the end of call sites list.
+                Shadow stack has the same capacity as SPU call stack and one
+                frame for program entry.
+
+======================================================================================================
+*/
+struct spu_callgraph_t {
+    const char            *filename;
+    size_t                *function_indexes;
+    address_t              code_size;
+    callgraph_function_t  *functions;
+    size_t                 functions_number;
+    size_t                 functions_size;
+    callgraph_call_site_t *call_sites;
+    size_t                 call_sites_number;
+    size_t                 call_sites_size;
+    callgraph_frame_t     *frames;
+    size_t                 frames_number;
+    size_t                 frames_size;
+    bool                   is_failed;
+};
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static size_t find_function     (spu_callgraph_t        *callgraph,
+                                 address_t               entry);
+static size_t find_call_site    (spu_callgraph_t        *callgraph,
+                                 size_t                  caller,
+                                 address_t               call_site,
+                                 size_t                  callee);
+static void   push_frame        (spu_callgraph_t        *callgraph,
+                                 size_t                  function,
+                                 size_t                  call_site,
+                                 uint64_t                commands_number);
+static bool   check_array_size  (void                  **array,
+                                 size_t                 *size,
+                                 size_t                  number,
+                                 size_t                  element_size);
+static void   print_name        (FILE                   *output_file,
+                                 const program_symbol_t *symbols,
+                                 uint64_t                symbols_number,
+                                 address_t               entry);
+static void   print_functions   (spu_callgraph_t        *callgraph,
+                                 const program_symbol_t *symbols,
+                                 uint64_t                symbols_number);
+static void   write_callgrind   (spu_callgraph_t        *callgraph,
+                                 const program_symbol_t *symbols,
+                                 uint64_t                symbols_number,
+                                 const char             *binary_name);
+static int    compare_functions (const void             *first,
+                                 const void             *second);
+
+/**
+======================================================================================================
+    @brief      Creates call-graph profiler.
+
+    @details    Program entry is the first function, it is pushed to shadow stack.
+
+    @param [in] filename            Name of callgrind file.
+    @param [in] code_size           Size of code.
+    @param [in] max_depth           Capacity of SPU call stack.
+    @param [in] commands_number     Number of commands which SPU has already run.
+
+    @return Profiler or NULL if it was not allocated.
+
+======================================================================================================
+*/
+spu_callgraph_t *callgraph_create(const char *filename,
+                                  address_t   code_size,
+                                  address_t   max_depth,
+                                  uint64_t    commands_number) {
+    C_ASSERT(filename != NULL, return NULL);
+
+    spu_callgraph_t *callgraph = (spu_callgraph_t *)_calloc(1, sizeof(spu_callgraph_t));
+    if(callgraph == NULL)
+        return NULL;
+
+    //one more index for calls out of code, one more function and call site for index 0
+    callgraph->filename          = filename;
+    callgraph->code_size         = code_size;
+    callgraph->function_indexes  = (size_t                *)_calloc(code_size + 1,
+                                                                    sizeof(size_t));
+    callgraph->functions         = (callgraph_function_t  *)_calloc(callgraph_init_size,
+                                                                    sizeof(callgraph_function_t));
+    callgraph->call_sites        = (callgraph_call_site_t *)_calloc(callgraph_init_size,
+                                                                    sizeof(callgraph_call_site_t));
+    callgraph->frames            = (callgraph_frame_t     *)_calloc(max_depth + 1,
+                                                                    sizeof(callgraph_frame_t));
+    callgraph->functions_size    = callgraph_init_size;
+    callgraph->functions_number  = 1;
+    callgraph->call_sites_size   = callgraph_init_size;
+    callgraph->call_sites_number = 1;
+    callgraph->frames_size       = max_depth + 1;
+    if(callgraph->function_indexes == NULL ||
+       callgraph->functions        == NULL ||
+       callgraph->call_sites       == NULL ||
+       callgraph->frames           == NULL) {
+        callgraph_destroy(&callgraph);
+        return NULL;
+    }
+
+    push_frame(callgraph, find_function(callgraph, 0), 0, commands_number);
+    return callgraph;
+}
+
+/**
+======================================================================================================
+    @brief      Counts call and pushes frame of callee to shadow stack.
+
+    @param [in] callgraph           Profiler.
+    @param [in] call_site           Address of call command.
+    @param [in] function            Address of callee.
+    @param [in] commands_number     Number of commands which SPU has run, including call.
+
+======================================================================================================
+*/
+void callgraph_call(spu_callgraph_t *callgraph,
+                    address_t        call_site,
+                    address_t        function,
+                    uint64_t         commands_number) {
+    if(callgraph->is_failed || callgraph->frames_number == 0)
+        return ;
+
+    size_t caller = callgraph->frames[callgraph->frames_number - 1].function;
+    size_t callee = find_function(callgraph, function);
+    size_t site   = find_call_site(callgraph, caller, call_site, callee);
+    if(callee == 0 || site == 0)
+        return ;
+
+    callgraph->call_sites[site  ].calls++;
+    callgraph->functions [callee].calls++;
+    push_frame(callgraph, callee, site, commands_number);
+}
+
+/**
+======================================================================================================
+    @brief      Pops frame from shadow stack and adds its costs.
+
+    @param [in] callgraph           Profiler.
+    @param [in] commands_number     Number of commands which SPU has run, including ret.
+
+======================================================================================================
+*/
+void callgraph_ret(spu_callgraph_t *callgraph,
+                   uint64_t         commands_number) {
+    if(callgraph->is_failed || callgraph->frames_number == 0)
+        return ;
+
+    callgraph_frame_t    *frame    = callgraph->frames + --callgraph->frames_number;
+    callgraph_function_t *function = callgraph->functions + frame->function;
+    uint64_t              commands = commands_number       - frame->start_commands;
+    uint64_t              cycles   = profile_timestamp()   - frame->start_cycles;
+
+    function->exclusive_commands += commands - frame->child_commands;
+    function->exclusive_cycles   += cycles   - frame->child_cycles;
+    if(--function->active_frames == 0) {
+        function->inclusive_commands += commands;
+        function->inclusive_cycles   += cycles;
+    }
+
+    if(frame->call_site != 0) {
+        callgraph->call_sites[frame->call_site].inclusive_commands += commands;
+        callgraph->call_sites[frame->call_site].inclusive_cycles   += cycles;
+    }
+
+    if(callgraph->frames_number != 0) {
+        callgraph->frames[callgraph->frames_number - 1].child_commands += commands;
+        callgraph->frames[callgraph->frames_number - 1].child_cycles   += cycles;
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Prints functions and writes callgrind file.
+
+    @details    Frames which are left on shadow stack (program halted inside
+                function) are popped first.
+
+    @param [in] callgraph           Profiler.
+    @param [in] symbols             Sorted symbols of program.
+    @param [in] symbols_number      Number of symbols.
+    @param [in] binary_name         Name of binary, it is written to callgrind file.
+    @param [in] commands_number     Number of commands which SPU has run.
+
+======================================================================================================
+*/
+void callgraph_report(spu_callgraph_t        *callgraph,
+                      const program_symbol_t *symbols,
+                      uint64_t                symbols_number,
+                      const char             *binary_name,
+                      uint64_t                commands_number) {
+    C_ASSERT(callgraph   != NULL, return );
+    C_ASSERT(binary_name != NULL, return );
+
+    if(callgraph->is_failed) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to call graph, it is not written.\r\n");
+        return ;
+    }
+
+    while(callgraph->frames_number != 0)
+        callgraph_ret(callgraph, commands_number);
+
+    print_functions(callgraph, symbols, symbols_number);
+    write_callgrind(callgraph, symbols, symbols_number, binary_name);
+}
+
+/**
+======================================================================================================
+    @brief      Frees call-graph profiler and sets pointer to NULL.
+
+======================================================================================================
+*/
+void callgraph_destroy(spu_callgraph_t **callgraph) {
+    C_ASSERT(callgraph != NULL, return );
+    if(*callgraph == NULL)
+        return ;
+
+    _free((*callgraph)->function_indexes);
+    _free((*callgraph)->functions);
+    _free((*callgraph)->call_sites);
+    _free((*callgraph)->frames);
+    _free(*callgraph);
+    *callgraph = NULL;
+}
+
+/**
+======================================================================================================
+    @brief      Returns index of function, function is added if it is new.
+
+    @details    All addresses out of code share the last index.
+
+    @return Index of function, 0 if memory was not allocated.
+
+======================================================================================================
+*/
+size_t find_function(spu_callgraph_t *callgraph,
+                     address_t        entry) {
+    address_t index_address = entry < callgraph->code_size ? entry : callgraph->code_size;
+    if(callgraph->function_indexes[index_address] != 0)
+        return callgraph->function_indexes[index_address];
+
+    if(!check_array_size((void **)&callgraph->functions,
+                         &callgraph->functions_size,
+                         callgraph->functions_number,
+                         sizeof(callgraph_function_t))) {
+        callgraph->is_failed = true;
+        return 0;
+    }
+
+    size_t function = callgraph->functions_number++;
+    callgraph->functions[function].entry         = entry;
+    callgraph->function_indexes[index_address]   = function;
+    return function;
+}
+
+/**
+======================================================================================================
+    @brief      Returns index of call site in caller, call site is added if it is new.
+
+    @return Index of call site, 0 if memory was not allocated.
+
+======================================================================================================
+*/
+size_t find_call_site(spu_callgraph_t *callgraph,
+                      size_t           caller,
+                      address_t        call_site,
+                      size_t           callee) {
+    if(caller == 0 || callee == 0)
+        return 0;
+
+    size_t site = callgraph->functions[caller].first_call_site;
+    while(site != 0) {
+        if(callgraph->call_sites[site].call_site == call_site &&
+           callgraph->call_sites[site].callee    == callee)
+            return site;
+
+        site = callgraph->call_sites[site].next_call_site;
+    }
+
+    if(!check_array_size((void **)&callgraph->call_sites,
+                         &callgraph->call_sites_size,
+                         callgraph->call_sites_number,
+                         sizeof(callgraph_call_site_t))) {
+        callgraph->is_failed = true;
+        return 0;
+    }
+
+    site = callgraph->call_sites_number++;
+    callgraph->call_sites[site].call_site      = call_site;
+    callgraph->call_sites[site].callee         = callee;
+    callgraph->call_sites[site].next_call_site = callgraph->functions[caller].first_call_site;
+    callgraph->functions[caller].first_call_site = site;
+    return site;
+}
+
+/**
+======================================================================================================
+    @brief      Pushes frame to shadow stack.
+
+======================================================================================================
+*/
+void push_frame(spu_callgraph_t *callgraph,
+                size_t           function,
+                size_t           call_site,
+                uint64_t         commands_number) {
+    if(function == 0 || callgraph->frames_number >= callgraph->frames_size)
+        return ;
+
+    callgraph->frames[callgraph->frames_number++] = {.function       = function,
+                                                     .call_site      = call_site,
+                                                     .start_commands = commands_number,
+                                                     .start_cycles   = profile_timestamp(),
+                                                     .child_commands = 0,
+                                                     .child_cycles   = 0};
+    callgraph->functions[function].active_frames++;
+}
+
+/**
+======================================================================================================
+    @brief      Checks if size of array is sufficient.
+
+    @details    If number of elements is equal to size of array, it reallocates array.
+
+    @return false if array was not reallocated.
+
+======================================================================================================
+*/
+bool check_array_size(void  **array,
+                      size_t *size,
+                      size_t  number,
+                      size_t  element_size) {
+    if(number < *size)
+        return true;
+
+    void *new_array = _recalloc(*array, *size, *size * 2, element_size);
+    if(new_array == NULL)
+        return false;
+
+    *array  = new_array;
+    *size  *= 2;
+    return true;
+}
+
+/**
+======================================================================================================
+    @brief      Prints name of function, program entry without symbol is '[entry]'.
+
+======================================================================================================
+*/
+void print_name(FILE                   *output_file,
+                const program_symbol_t *symbols,
+                uint64_t                symbols_number,
+                address_t               entry) {
+    if(entry == 0 && symbols_find(symbols, symbols_number, 0) == NULL)
+        fputs("[entry]", output_file);
+    else
+        symbols_print(output_file, symbols, symbols_number, entry);
+}
+
+/**
+======================================================================================================
+    @brief      Prints functions sorted by inclusive cycles.
+
+======================================================================================================
+*/
+void print_functions(spu_callgraph_t        *callgraph,
+                     const program_symbol_t *symbols,
+                     uint64_t                symbols_number) {
+    size_t                functions_number = callgraph->functions_number - 1;
+    callgraph_function_t *functions        = (callgraph_function_t *)_calloc(functions_number,
+                                                                              sizeof(callgraph_function_t));
+    if(functions == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to call graph report.\r\n");
+        return ;
+    }
+
+    uint64_t total_cycles = 0;
+    memcpy(functions,
+           callgraph->functions + 1,
+           functions_number * sizeof(callgraph_function_t));
+    for(size_t index = 0; index < functions_number; index++)
+        total_cycles += functions[index].exclusive_cycles;
+
+    if(total_cycles == 0)
+        total_cycles = 1;
+
+    qsort(functions, functions_number, sizeof(callgraph_function_t), compare_functions);
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Call graph: %zu functions.\r\n",
+                 functions_number);
+    printf("          calls   incl commands   excl commands incl cycles %% excl cycles %%  function\r\n");
+    for(size_t index = 0; index < functions_number; index++) {
+        printf("%15llu %15llu %15llu %12.2f%% %12.2f%%  ",
+               functions[index].calls,
+               functions[index].inclusive_commands,
+               functions[index].exclusive_commands,
+               100.0 * (double)functions[index].inclusive_cycles / (double)total_cycles,
+               100.0 * (double)functions[index].exclusive_cycles / (double)total_cycles);
+        print_name(stdout, symbols, symbols_number, functions[index].entry);
+        printf("\r\n");
+    }
+
+    _free(functions);
+}
+
+/**
+======================================================================================================
+    @brief      Writes callgrind file.
+
+    @details    Positions are code addresses. Exclusive costs of function are written
+                at its entry, inclusive costs of calls are written at call site.
+
+======================================================================================================
+*/
+void write_callgrind(spu_callgraph_t        *callgraph,
+                     const program_symbol_t *symbols,
+                     uint64_t                symbols_number,
+                     const char             *binary_name) {
+    FILE *callgrind_file = fopen(callgraph->filename, "wb");
+    if(callgrind_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening call graph file '%s'.\r\n",
+                     callgraph->filename);
+        return ;
+    }
+
+    uint64_t total_commands = 0;
+    uint64_t total_cycles   = 0;
+    for(size_t function = 1; function < callgraph->functions_number; function++) {
+        total_commands += callgraph->functions[function].exclusive_commands;
+        total_cycles   += callgraph->functions[function].exclusive_cycles;
+    }
+
+    fprintf(callgrind_file, "# callgrind format\n"
+                            "version: 1\n"
+                            "creator: spu\n"
+                            "cmd: %s\n"
+                            "positions: instr\n"
+                            "events: Commands Cycles\n"
+                            "summary: %llu %llu\n\n"
+                            "ob=%s\n",
+                            binary_name,
+                            total_commands,
+                            total_cycles,
+                            binary_name);
+
+    for(size_t index = 1; index < callgraph->functions_number; index++) {
+        callgraph_function_t *function = callgraph->functions + index;
+        fprintf(callgrind_file, "\nfn=");
+        print_name(callgrind_file, symbols, symbols_number, function->entry);
+        fprintf(callgrind_file, "\n0x%llx %llu %llu\n",
+                function->entry,
+                function->exclusive_commands,
+                function->exclusive_cycles);
+
+        for(size_t site = function->first_call_site; site != 0; site = callgraph->call_sites[site].next_call_site) {
+            callgraph_call_site_t *call_site = callgraph->call_sites + site;
+            address_t              callee    = callgraph->functions[call_site->callee].entry;
+            fprintf(callgrind_file, "cfn=");
+            print_name(callgrind_file, symbols, symbols_number, callee);
+            fprintf(callgrind_file, "\ncalls=%llu 0x%llx\n0x%llx %llu %llu\n",
+                    call_site->calls,
+                    callee,
+                    call_site->call_site,
+                    call_site->inclusive_commands,
+                    call_site->inclusive_cycles);
+        }
+    }
+
+    fprintf(callgrind_file, "\ntotals: %llu %llu\n", total_commands, total_cycles);
+    fclose(callgrind_file);
+}
+
+/**
+======================================================================================================
+    @brief      Compares functions by inclusive cycles in descending order.
+
+======================================================================================================
+*/
+int compare_functions(const void *first,
+                      const void *second) {
+    const callgraph_function_t *first_function  = (const callgraph_function_t *)first;
+    const callgraph_function_t *second_function = (const callgraph_function_t *)second;
+    if(first_function->inclusive_cycles != second_function->inclusive_cycles)
+        return first_function->inclusive_cycles < second_function->inclusive_cycles ? 1 : -1;
+
+    return first_function->entry < second_function->entry ? -1 : first_function->entry > second_function->entry;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifdef SPU_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "coverage.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "utils.h"
+#include "spu_facilities.h"
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static uint64_t read_previous_runs(spu_coverage_t *coverage,
+                                   uint64_t        code_hash,
+                                   uint8_t        *bitmap,
+                                   size_t          bitmap_size);
+
+/**
+======================================================================================================
+    @brief      Creates coverage.
+
+    @param [in] filename            Name of coverage file.
+    @param [in] code_size           Size of code, one byte is kept for every offset.
+
+    @return Coverage or NULL if it was not allocated.
+
+======================================================================================================
+*/
+spu_coverage_t *coverage_create(const char *filename,
+                                address_t   code_size) {
+    C_ASSERT(filename != NULL, return NULL);
+
+    spu_coverage_t *coverage = (spu_coverage_t *)_calloc(1, sizeof(spu_coverage_t));
+    if(coverage == NULL)
+        return NULL;
+
+    coverage->filename  = filename;
+    coverage->code_size = code_size;
+    coverage->executed  = (uint8_t *)_calloc(code_size + 1, sizeof(uint8_t));
+    if(coverage->executed == NULL) {
+        coverage_destroy(&coverage);
+        return NULL;
+    }
+
+    return coverage;
+}
+
+/**
+======================================================================================================
+    @brief      Merges coverage of this run with file and writes it.
+
+    @details    If file exists and it was written for code of the same size
+                and hash, its bitmap is merged by OR and number of runs is
+                increased. Otherwise file is overwritten with coverage of this run.
+
+    @param [in] coverage            Coverage.
+    @param [in] code                Code which was run.
+
+======================================================================================================
+*/
+void coverage_write(spu_coverage_t  *coverage,
+                    const command_t *code) {
+    C_ASSERT(coverage != NULL, return );
+    C_ASSERT(code     != NULL, return );
+
+    size_t   bitmap_size = (coverage->code_size + 7) / 8;
+    uint8_t *bitmap      = (uint8_t *)_calloc(bitmap_size + 1, sizeof(uint8_t));
+    if(bitmap == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to coverage bitmap.\r\n");
+        return ;
+    }
+
+    uint64_t          code_hash = bytes_hash(code, coverage->code_size);
+    coverage_header_t header    = {.signature = {},
+                                   .version   = coverage_version,
+                                   .code_size = coverage->code_size,
+                                   .code_hash = code_hash,
+                                   .runs      = read_previous_runs(coverage, code_hash, bitmap, bitmap_size) + 1};
+    strncpy(header.signature, coverage_signature, coverage_signature_size);
+
+    uint64_t executed_number = 0;
+    for(address_t offset = 0; offset < coverage->code_size; offset++) {
+        bitmap[offset / 8] = (uint8_t)(bitmap[offset / 8] | coverage->executed[offset] << (offset % 8));
+        executed_number   += coverage->executed[offset];
+    }
+
+    FILE *coverage_file = fopen(coverage->filename, "wb");
+    if(coverage_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening coverage file '%s'.\r\n",
+                     coverage->filename);
+        _free(bitmap);
+        return ;
+    }
+
+    if(fwrite(&header, sizeof(coverage_header_t), 1, coverage_file) != 1 ||
+       fwrite(bitmap, sizeof(uint8_t), bitmap_size, coverage_file) != bitmap_size)
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while writing coverage file '%s'.\r\n",
+                     coverage->filename);
+    else
+        color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Coverage: commands on %llu of %llu code offsets were run, %llu runs are merged to '%s'.\r\n",
+                     executed_number,
+                     coverage->code_size,
+                     header.runs,
+                     coverage->filename);
+
+    fclose(coverage_file);
+    _free(bitmap);
+}
+
+/**
+======================================================================================================
+    @brief      Frees coverage and sets pointer to NULL.
+
+======================================================================================================
+*/
+void coverage_destroy(spu_coverage_t **coverage) {
+    C_ASSERT(coverage != NULL, return );
+    if(*coverage == NULL)
+        return ;
+
+    _free((*coverage)->executed);
+    _free(*coverage);
+    *coverage = NULL;
+}
+
+/**
+======================================================================================================
+    @brief      Reads bitmap of previous runs from coverage file.
+
+    @return Number of previous runs, 0 if there is no file or it can not be merged.
+
+======================================================================================================
+*/
+uint64_t read_previous_runs(spu_coverage_t *coverage,
+                            uint64_t        code_hash,
+                            uint8_t        *bitmap,
+                            size_t          bitmap_size) {
+    FILE *coverage_file = fopen(coverage->filename, "rb");
+    if(coverage_file == NULL)
+        return 0;
+
+    coverage_header_t header = {};
+    if(fread(&header, sizeof(coverage_header_t), 1, coverage_file) != 1 ||
+       strncmp(header.signature, coverage_signature, coverage_signature_size) != 0 ||
+       header.version   != coverage_version ||
+       header.code_size != coverage->code_size ||
+       header.code_hash != code_hash ||
+       fread(bitmap, sizeof(uint8_t), bitmap_size, coverage_file) != bitmap_size) {
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "'%s' is not coverage of this code, it is overwritten.\r\n",
+                     coverage->filename);
+        memset(bitmap, 0, bitmap_size);
+        fclose(coverage_file);
+        return 0;
+    }
+
+    fclose(coverage_file);
+    return header.runs;
+}
+
+#endif
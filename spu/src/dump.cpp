@@ -9,6 +9,14 @@
 */
 static const size_t dump_elements_in_line = 15;
 
+/**
+======================================================================================================
+    @brief Maximum number of RAM cells in dump, other cells are not printed.
+
+======================================================================================================
+*/
+static const size_t dump_ram_cells = 16384;
+
 //====================================================================================================
 //FUNCTIONS PROTOTYPES
 //====================================================================================================
@@ -93,6 +101,43 @@ spu_error_t write_registers_dump(spu_t *spu) {
     return SPU_SUCCESS;
 }
 
+/**
+======================================================================================================
+    @brief      Dumps call stack
+
+    @details    Prints return addresses from call stack as table,
+                the last pushed address is printed first.
+                Addresses are printed as hex numbers.
+
+    @param [in] spu                 SPU structure
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t write_call_stack_dump(spu_t *spu) {
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 " _____________________________________ \r\n"
+                 "|       Call stack (%6llu/%6llu)    |\r\n"
+                 "|_____________________________________|\r\n",
+                 spu->call_stack_size,
+                 spu->call_stack_capacity);
+
+    for(address_t item = spu->call_stack_size; item > 0; item--) {
+        color_printf(GREEN_TEXT,   BOLD_TEXT, DEFAULT_BACKGROUND, "|");
+        color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND, "  % 16llu",
+                     item - 1);
+        color_printf(GREEN_TEXT,   BOLD_TEXT, DEFAULT_BACKGROUND, "|");
+        color_printf(DEFAULT_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND, "0x%016llx",
+                     spu->call_stack[item - 1]);
+        color_printf(GREEN_TEXT,   BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "|\r\n"
+                     "|__________________|__________________|\r\n");
+    }
+
+    return SPU_SUCCESS;
+}
+
 /**
 ======================================================================================================
     @brief      Dumps RAM
@@ -100,6 +145,7 @@ spu_error_t write_registers_dump(spu_t *spu) {
     @details    Prints RAM array as table.
                 All indexes are printed as decimal numbers and
                 all values, stored in RAM, printed as hex numbers.
+                Only the first dump_ram_cells cells are printed.
 
     @param [in] spu                 SPU structure
 
@@ -113,7 +159,8 @@ spu_error_t write_ram_dump(spu_t *spu) {
                  "|         Random Access Memory        |\r\n"
                  "|_____________________________________|\r\n");
 
-    for(address_t item = 0; item < random_access_memory_size; item++) {
+    address_t cells_number = spu->ram_size < dump_ram_cells ? spu->ram_size : dump_ram_cells;
+    for(address_t item = 0; item < cells_number; item++) {
         color_printf(YELLOW_TEXT,  BOLD_TEXT, DEFAULT_BACKGROUND, "|");
         color_printf(MAGENTA_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND, "  % 16llu",
                      item);
@@ -125,6 +172,11 @@ spu_error_t write_ram_dump(spu_t *spu) {
                      "|__________________|__________________|\r\n");
     }
 
+    if(cells_number < spu->ram_size)
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "%llu more cells are not printed.\r\n",
+                     spu->ram_size - cells_number);
+
     return SPU_SUCCESS;
 }
 
@@ -0,0 +1,303 @@
+#ifdef SPU_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief      Number of the hottest instruction pointers in report.
+
+======================================================================================================
+*/
+static const size_t profile_hot_ips_number = 16;
+
+/**
+======================================================================================================
+    @brief      Line of report: command byte or instruction pointer with its counters.
+
+======================================================================================================
+*/
+struct profile_line_t {
+    uint64_t key;
+    uint64_t count;
+    uint64_t cycles;
+};
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static const char *arguments_name      (command_t             command);
+static int         compare_lines       (const void           *first,
+                                        const void           *second);
+static void        print_commands      (spu_profile_t        *profile,
+                                        uint64_t              total_count,
+                                        uint64_t              total_cycles);
+static void        print_hot_ips       (spu_profile_t        *profile,
+                                        const command_t      *code,
+                                        uint64_t              total_cycles);
+static void        write_profile_file  (spu_profile_t        *profile,
+                                        const command_t      *code);
+
+/**
+======================================================================================================
+    @brief      Creates profile.
+
+    @param [in] filename            Name of file where profile is written.
+    @param [in] code_size           Size of code, counters of every instruction
+                                    pointer are kept.
+
+    @return Profile or NULL if it was not allocated.
+
+======================================================================================================
+*/
+spu_profile_t *profile_create(const char *filename,
+                              address_t   code_size) {
+    C_ASSERT(filename != NULL, return NULL);
+
+    spu_profile_t *profile = (spu_profile_t *)_calloc(1, sizeof(spu_profile_t));
+    if(profile == NULL)
+        return NULL;
+
+    profile->filename  = filename;
+    profile->code_size = code_size;
+    profile->ip_counts = (uint64_t *)_calloc(code_size, sizeof(uint64_t));
+    profile->ip_cycles = (uint64_t *)_calloc(code_size, sizeof(uint64_t));
+    if(profile->ip_counts == NULL || profile->ip_cycles == NULL) {
+        profile_destroy(&profile);
+        return NULL;
+    }
+
+    return profile;
+}
+
+/**
+======================================================================================================
+    @brief      Prints profile report and writes profile file.
+
+    @details    Report contains commands sorted by cycles, with separate lines for
+                every argument type, and the hottest instruction pointers.
+                File is CSV with the same counters for every command byte and
+                every executed instruction pointer.
+
+    @param [in] profile             Profile.
+    @param [in] code                Code of SPU.
+
+======================================================================================================
+*/
+void profile_report(spu_profile_t   *profile,
+                    const command_t *code) {
+    C_ASSERT(profile != NULL, return );
+    C_ASSERT(code    != NULL, return );
+
+    uint64_t total_count  = 0;
+    uint64_t total_cycles = 0;
+    for(size_t command = 0; command < profile_command_values; command++) {
+        total_count  += profile->command_counts[command];
+        total_cycles += profile->command_cycles[command];
+    }
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Profile: %llu commands, %llu cycles.\r\n",
+                 total_count,
+                 total_cycles);
+    print_commands(profile, total_count, total_cycles);
+    print_hot_ips (profile, code, total_cycles);
+    write_profile_file(profile, code);
+}
+
+/**
+======================================================================================================
+    @brief      Frees profile and sets pointer to NULL.
+
+======================================================================================================
+*/
+void profile_destroy(spu_profile_t **profile) {
+    C_ASSERT(profile != NULL, return );
+    if(*profile == NULL)
+        return ;
+
+    _free((*profile)->ip_counts);
+    _free((*profile)->ip_cycles);
+    _free(*profile);
+    *profile = NULL;
+}
+
+/**
+======================================================================================================
+    @brief      Prints commands sorted by cycles.
+
+======================================================================================================
+*/
+void print_commands(spu_profile_t *profile,
+                    uint64_t       total_count,
+                    uint64_t       total_cycles) {
+    profile_line_t lines[profile_command_values] = {};
+    size_t         lines_number                  = 0;
+    for(size_t command = 0; command < profile_command_values; command++) {
+        if(profile->command_counts[command] == 0)
+            continue;
+
+        lines[lines_number++] = {.key    = command,
+                                 .count  = profile->command_counts[command],
+                                 .cycles = profile->command_cycles[command]};
+    }
+    qsort(lines, lines_number, sizeof(profile_line_t), compare_lines);
+
+    printf("command  arguments             count  count %%            cycles cycles %%  cycles/cmd\r\n");
+    for(size_t index = 0; index < lines_number; index++) {
+        command_t command = (command_t)lines[index].key;
+        printf("%-8s %-11s %15llu %7.2f%% %17llu %7.2f%% %11.1f\r\n",
+               spu_command_name(command),
+               arguments_name  (command),
+               lines[index].count,
+               100.0 * (double)lines[index].count  / (double)total_count,
+               lines[index].cycles,
+               100.0 * (double)lines[index].cycles / (double)(total_cycles == 0 ? 1 : total_cycles),
+               (double)lines[index].cycles / (double)lines[index].count);
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Prints the hottest instruction pointers sorted by cycles.
+
+======================================================================================================
+*/
+void print_hot_ips(spu_profile_t   *profile,
+                   const command_t *code,
+                   uint64_t         total_cycles) {
+    profile_line_t hot_ips[profile_hot_ips_number + 1] = {};
+    size_t         hot_ips_number                      = 0;
+
+    //insertion to small sorted array, the last element is thrown away
+    for(address_t ip = 0; ip < profile->code_size; ip++) {
+        if(profile->ip_counts[ip] == 0)
+            continue;
+
+        size_t position = hot_ips_number;
+        while(position > 0 && hot_ips[position - 1].cycles < profile->ip_cycles[ip]) {
+            hot_ips[position] = hot_ips[position - 1];
+            position--;
+        }
+        hot_ips[position] = {.key    = ip,
+                             .count  = profile->ip_counts[ip],
+                             .cycles = profile->ip_cycles[ip]};
+
+        if(hot_ips_number < profile_hot_ips_number)
+            hot_ips_number++;
+    }
+
+    printf("\r\nhot ip   command  arguments             count            cycles cycles %%\r\n");
+    for(size_t index = 0; index < hot_ips_number; index++) {
+        command_t command = code[hot_ips[index].key];
+        printf("0x%-6llx %-8s %-11s %15llu %17llu %7.2f%%\r\n",
+               hot_ips[index].key,
+               spu_command_name(command),
+               arguments_name  (command),
+               hot_ips[index].count,
+               hot_ips[index].cycles,
+               100.0 * (double)hot_ips[index].cycles / (double)(total_cycles == 0 ? 1 : total_cycles));
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Writes profile to CSV file.
+
+    @details    Every line is 'kind,key,command,arguments,count,cycles', where kind is
+                'command' (key is command byte) or 'ip' (key is instruction pointer).
+
+======================================================================================================
+*/
+void write_profile_file(spu_profile_t   *profile,
+                        const command_t *code) {
+    FILE *profile_file = fopen(profile->filename, "wb");
+    if(profile_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening profile file '%s'.\r\n",
+                     profile->filename);
+        return ;
+    }
+
+    fprintf(profile_file, "kind,key,command,arguments,count,cycles\n");
+    for(size_t command = 0; command < profile_command_values; command++) {
+        if(profile->command_counts[command] == 0)
+            continue;
+
+        fprintf(profile_file, "command,%zu,%s,%s,%llu,%llu\n",
+                command,
+                spu_command_name((command_t)command),
+                arguments_name  ((command_t)command),
+                profile->command_counts[command],
+                profile->command_cycles[command]);
+    }
+
+    for(address_t ip = 0; ip < profile->code_size; ip++) {
+        if(profile->ip_counts[ip] == 0)
+            continue;
+
+        fprintf(profile_file, "ip,%llu,%s,%s,%llu,%llu\n",
+                ip,
+                spu_command_name(code[ip]),
+                arguments_name  (code[ip]),
+                profile->ip_counts[ip],
+                profile->ip_cycles[ip]);
+    }
+
+    fclose(profile_file);
+}
+
+/**
+======================================================================================================
+    @brief      Returns name of argument type by command byte.
+
+======================================================================================================
+*/
+const char *arguments_name(command_t command) {
+    bool is_memory   = command & random_access_memory_mask;
+    bool is_constant = command & immediate_constant_mask;
+    bool is_register = command & register_parameter_mask;
+
+    if(is_memory) {
+        if(is_constant && is_register)
+            return "[imm+reg]";
+        if(is_constant)
+            return "[imm]";
+        if(is_register)
+            return "[reg]";
+        return "[]";
+    }
+
+    if(is_constant && is_register)
+        return "imm+reg";
+    if(is_constant)
+        return "imm";
+    if(is_register)
+        return "reg";
+    return "-";
+}
+
+/**
+======================================================================================================
+    @brief      Compares lines of report by cycles in descending order.
+
+======================================================================================================
+*/
+int compare_lines(const void *first,
+                  const void *second) {
+    const profile_line_t *first_line  = (const profile_line_t *)first;
+    const profile_line_t *second_line = (const profile_line_t *)second;
+    if(first_line->cycles != second_line->cycles)
+        return first_line->cycles < second_line->cycles ? 1 : -1;
+
+    return first_line->key < second_line->key ? -1 : first_line->key > second_line->key;
+}
+
+#endif
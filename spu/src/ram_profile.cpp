@@ -0,0 +1,429 @@
+#ifdef SPU_PROFILE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "ram_profile.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "pages.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief      Initializing size of windows array.
+
+======================================================================================================
+*/
+static const size_t    ram_profile_windows_init_size = 64;
+
+/**
+======================================================================================================
+    @brief      Number of cells in one row of heatmap.
+
+======================================================================================================
+*/
+static const address_t ram_profile_image_width       = 128;
+
+/**
+======================================================================================================
+    @brief      Maximum number of cells in heatmap, cells after them are only in CSV.
+
+======================================================================================================
+*/
+static const address_t ram_profile_image_cells       = 1 << 20;
+
+/**
+======================================================================================================
+    @brief      Size of square of pixels which is drawn for one cell.
+
+======================================================================================================
+*/
+static const size_t    ram_profile_pixel_size        = 4;
+
+/**
+======================================================================================================
+    @brief      Maximum length of names of profile files.
+
+======================================================================================================
+*/
+static const size_t    ram_profile_filename_size     = 256;
+
+/**
+======================================================================================================
+    @brief      Accesses of one window of commands.
+
+======================================================================================================
+*/
+struct ram_window_t {
+    uint64_t first_command;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t working_set;
+};
+
+/**
+======================================================================================================
+    @brief      RAM profiler.
+
+    @details    Counters of cells are mapped as pages, so only pages of counters
+                of touched cells take memory, like RAM itself.
+                Last window of cell is window index + 1, cell is added to
+                working set of window when it is touched for the first time in window.
+
+======================================================================================================
+*/
+struct spu_ram_profile_t {
+    const char   *name;
+    address_t     ram_size;
+    size_t        counters_size;
+    uint64_t     *reads;
+    uint64_t     *writes;
+    uint64_t     *last_windows;
+    uint64_t      out_of_ram;
+    uint64_t      window_size;
+    ram_window_t  window;
+    ram_window_t *windows;
+    size_t        windows_number;
+    size_t        windows_size;
+    bool          is_failed;
+};
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static void        close_window      (spu_ram_profile_t *ram_profile);
+static bool        check_windows_size(spu_ram_profile_t *ram_profile);
+static void        write_csv         (spu_ram_profile_t *ram_profile);
+static void        write_heatmap     (spu_ram_profile_t *ram_profile);
+static uint8_t     heat_value        (uint64_t           count,
+                                      double             log_max);
+
+/**
+======================================================================================================
+    @brief      Creates RAM profiler.
+
+    @param [in] name                Name of profile files without extension.
+    @param [in] ram_size            Number of RAM cells.
+    @param [in] window_size         Number of commands in working set window.
+
+    @return Profiler or NULL if it was not allocated.
+
+======================================================================================================
+*/
+spu_ram_profile_t *ram_profile_create(const char *name,
+                                      address_t   ram_size,
+                                      uint64_t    window_size) {
+    C_ASSERT(name        != NULL, return NULL);
+    C_ASSERT(window_size != 0   , return NULL);
+
+    if(ram_size > SIZE_MAX / sizeof(uint64_t))
+        return NULL;
+
+    spu_ram_profile_t *ram_profile = (spu_ram_profile_t *)_calloc(1, sizeof(spu_ram_profile_t));
+    if(ram_profile == NULL)
+        return NULL;
+
+    ram_profile->name          = name;
+    ram_profile->ram_size      = ram_size;
+    ram_profile->window_size   = window_size;
+    ram_profile->counters_size = ram_size * sizeof(uint64_t);
+    ram_profile->reads         = (uint64_t     *)pages_map(ram_profile->counters_size, PAGES_READ_WRITE);
+    ram_profile->writes        = (uint64_t     *)pages_map(ram_profile->counters_size, PAGES_READ_WRITE);
+    ram_profile->last_windows  = (uint64_t     *)pages_map(ram_profile->counters_size, PAGES_READ_WRITE);
+    ram_profile->windows       = (ram_window_t *)_calloc(ram_profile_windows_init_size,
+                                                         sizeof(ram_window_t));
+    ram_profile->windows_size  = ram_profile_windows_init_size;
+    if(ram_profile->reads        == NULL ||
+       ram_profile->writes       == NULL ||
+       ram_profile->last_windows == NULL ||
+       ram_profile->windows      == NULL) {
+        ram_profile_destroy(&ram_profile);
+        return NULL;
+    }
+
+    return ram_profile;
+}
+
+/**
+======================================================================================================
+    @brief      Counts access to RAM cell.
+
+    @details    Cells out of RAM are counted together, SPU accesses them only
+                when RAM is not protected.
+
+    @param [in] ram_profile         Profiler.
+    @param [in] cell                Index of cell.
+    @param [in] is_write            true for pop, false for push.
+    @param [in] commands_number     Number of commands which SPU has run.
+
+======================================================================================================
+*/
+void ram_profile_add(spu_ram_profile_t *ram_profile,
+                     address_t          cell,
+                     bool               is_write,
+                     uint64_t           commands_number) {
+    if(cell >= ram_profile->ram_size) {
+        ram_profile->out_of_ram++;
+        return ;
+    }
+
+    uint64_t first_command = commands_number / ram_profile->window_size * ram_profile->window_size;
+    if(first_command != ram_profile->window.first_command) {
+        close_window(ram_profile);
+        ram_profile->window.first_command = first_command;
+    }
+
+    uint64_t window_index = first_command / ram_profile->window_size + 1;
+    if(ram_profile->last_windows[cell] != window_index) {
+        ram_profile->last_windows[cell] = window_index;
+        ram_profile->window.working_set++;
+    }
+
+    if(is_write) {
+        ram_profile->writes[cell]++;
+        ram_profile->window.writes++;
+    }
+    else {
+        ram_profile->reads[cell]++;
+        ram_profile->window.reads++;
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Prints summary and writes CSV and heatmap.
+
+======================================================================================================
+*/
+void ram_profile_report(spu_ram_profile_t *ram_profile) {
+    C_ASSERT(ram_profile != NULL, return );
+
+    close_window(ram_profile);
+    if(ram_profile->is_failed) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating memory to RAM profile, it is not written.\r\n");
+        return ;
+    }
+
+    uint64_t reads         = 0;
+    uint64_t writes        = 0;
+    uint64_t max_set       = 0;
+    for(size_t window = 0; window < ram_profile->windows_number; window++) {
+        reads  += ram_profile->windows[window].reads;
+        writes += ram_profile->windows[window].writes;
+        if(max_set < ram_profile->windows[window].working_set)
+            max_set = ram_profile->windows[window].working_set;
+    }
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "RAM profile: %llu reads, %llu writes, %llu accesses out of RAM,\r\n"
+                 "maximum working set is %llu cells in %llu commands.\r\n",
+                 reads,
+                 writes,
+                 ram_profile->out_of_ram,
+                 max_set,
+                 ram_profile->window_size);
+
+    write_csv    (ram_profile);
+    write_heatmap(ram_profile);
+}
+
+/**
+======================================================================================================
+    @brief      Unmaps counters, frees RAM profiler and sets pointer to NULL.
+
+======================================================================================================
+*/
+void ram_profile_destroy(spu_ram_profile_t **ram_profile) {
+    C_ASSERT(ram_profile != NULL, return );
+    if(*ram_profile == NULL)
+        return ;
+
+    if((*ram_profile)->reads != NULL)
+        pages_unmap((*ram_profile)->reads,        (*ram_profile)->counters_size);
+    if((*ram_profile)->writes != NULL)
+        pages_unmap((*ram_profile)->writes,       (*ram_profile)->counters_size);
+    if((*ram_profile)->last_windows != NULL)
+        pages_unmap((*ram_profile)->last_windows, (*ram_profile)->counters_size);
+
+    _free((*ram_profile)->windows);
+    _free(*ram_profile);
+    *ram_profile = NULL;
+}
+
+/**
+======================================================================================================
+    @brief      Adds current window to windows array if it has accesses.
+
+======================================================================================================
+*/
+void close_window(spu_ram_profile_t *ram_profile) {
+    if(ram_profile->window.working_set == 0)
+        return ;
+
+    if(!check_windows_size(ram_profile)) {
+        ram_profile->is_failed = true;
+        return ;
+    }
+
+    ram_profile->windows[ram_profile->windows_number++] = ram_profile->window;
+    ram_profile->window = {};
+}
+
+/**
+======================================================================================================
+    @brief      Checks if size of windows array is sufficient.
+
+    @details    If number of windows is equal to size of array, it reallocates windows array.
+
+    @return false if array was not reallocated.
+
+======================================================================================================
+*/
+bool check_windows_size(spu_ram_profile_t *ram_profile) {
+    if(ram_profile->windows_number < ram_profile->windows_size)
+        return true;
+
+    ram_window_t *new_windows = (ram_window_t *)_recalloc(ram_profile->windows,
+                                                          ram_profile->windows_size,
+                                                          ram_profile->windows_size * 2,
+                                                          sizeof(ram_window_t));
+    if(new_windows == NULL)
+        return false;
+
+    ram_profile->windows       = new_windows;
+    ram_profile->windows_size *= 2;
+    return true;
+}
+
+/**
+======================================================================================================
+    @brief      Writes name.csv.
+
+    @details    Every line is 'kind,key,reads,writes,working_set', where kind is
+                'cell' (key is address of touched cell) or 'window' (key is the
+                first command of window, working set is number of different cells).
+
+======================================================================================================
+*/
+void write_csv(spu_ram_profile_t *ram_profile) {
+    char filename[ram_profile_filename_size] = {};
+    snprintf(filename, sizeof(filename), "%s.csv", ram_profile->name);
+
+    FILE *csv_file = fopen(filename, "wb");
+    if(csv_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening RAM profile file '%s'.\r\n",
+                     filename);
+        return ;
+    }
+
+    fprintf(csv_file, "kind,key,reads,writes,working_set\n");
+    for(address_t cell = 0; cell < ram_profile->ram_size; cell++) {
+        if(ram_profile->last_windows[cell] == 0)
+            continue;
+
+        fprintf(csv_file, "cell,%llu,%llu,%llu,\n",
+                cell,
+                ram_profile->reads [cell],
+                ram_profile->writes[cell]);
+    }
+
+    for(size_t index = 0; index < ram_profile->windows_number; index++) {
+        ram_window_t *window = ram_profile->windows + index;
+        fprintf(csv_file, "window,%llu,%llu,%llu,%llu\n",
+                window->first_command,
+                window->reads,
+                window->writes,
+                window->working_set);
+    }
+
+    fclose(csv_file);
+}
+
+/**
+======================================================================================================
+    @brief      Writes heatmap name.ppm.
+
+    @details    Cells are drawn row by row, ram_profile_image_width cells in a row.
+                Red is writes, green is reads, in logarithmic scale to maximum
+                count of all cells. Cold cells are black, cells after the end
+                of RAM are dark blue.
+
+======================================================================================================
+*/
+void write_heatmap(spu_ram_profile_t *ram_profile) {
+    char filename[ram_profile_filename_size] = {};
+    snprintf(filename, sizeof(filename), "%s.ppm", ram_profile->name);
+
+    FILE *image_file = fopen(filename, "wb");
+    if(image_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening heatmap file '%s'.\r\n",
+                     filename);
+        return ;
+    }
+
+    address_t cells   = ram_profile->ram_size < ram_profile_image_cells ? ram_profile->ram_size :
+                                                                          ram_profile_image_cells;
+    address_t rows    = (cells + ram_profile_image_width - 1) / ram_profile_image_width;
+    uint64_t  maximum = 0;
+    for(address_t cell = 0; cell < cells; cell++) {
+        if(ram_profile->last_windows[cell] == 0)
+            continue;
+
+        if(maximum < ram_profile->reads [cell])
+            maximum = ram_profile->reads [cell];
+        if(maximum < ram_profile->writes[cell])
+            maximum = ram_profile->writes[cell];
+    }
+
+    double log_max = log(1.0 + (double)maximum);
+    fprintf(image_file, "P6\n%llu %llu\n255\n",
+            ram_profile_image_width * ram_profile_pixel_size,
+            rows                    * ram_profile_pixel_size);
+
+    uint8_t line[ram_profile_image_width * ram_profile_pixel_size * 3] = {};
+    for(address_t row = 0; row < rows; row++) {
+        for(address_t column = 0; column < ram_profile_image_width; column++) {
+            address_t cell     = row * ram_profile_image_width + column;
+            uint8_t   pixel[3] = {0, 0, 0};
+            if(cell >= cells) {
+                pixel[2] = 64;
+            }
+            else if(ram_profile->last_windows[cell] != 0) {
+                pixel[0] = heat_value(ram_profile->writes[cell], log_max);
+                pixel[1] = heat_value(ram_profile->reads [cell], log_max);
+            }
+
+            for(size_t copy = 0; copy < ram_profile_pixel_size; copy++)
+                memcpy(line + (column * ram_profile_pixel_size + copy) * 3, pixel, 3);
+        }
+
+        for(size_t copy = 0; copy < ram_profile_pixel_size; copy++)
+            fwrite(line, 1, sizeof(line), image_file);
+    }
+
+    fclose(image_file);
+}
+
+/**
+======================================================================================================
+    @brief      Returns brightness of counter, touched cell is never completely dark.
+
+======================================================================================================
+*/
+uint8_t heat_value(uint64_t count,
+                   double   log_max) {
+    if(count == 0)
+        return 0;
+
+    return (uint8_t)(48 + 207 * log(1.0 + (double)count) / log_max);
+}
+
+#endif
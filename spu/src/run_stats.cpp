@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "run_stats.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "pages.h"
+#include "clocks.h"
+#include "stack.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief      Creates run statistics.
+
+    @details    Map of touched RAM cells is mapped once, its pages are committed
+                only when cells are touched.
+
+    @param [in] ram_size            Number of RAM cells.
+
+    @return Statistics or NULL if they were not allocated.
+
+======================================================================================================
+*/
+spu_run_stats_t *run_stats_create(address_t ram_size) {
+    spu_run_stats_t *stats = (spu_run_stats_t *)_calloc(1, sizeof(spu_run_stats_t));
+    if(stats == NULL)
+        return NULL;
+
+    stats->ram_size      = ram_size;
+    stats->mapping_size  = pages_round_up(ram_size + 1);
+    stats->touched_cells = (uint8_t *)pages_map(stats->mapping_size, PAGES_READ_WRITE);
+    if(stats->touched_cells == NULL) {
+        run_stats_destroy(&stats);
+        return NULL;
+    }
+
+    return stats;
+}
+
+/**
+======================================================================================================
+    @brief      Remembers wall and processor time when program starts running.
+
+======================================================================================================
+*/
+void run_stats_start(spu_run_stats_t *stats) {
+    C_ASSERT(stats != NULL, return );
+
+    stats->start_wall_time = clocks_wall_ns();
+    stats->start_cpu_time  = clocks_cpu_ns ();
+}
+
+/**
+======================================================================================================
+    @brief      Prints run statistics.
+
+    @param [in] stats               Statistics.
+    @param [in] commands_number     Number of run commands.
+    @param [in] stack               Value stack of SPU.
+    @param [in] max_call_depth      Maximum size of call stack.
+
+======================================================================================================
+*/
+void run_stats_report(spu_run_stats_t *stats,
+                      uint64_t         commands_number,
+                      const stack_t   *stack,
+                      address_t        max_call_depth) {
+    C_ASSERT(stats != NULL, return );
+    C_ASSERT(stack != NULL, return );
+
+    double wall_time = (double)(clocks_wall_ns() - stats->start_wall_time) / 1000000;
+    double cpu_time  = (double)(clocks_cpu_ns () - stats->start_cpu_time ) / 1000000;
+    double io_time   = (double)stats->io_time / 1000000;
+
+    stack_stats_t stack_stats = {};
+    stack_get_stats(stack, &stack_stats);
+
+    address_t touched_cells = 0;
+    for(address_t cell = 0; cell < stats->ram_size; cell++)
+        touched_cells += stats->touched_cells[cell];
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Run statistics:\r\n");
+    printf("instructions retired   %15llu\r\n"
+           "wall time              %15.3f ms\r\n"
+           "CPU time               %15.3f ms\r\n"
+           "MIPS                   %15.2f\r\n"
+           "peak value stack depth %15zu\r\n"
+           "max call depth         %15llu\r\n"
+           "RAM cells touched      %15llu of %llu\r\n"
+           "time in I/O handlers   %15.3f ms (%.2f%%)\r\n",
+           commands_number,
+           wall_time,
+           cpu_time,
+           (double)commands_number / (wall_time <= 0 ? 1 : wall_time * 1000),
+           stack_stats.peak_size,
+           max_call_depth,
+           touched_cells,
+           stats->ram_size,
+           io_time,
+           100 * io_time / (wall_time <= 0 ? 1 : wall_time));
+}
+
+/**
+======================================================================================================
+    @brief      Frees statistics and sets pointer to NULL.
+
+======================================================================================================
+*/
+void run_stats_destroy(spu_run_stats_t **stats) {
+    C_ASSERT(stats != NULL, return );
+    if(*stats == NULL)
+        return ;
+
+    if((*stats)->touched_cells != NULL)
+        pages_unmap((*stats)->touched_cells, (*stats)->mapping_size);
+
+    _free(*stats);
+    *stats = NULL;
+}
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "sampler.h"
+#include "symbols.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "sample_timer.h"
+#include "spu_commands.h"
+#include "spu_facilities.h"
+
+/**
+======================================================================================================
+    @brief      Maximum number of frames in one sample, deeper stacks keep the innermost frames.
+
+======================================================================================================
+*/
+static const size_t    sampler_max_frames  = 64;
+
+/**
+======================================================================================================
+    @brief      Number of unique stacks, samples with new stacks are lost when table is full.
+
+======================================================================================================
+*/
+static const size_t    sampler_table_size  = 4096;
+
+/**
+======================================================================================================
+    @brief      Maximum number of probes in stacks table.
+
+======================================================================================================
+*/
+static const size_t    sampler_max_probes  = 64;
+
+/**
+======================================================================================================
+    @brief      Frame which replaces outer frames of too deep stack.
+
+======================================================================================================
+*/
+static const address_t sampler_deep_frame  = ~(address_t)0;
+
+/**
+======================================================================================================
+    @brief      Unique stack and number of its samples.
+
+    @details    Frames are entry addresses of functions from the outermost one,
+                program entry is the first frame.
+
+======================================================================================================
+*/
+struct sample_stack_t {
+    uint64_t  hash;
+    uint64_t  count;
+    size_t    frames_number;
+    address_t frames[sampler_max_frames];
+};
+
+/**
+======================================================================================================
+    @brief      Sampler structure.
+
+    @details    Stacks table is allocated before timer is started, so sample is
+                taken without allocations in timer callback.
+
+======================================================================================================
+*/
+struct spu_sampler_t {
+    const spu_t    *spu;
+    sample_stack_t *stacks;
+    size_t          stacks_number;
+    uint64_t        samples_number;
+    uint64_t        lost_samples;
+};
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static void        take_sample      (void                 *context);
+static size_t      collect_frames   (const spu_t          *spu,
+                                     address_t            *frames);
+static void        add_stack        (spu_sampler_t        *sampler,
+                                     const address_t      *frames,
+                                     size_t                frames_number);
+static void        write_folded     (spu_sampler_t        *sampler,
+                                     const char           *filename);
+
+/**
+======================================================================================================
+    @brief      Starts sampling of SPU.
+
+    @details    Allocates stacks table and starts sample timer with frequency
+                '--sample-rate'. Only one SPU can be sampled at a time.
+
+    @param [in] spu                 SPU structure
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t sampler_start(spu_t *spu) {
+    C_ASSERT(spu                        != NULL, return SPU_NULL_POINTER);
+    C_ASSERT(spu->flags.sample_filename != NULL, return SPU_FLAGS_ERROR );
+
+    spu_sampler_t *sampler = (spu_sampler_t *)_calloc(1, sizeof(spu_sampler_t));
+    if(sampler == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating sampler.\r\n");
+        return SPU_MEMORY_ERROR;
+    }
+
+    sampler->spu    = spu;
+    sampler->stacks = (sample_stack_t *)_calloc(sampler_table_size, sizeof(sample_stack_t));
+    if(sampler->stacks == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating sampler.\r\n");
+        _free(sampler);
+        return SPU_MEMORY_ERROR;
+    }
+
+    if(sample_timer_start(spu->flags.sample_rate,
+                          take_sample,
+                          sampler) != SAMPLE_TIMER_SUCCESS) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while starting sampling timer.\r\n");
+        _free(sampler->stacks);
+        _free(sampler);
+        return SPU_SAMPLER_ERROR;
+    }
+
+    spu->sampler = sampler;
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Stops sampling of SPU and writes folded stacks.
+
+    @details    Every line of file is 'frame;frame;frame count', frames are names of
+                symbols if binary was assembled with '-g', otherwise addresses.
+
+    @param [in] spu                 SPU structure
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t sampler_stop(spu_t *spu) {
+    C_ASSERT(spu != NULL, return SPU_NULL_POINTER);
+    if(spu->sampler == NULL)
+        return SPU_SUCCESS;
+
+    spu_sampler_t *sampler = spu->sampler;
+    sample_timer_stop();
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Sampler: %llu samples, %zu stacks, %llu lost samples.\r\n",
+                 sampler->samples_number,
+                 sampler->stacks_number,
+                 sampler->lost_samples);
+    write_folded(sampler, spu->flags.sample_filename);
+
+    _free(sampler->stacks);
+    _free(sampler);
+    spu->sampler = NULL;
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Takes one sample of SPU call stack.
+
+    @details    It is called by sample timer while SPU is interrupted, so it
+                only reads SPU and writes preallocated stacks table.
+
+======================================================================================================
+*/
+void take_sample(void *context) {
+    spu_sampler_t *sampler = (spu_sampler_t *)context;
+
+    address_t frames[sampler_max_frames] = {};
+    size_t    frames_number              = collect_frames(sampler->spu, frames);
+
+    sampler->samples_number++;
+    add_stack(sampler, frames, frames_number);
+}
+
+/**
+======================================================================================================
+    @brief      Collects entry addresses of functions on call stack.
+
+    @details    Entry of function is the argument of call command, which is
+                right before return address. If stack is deeper than
+                sampler_max_frames, outer frames are replaced with sampler_deep_frame.
+
+    @return Number of frames
+
+======================================================================================================
+*/
+size_t collect_frames(const spu_t *spu,
+                      address_t   *frames) {
+    address_t call_stack_size = spu->call_stack_size;
+    if(call_stack_size > spu->call_stack_capacity)
+        call_stack_size = spu->call_stack_capacity;
+
+    size_t    frames_number = 0;
+    address_t first_call    = 0;
+    if(call_stack_size + 1 > sampler_max_frames) {
+        frames[frames_number++] = sampler_deep_frame;
+        first_call              = call_stack_size + 1 - sampler_max_frames;
+    }
+    else {
+        frames[frames_number++] = 0;
+    }
+
+    for(address_t call = first_call; call < call_stack_size; call++) {
+        address_t return_address = spu->call_stack[call];
+        address_t function       = sampler_deep_frame;
+        if(return_address >= sizeof(address_t) && return_address <= spu->code_size)
+            memcpy(&function, spu->code + return_address - sizeof(address_t), sizeof(address_t));
+
+        frames[frames_number++] = function;
+    }
+
+    return frames_number;
+}
+
+/**
+======================================================================================================
+    @brief      Counts sample in stacks table.
+
+    @details    Table uses open addressing with linear probing. Sample is lost
+                if its stack is new and there is no free entry near its hash.
+
+======================================================================================================
+*/
+void add_stack(spu_sampler_t   *sampler,
+               const address_t *frames,
+               size_t           frames_number) {
+    //FNV-1a over frames
+    uint64_t hash = 0xcbf29ce484222325;
+    for(size_t frame = 0; frame < frames_number; frame++)
+        hash = (hash ^ frames[frame]) * 0x100000001b3;
+
+    for(size_t probe = 0; probe < sampler_max_probes; probe++) {
+        sample_stack_t *stack = sampler->stacks + (hash + probe) % sampler_table_size;
+        if(stack->count == 0) {
+            stack->hash          = hash;
+            stack->count         = 1;
+            stack->frames_number = frames_number;
+            memcpy(stack->frames, frames, frames_number * sizeof(address_t));
+            sampler->stacks_number++;
+            return ;
+        }
+
+        if(stack->hash          == hash          &&
+           stack->frames_number == frames_number &&
+           memcmp(stack->frames, frames, frames_number * sizeof(address_t)) == 0) {
+            stack->count++;
+            return ;
+        }
+    }
+
+    sampler->lost_samples++;
+}
+
+/**
+======================================================================================================
+    @brief      Writes stacks table in folded format.
+
+======================================================================================================
+*/
+void write_folded(spu_sampler_t *sampler,
+                  const char    *filename) {
+    FILE *folded_file = fopen(filename, "wb");
+    if(folded_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening sample file '%s'.\r\n",
+                     filename);
+        return ;
+    }
+
+    const spu_t *spu = sampler->spu;
+    for(size_t index = 0; index < sampler_table_size; index++) {
+        sample_stack_t *stack = sampler->stacks + index;
+        if(stack->count == 0)
+            continue;
+
+        for(size_t frame = 0; frame < stack->frames_number; frame++) {
+            if(frame != 0)
+                fputc(';', folded_file);
+
+            if(stack->frames[frame] == sampler_deep_frame)
+                fputs("[deep]", folded_file);
+            else if(frame == 0 && symbols_find(spu->symbols, spu->symbols_number, 0) == NULL)
+                fputs("[entry]", folded_file);
+            else
+                symbols_print(folded_file,
+                              spu->symbols,
+                              spu->symbols_number,
+                              stack->frames[frame]);
+        }
+        fprintf(folded_file, " %llu\n", stack->count);
+    }
+
+    fclose(folded_file);
+}
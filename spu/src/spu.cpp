@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "custom_assert.h"
 #include "utils.h"
@@ -9,30 +10,109 @@
 #include "spu_commands.h"
 #include "spu_facilities.h"
 #include "memory.h"
+#include "pages.h"
+#include "sampler.h"
+#include "symbols.h"
+#include "clocks.h"
 
 /**
 ======================================================================================================
-     @brief     Initializing size of stack
+     @brief     Capacity of value stack and call stack if neither '--stack-size'
+                nor binary header sets it
 
 ======================================================================================================
 */
-static const size_t stack_init_size = 16;
+static const size_t default_stack_size   = 4096;
+
+/**
+======================================================================================================
+     @brief     Frequency of samples in Hz if '--sample-rate' is not set
+
+======================================================================================================
+*/
+static const size_t default_sample_rate  = 1000;
+
+/**
+======================================================================================================
+     @brief     Number of commands in working set window if '--ram-window' is not set
+
+======================================================================================================
+*/
+static const size_t default_ram_window   = 10000;
+
+/**
+======================================================================================================
+     @brief     Maximum number of trace events if '--trace-events' is not set
+
+======================================================================================================
+*/
+static const size_t default_trace_events = 1 << 20;
+
+/**
+======================================================================================================
+     @brief     Number of commands between checks of '--timeout'
+
+======================================================================================================
+*/
+static const uint64_t timeout_check_period = 1 << 16;
+
+/**
+======================================================================================================
+     @brief     Number of cells in address space of protected RAM, RAM addresses
+                are masked with it, so it must be power of two
+
+======================================================================================================
+*/
+static const address_t protected_ram_cells = (address_t)1 << 32;
 
 //====================================================================================================
 //FUNCTIONS PROTOTYPES
 //====================================================================================================
-static spu_error_t init_spu_code    (spu_t      *spu,
-                                     const char *file_name);
-static spu_error_t run_spu_code     (spu_t      *spu);
-static spu_error_t destroy_spu_code (spu_t      *spu);
-static spu_error_t run_command      (spu_t      *spu);
-static spu_error_t read_file_header (spu_t      *spu,
-                                     FILE       *code_file,
-                                     const char *file_name);
-static spu_error_t read_file_code   (spu_t      *spu,
-                                     FILE       *code_file,
-                                     const char *file_name);
-static spu_error_t validate_commands(void);
+static spu_error_t          parse_flags      (spu_flags_t       *flags,
+                                              int                argc,
+                                              const char        *argv[]);
+static spu_error_t          parse_size_flag  (size_t            *size,
+                                              int               *arg,
+                                              int                argc,
+                                              const char        *argv[]);
+static spu_error_t          init_spu_code    (spu_t            **spu,
+                                              const spu_flags_t *flags);
+static spu_t               *create_spu       (const spu_flags_t *flags,
+                                              address_t          code_size,
+                                              address_t          ram_size,
+                                              size_t             stack_size,
+                                              uint64_t           symbols_number);
+static spu_error_t          map_spu_ram      (spu_t             *spu);
+static spu_error_t          map_protected_ram(spu_t             *spu);
+static address_t            ram_file_size    (const char        *file_name);
+static pages_fault_action_t handle_ram_fault (void              *fault_address,
+                                              void              *context);
+static spu_error_t          stop_spu         (spu_t             *spu,
+                                              spu_error_t        error_code);
+static size_t               align_to_region  (size_t             size);
+static void                 count_spu_region (const spu_t       *spu,
+                                              void             (*count)(memory_tag_t, size_t));
+static void                 free_spu_region  (spu_t             *spu);
+static spu_error_t          run_spu_code     (spu_t             *spu);
+static spu_error_t          destroy_spu_code (spu_t            **spu);
+static spu_error_t          run_command      (spu_t             *spu);
+static spu_error_t          check_limits     (spu_t             *spu);
+static bool                 is_io_command    (command_t          operation_code);
+static spu_error_t          read_file_header (program_header_t  *header,
+                                              FILE              *code_file,
+                                              const char        *file_name);
+static spu_error_t          read_file_code   (spu_t             *spu,
+                                              FILE              *code_file,
+                                              const char        *file_name);
+static spu_error_t          read_file_data   (spu_t             *spu,
+                                              FILE              *code_file,
+                                              const char        *file_name,
+                                              uint64_t           data_size,
+                                              bool               is_ram_kept);
+static spu_error_t          read_file_symbols(spu_t             *spu,
+                                              FILE              *code_file,
+                                              const char        *file_name);
+static spu_error_t          validate_commands(void);
 
 /**
 ======================================================================================================
@@ -51,17 +131,39 @@ int main(int argc, const char *argv[]) {
     if(validate_commands() != SPU_SUCCESS)
         return SPU_COMMANDS_ERROR;
 
-    spu_t spu = {};
-    if(argc != 2) {
-        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                     "SPU expected to have name of binary as parameter.\r\n");
+    spu_flags_t flags = {.code_filename      = NULL,
+                         .ram_filename       = NULL,
+                         .profile_filename   = NULL,
+                         .callgraph_filename = NULL,
+                         .branches_filename  = NULL,
+                         .ram_profile_name   = NULL,
+                         .ram_window         = default_ram_window,
+                         .coverage_filename  = NULL,
+                         .trace_filename     = NULL,
+                         .trace_events       = default_trace_events,
+                         .max_instructions   = 0,
+                         .timeout            = 0,
+                         .sample_filename    = NULL,
+                         .sample_rate        = default_sample_rate,
+                         .stack_size         = 0,
+                         .ram_size           = 0,
+                         .huge_pages         = false,
+                         .protected_ram      = false,
+                         .print_memory_stats = false,
+                         .print_run_stats    = false};
+    if(parse_flags     (&flags,
+                        argc,
+                        argv)    != SPU_SUCCESS)
         return EXIT_FAILURE;
-    }
+
+    spu_t *spu = NULL;
     if(init_spu_code   (&spu,
-                        argv[1]) != SPU_SUCCESS)
+                        &flags)  != SPU_SUCCESS) {
+        destroy_spu_code(&spu);
         return EXIT_FAILURE;
+    }
 
-    if(run_spu_code    (&spu)    != SPU_SUCCESS)
+    if(run_spu_code    (spu)     != SPU_SUCCESS)
         return EXIT_FAILURE;
 
     if(destroy_spu_code(&spu)    != SPU_SUCCESS)
@@ -72,74 +174,716 @@ int main(int argc, const char *argv[]) {
 
 /**
 ======================================================================================================
-    @brief      Initializes code structure
+    @brief      Parses flags from command line
+
+    @details    run 'binary' [--stack-size N] [--ram-size N] [--ram-file 'file'] [--huge-pages]
+                    [--protected-ram] [--profile 'file'] [--callgraph 'file']
+                    [--branch-profile 'file'] [--ram-profile 'name'] [--ram-window N]
+                    [--coverage 'file'] [--trace 'file'] [--trace-events N]
+                    [--sample 'file'] [--sample-rate N] [--stats] [--max-instructions N]
+                    [--timeout N] [--mem-stats]
+                '--stack-size' sets capacity of value stack and call stack instead of
+                size from binary header
+                '--ram-size' sets number of RAM cells instead of size from binary header
+                '--ram-file' maps RAM to file, so RAM is kept between runs, RAM
+                initializer is copied only to new file
+                '--huge-pages' advises system to back RAM with transparent huge pages
+                '--protected-ram' stops SPU with error on access out of RAM, RAM size
+                is rounded up to the whole number of pages and RAM addresses are
+                32-bit: they are masked with 2^32 - 1
+                '--profile' prints profile of commands at exit and writes it to file,
+                SPU must be built with SPU_PROFILE
+                '--callgraph' prints costs of functions at exit and writes them to
+                callgrind file, SPU must be built with SPU_PROFILE
+                '--branch-profile' prints conditional jumps at exit and writes them
+                to file which is read by 'asm --branch-profile', SPU must be built
+                with SPU_PROFILE
+                '--ram-profile' writes reads and writes of RAM cells and working sets
+                to 'name.csv' and heatmap to 'name.ppm', SPU must be built with SPU_PROFILE
+                '--ram-window' sets number of commands in working set window, SPU must
+                be built with SPU_PROFILE
+                '--coverage' merges offsets of run commands to file which is read
+                by 'asm --coverage', SPU must be built with SPU_PROFILE
+                '--trace' writes timeline of calls and input/output in Chrome
+                trace-event JSON, SPU must be built with SPU_PROFILE
+                '--trace-events' sets maximum number of events in trace, SPU must be
+                built with SPU_PROFILE
+                '--sample' samples SPU call stack and writes folded stacks to file
+                '--sample-rate' sets frequency of samples in Hz
+                '--stats' prints run statistics when SPU is destroyed
+                '--max-instructions' stops SPU with dump after N commands
+                '--timeout' stops SPU with dump after N seconds, it is checked every
+                timeout_check_period commands, so it can not stop waiting for input
+                '--mem-stats' prints memory statistics when SPU is destroyed
+
+    @param [in] flags               Flags structure
+    @param [in] argc                Number of arguments from command line
+    @param [in] argv                Arguments from command line
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t parse_flags(spu_flags_t *flags,
+                        int          argc,
+                        const char  *argv[]) {
+    C_ASSERT(flags != NULL, return SPU_NULL_POINTER);
+    C_ASSERT(argv  != NULL, return SPU_NULL_POINTER);
+
+    for(int arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "--mem-stats") == 0) {
+            flags->print_memory_stats = true;
+        }
+        else if(strcmp(argv[arg], "--stats") == 0) {
+            flags->print_run_stats = true;
+        }
+        else if(strcmp(argv[arg], "--max-instructions") == 0) {
+            if(parse_size_flag(&flags->max_instructions, &arg, argc, argv) != SPU_SUCCESS)
+                return SPU_FLAGS_ERROR;
+        }
+        else if(strcmp(argv[arg], "--timeout") == 0) {
+            if(parse_size_flag(&flags->timeout, &arg, argc, argv) != SPU_SUCCESS)
+                return SPU_FLAGS_ERROR;
+        }
+        else if(strcmp(argv[arg], "--huge-pages") == 0) {
+            flags->huge_pages = true;
+        }
+        else if(strcmp(argv[arg], "--protected-ram") == 0) {
+            flags->protected_ram = true;
+        }
+        else if(strcmp(argv[arg], "--stack-size") == 0) {
+            if(parse_size_flag(&flags->stack_size, &arg, argc, argv) != SPU_SUCCESS)
+                return SPU_FLAGS_ERROR;
+        }
+        else if(strcmp(argv[arg], "--ram-size") == 0) {
+            if(parse_size_flag(&flags->ram_size,   &arg, argc, argv) != SPU_SUCCESS)
+                return SPU_FLAGS_ERROR;
+        }
+        else if(strcmp(argv[arg], "--sample-rate") == 0) {
+            if(parse_size_flag(&flags->sample_rate, &arg, argc, argv) != SPU_SUCCESS)
+                return SPU_FLAGS_ERROR;
+        }
+        else if(strcmp(argv[arg], "--sample") == 0 && arg + 1 < argc) {
+            flags->sample_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "--ram-file") == 0 && arg + 1 < argc) {
+            flags->ram_filename = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "--profile") == 0 && arg + 1 < argc) {
+            #ifdef SPU_PROFILE
+                flags->profile_filename = argv[++arg];
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--profile' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--callgraph") == 0 && arg + 1 < argc) {
+            #ifdef SPU_PROFILE
+                flags->callgraph_filename = argv[++arg];
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--callgraph' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--branch-profile") == 0 && arg + 1 < argc) {
+            #ifdef SPU_PROFILE
+                flags->branches_filename = argv[++arg];
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--branch-profile' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--ram-profile") == 0 && arg + 1 < argc) {
+            #ifdef SPU_PROFILE
+                flags->ram_profile_name = argv[++arg];
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--ram-profile' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--coverage") == 0 && arg + 1 < argc) {
+            #ifdef SPU_PROFILE
+                flags->coverage_filename = argv[++arg];
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--coverage' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--trace") == 0 && arg + 1 < argc) {
+            #ifdef SPU_PROFILE
+                flags->trace_filename = argv[++arg];
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--trace' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--trace-events") == 0) {
+            #ifdef SPU_PROFILE
+                if(parse_size_flag(&flags->trace_events, &arg, argc, argv) != SPU_SUCCESS)
+                    return SPU_FLAGS_ERROR;
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--trace-events' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(strcmp(argv[arg], "--ram-window") == 0) {
+            #ifdef SPU_PROFILE
+                if(parse_size_flag(&flags->ram_window, &arg, argc, argv) != SPU_SUCCESS)
+                    return SPU_FLAGS_ERROR;
+            #else
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "SPU was built without SPU_PROFILE, '--ram-window' is not supported.\r\n");
+                return SPU_FLAGS_ERROR;
+            #endif
+        }
+        else if(argv[arg][0] == '-' || flags->code_filename != NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Unexpected flag '%s'.\r\n",
+                         argv[arg]);
+            return SPU_FLAGS_ERROR;
+        }
+        else {
+            flags->code_filename = argv[arg];
+        }
+    }
+
+    if(flags->code_filename == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "SPU expected to have name of binary as parameter.\r\n");
+        return SPU_FLAGS_ERROR;
+    }
+
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Reads positive number after flag
+
+    @param [in] size                Pointer where number is written
+    @param [in] arg                 Index of flag, it is moved to number
+    @param [in] argc                Number of arguments from command line
+    @param [in] argv                Arguments from command line
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t parse_size_flag(size_t     *size,
+                            int        *arg,
+                            int         argc,
+                            const char *argv[]) {
+    char *end = NULL;
+    if(*arg + 1 >= argc ||
+       (*size = strtoull(argv[*arg + 1], &end, 10)) == 0 ||
+       *end != '\0') {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Flag '%s' expected to have positive number after it.\r\n",
+                     argv[*arg]);
+        return SPU_FLAGS_ERROR;
+    }
+
+    (*arg)++;
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Initializes SPU
 
-    @details    Reads header from file name,
+    @details    Reads header from binary file,
                 compares processor and assembler names,
                 compares assembler version.
-                Reads the code from file to code structure
+                Creates SPU region of size which is known from header and flags
+                and reads the code from file to it.
+                RAM initializer from file is copied to RAM.
+                Size of RAM and capacity of stacks are taken from flags, then
+                from header, then default ones.
+                RAM file which is bigger than this size is mapped entirely.
+                Symbols are read after RAM initializer and sorted by address.
+                Sampler is started when SPU is ready to run.
 
-    @param [in] spu                 SPU structure
-    @param [in] fil_name            Name of binary code file
+    @param [in] spu                 Pointer to SPU, which is set to created SPU
+    @param [in] flags               Flags from command line
 
     @return Error code
 
 ======================================================================================================
 */
-spu_error_t init_spu_code(spu_t      *spu,
-                          const char *file_name) {
-    C_ASSERT(spu       != NULL, return SPU_NULL_POINTER );
-    C_ASSERT(file_name != NULL, return SPU_READING_ERROR);
+spu_error_t init_spu_code(spu_t            **spu,
+                          const spu_flags_t *flags) {
+    C_ASSERT(spu                  != NULL, return SPU_NULL_POINTER );
+    C_ASSERT(flags                != NULL, return SPU_NULL_POINTER );
+    C_ASSERT(flags->code_filename != NULL, return SPU_READING_ERROR);
 
-    FILE *code_file = fopen(file_name, "rb");
+    FILE *code_file = fopen(flags->code_filename, "rb");
     if(code_file == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Error while opening file '%s'.\r\n",
-                     file_name);
+                     flags->code_filename);
         return SPU_READING_ERROR;
     }
 
-    spu_error_t error_code = SPU_SUCCESS;
-    if((error_code = read_file_header(spu,
+    spu_error_t      error_code = SPU_SUCCESS;
+    program_header_t header     = {};
+    if((error_code = read_file_header(&header,
                                       code_file,
-                                      file_name)) != SPU_SUCCESS)
+                                      flags->code_filename)) != SPU_SUCCESS) {
+        fclose(code_file);
         return error_code;
+    }
+
+    address_t ram_size = flags->ram_size != 0 ? flags->ram_size  :
+                         header.ram_size != 0 ? header.ram_size :
+                                                default_ram_size;
+    address_t file_ram_size = flags->ram_filename != NULL ? ram_file_size(flags->ram_filename) : 0;
+    if(flags->ram_size == 0 && file_ram_size > ram_size)
+        ram_size = file_ram_size;
+
+    size_t stack_size = flags->stack_size    != 0 ? flags->stack_size           :
+                        header.stack_size    != 0 ? (size_t)header.stack_size   :
+                                                    default_stack_size;
+    if(stack_size > SIZE_MAX / 4 / sizeof(argument_t)) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Stack size %zu is too big.\r\n",
+                     stack_size);
+        fclose(code_file);
+        return SPU_MEMORY_ERROR;
+    }
+
+    *spu = create_spu(flags, header.code_size, ram_size, stack_size, header.symbols_number);
+    if(*spu == NULL) {
+        fclose(code_file);
+        return SPU_MEMORY_ERROR;
+    }
+
+    #ifdef SPU_PROFILE
+        if(flags->profile_filename != NULL &&
+           ((*spu)->profile = profile_create(flags->profile_filename, header.code_size)) == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating profile.\r\n");
+            fclose(code_file);
+            return SPU_MEMORY_ERROR;
+        }
+
+        if(flags->callgraph_filename != NULL &&
+           ((*spu)->callgraph = callgraph_create(flags->callgraph_filename,
+                                                 header.code_size,
+                                                 (*spu)->call_stack_capacity,
+                                                 0)) == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating call graph.\r\n");
+            fclose(code_file);
+            return SPU_MEMORY_ERROR;
+        }
+
+        if(flags->branches_filename != NULL &&
+           ((*spu)->branches = branches_create(flags->branches_filename,
+                                               header.code_size)) == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating branch profile.\r\n");
+            fclose(code_file);
+            return SPU_MEMORY_ERROR;
+        }
 
-    if((error_code = read_file_code  (spu,
+        if(flags->ram_profile_name != NULL &&
+           ((*spu)->ram_profile = ram_profile_create(flags->ram_profile_name,
+                                                     (*spu)->ram_size,
+                                                     flags->ram_window)) == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating RAM profile.\r\n");
+            fclose(code_file);
+            return SPU_MEMORY_ERROR;
+        }
+
+        if(flags->coverage_filename != NULL &&
+           ((*spu)->coverage = coverage_create(flags->coverage_filename,
+                                               header.code_size)) == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating coverage.\r\n");
+            fclose(code_file);
+            return SPU_MEMORY_ERROR;
+        }
+
+        if(flags->trace_filename != NULL &&
+           ((*spu)->trace = trace_create(flags->trace_filename,
+                                         flags->trace_events)) == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while allocating trace.\r\n");
+            fclose(code_file);
+            return SPU_MEMORY_ERROR;
+        }
+    #endif
+
+    if(flags->print_run_stats &&
+       ((*spu)->stats = run_stats_create((*spu)->ram_size)) == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating run statistics.\r\n");
+        fclose(code_file);
+        return SPU_MEMORY_ERROR;
+    }
+
+    if((error_code = read_file_code  (*spu,
+                                      code_file,
+                                      flags->code_filename)) != SPU_SUCCESS)
+        return error_code;
+
+    if((error_code = read_file_data  (*spu,
                                       code_file,
-                                      file_name)) != SPU_SUCCESS)
+                                      flags->code_filename,
+                                      header.data_size,
+                                      file_ram_size != 0)) != SPU_SUCCESS)
+        return error_code;
+
+    if((error_code = read_file_symbols(*spu,
+                                       code_file,
+                                       flags->code_filename)) != SPU_SUCCESS)
         return error_code;
 
     fclose(code_file);
+    if(flags->sample_filename != NULL)
+        return sampler_start(*spu);
+
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Creates SPU region
+
+    @details    SPU structure, value stack, call stack, code and symbols are placed
+                in one region one after another, every part starts on its own
+                cache line. Region is mapped as zeroed pages with one call, its
+                parts are counted in memory statistics under their tags.
+                With STACK_GUARD_PAGE_PROTECTION value stack data can not be
+                placed in region, so value stack is created by stack_init(...)
+                and pinned to the same capacity.
+                RAM is mapped after region is created.
+
+    @param [in] flags               Flags from command line
+    @param [in] code_size           Size of code from file header
+    @param [in] ram_size            Number of RAM cells
+    @param [in] stack_size          Capacity of value stack and call stack
+    @param [in] symbols_number      Number of symbols from file header
+
+    @return Pointer to SPU structure, NULL if region was not created
+
+======================================================================================================
+*/
+spu_t *create_spu(const spu_flags_t *flags,
+                  address_t          code_size,
+                  address_t          ram_size,
+                  size_t             stack_size,
+                  uint64_t           symbols_number) {
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        size_t stack_storage   = 0; //guarded stack data is mapped on its own pages
+    #else
+        size_t stack_storage   = stack_storage_size(stack_size, sizeof(argument_t));
+    #endif
+    size_t stack_offset        = align_to_region(sizeof(spu_t));
+    size_t call_stack_offset   = stack_offset      + align_to_region(stack_storage);
+    size_t code_offset         = call_stack_offset + align_to_region(stack_size * sizeof(address_t));
+    size_t symbols_offset      = code_offset       + align_to_region(code_size * sizeof(command_t));
+    size_t region_size         = symbols_offset    + symbols_number * sizeof(program_symbol_t);
+
+    char *region = (char *)pages_map(region_size, PAGES_READ_WRITE);
+    if(region == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while allocating SPU memory.\r\n");
+        return NULL;
+    }
+
+    spu_t *spu                = (spu_t *)region;
+    spu->flags                = *flags;
+    spu->flags.stack_size     = stack_size;
+    spu->region_size          = region_size;
+    spu->code                 = (command_t  *)(region + code_offset);
+    spu->code_size            = code_size;
+    spu->symbols              = (program_symbol_t *)(region + symbols_offset);
+    spu->symbols_number       = symbols_number;
+    spu->call_stack           = (address_t  *)(region + call_stack_offset);
+    spu->call_stack_capacity  = stack_size;
+    spu->ram_size             = ram_size;
+    count_spu_region(spu, memory_stats_add);
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        spu->stack = stack_init(DUMP_INIT("stack.log",
+                                          spu->stack,
+                                          file_print_double)
+                                stack_size,
+                                sizeof(argument_t));
+
+        stack_policy_t policy = stack_default_policy;
+        policy.min_capacity   = stack_size;
+        policy.is_pinned      = true;
+        if(spu->stack != NULL && stack_set_policy(&spu->stack, &policy) != STACK_SUCCESS)
+            stack_destroy(&spu->stack);
+    #else
+        spu->stack = stack_init_in_place(DUMP_INIT("stack.log",
+                                                   spu->stack,
+                                                   file_print_double)
+                                         region + stack_offset,
+                                         stack_storage,
+                                         sizeof(argument_t));
+    #endif
+    if(spu->stack == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while initializing SPU stack.\r\n");
+        free_spu_region(spu);
+        return NULL;
+    }
+
+    if(map_spu_ram(spu) != SPU_SUCCESS) {
+        stack_destroy(&spu->stack);
+        free_spu_region(spu);
+        return NULL;
+    }
+
+    return spu;
+}
+
+/**
+======================================================================================================
+    @brief      Maps RAM of SPU
+
+    @details    RAM is reserved as anonymous pages, system commits and zeroes
+                them on the first touch, so only cells which are used by program
+                take memory. If '--ram-file' is set, RAM is shared mapping of
+                this file, so its contents are loaded from file and written back
+                by system. If '--huge-pages' is set, system is advised to use
+                transparent huge pages, SPU works without them if advice fails.
+                In protected RAM mode mapping is made by map_protected_ram(...).
+                RAM cells are counted in memory statistics under MEMORY_TAG_RAM
+                whether pages are committed or not, guard pages are not counted.
+
+    @param [in] spu                 SPU structure
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t map_spu_ram(spu_t *spu) {
+    if(spu->ram_size > SIZE_MAX / sizeof(argument_t)) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "RAM size %llu is too big.\r\n",
+                     spu->ram_size);
+        return SPU_MEMORY_ERROR;
+    }
+
+    spu->ram_address_mask = ~(address_t)0;
+    if(spu->flags.protected_ram) {
+        spu_error_t error_code = map_protected_ram(spu);
+        if(error_code != SPU_SUCCESS)
+            return error_code;
+    }
+    else if(spu->flags.ram_filename != NULL) {
+        spu->ram_mapping_size     = spu->ram_size * sizeof(argument_t);
+        spu->random_access_memory = (argument_t *)pages_map_file(spu->flags.ram_filename,
+                                                                 spu->ram_mapping_size,
+                                                                 NULL);
+    }
+    else {
+        spu->ram_mapping_size     = spu->ram_size * sizeof(argument_t);
+        spu->random_access_memory = (argument_t *)pages_map(spu->ram_mapping_size,
+                                                            PAGES_READ_WRITE);
+    }
 
-    spu->random_access_memory = (argument_t *)_calloc(random_access_memory_size,
-                                                      sizeof(argument_t));
     if(spu->random_access_memory == NULL) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                     "Error while allocating RAM.\r\n");
+                     "Error while mapping %llu cells of RAM.\r\n",
+                     spu->ram_size);
         return SPU_MEMORY_ERROR;
     }
 
-    spu->instruction_pointer = 0;
-    spu->stack = stack_init(DUMP_INIT("stack.log",
-                                      spu->stack,
-                                      file_print_double)
-                            stack_init_size,
-                            sizeof(argument_t));
+    if(spu->flags.huge_pages &&
+       pages_advise_huge(spu->random_access_memory,
+                         spu->ram_size * sizeof(argument_t)) != PAGES_SUCCESS)
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Huge pages are not available for RAM.\r\n");
 
-    if(spu->stack == NULL) {
-        free(spu->code);
-        return SPU_STACK_ERROR;
+    memory_stats_add(MEMORY_TAG_RAM, spu->ram_size * sizeof(argument_t));
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Maps RAM with guard pages
+
+    @details    The whole index space of protected_ram_cells cells is reserved
+                as PROT_NONE pages and only the first ram_size cells (rounded up
+                to the whole number of pages) are made accessible. Every RAM
+                address is masked with protected_ram_cells - 1, so it points
+                either to RAM or to guard pages after it and access out of RAM
+                costs only one AND instead of comparison. Reservation takes
+                address space, but not memory.
+                RAM file is mapped over the beginning of reservation.
+                Fault in guard pages is caught by handle_ram_fault(...).
+
+    @param [in] spu                 SPU structure
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t map_protected_ram(spu_t *spu) {
+    if(protected_ram_cells > SIZE_MAX / sizeof(argument_t) ||
+       spu->ram_size       > protected_ram_cells) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "RAM size %llu is too big for protected RAM.\r\n",
+                     spu->ram_size);
+        return SPU_MEMORY_ERROR;
+    }
+
+    size_t ram_bytes = pages_round_up(spu->ram_size * sizeof(argument_t));
+
+    spu->ram_size             = ram_bytes / sizeof(argument_t);
+    spu->ram_address_mask     = protected_ram_cells - 1;
+    spu->ram_mapping_size     = protected_ram_cells * sizeof(argument_t);
+    spu->random_access_memory = (argument_t *)pages_map(spu->ram_mapping_size,
+                                                        PAGES_NO_ACCESS);
+    if(spu->random_access_memory == NULL)
+        return SPU_SUCCESS; //failed mapping is reported by map_spu_ram(...)
+
+    pages_error_t error_code = PAGES_SUCCESS;
+    if(spu->flags.ram_filename != NULL)
+        error_code = pages_map_file(spu->flags.ram_filename,
+                                    ram_bytes,
+                                    spu->random_access_memory) == NULL ? PAGES_MAPPING_ERROR :
+                                                                         PAGES_SUCCESS;
+    else
+        error_code = pages_protect (spu->random_access_memory,
+                                    ram_bytes,
+                                    PAGES_READ_WRITE);
+
+    if(error_code == PAGES_SUCCESS)
+        error_code = pages_add_fault_handler(handle_ram_fault, spu);
+
+    if(error_code != PAGES_SUCCESS) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while protecting RAM.\r\n");
+        pages_unmap(spu->random_access_memory, spu->ram_mapping_size);
+        spu->random_access_memory = NULL;
+        return SPU_MEMORY_ERROR;
     }
 
     return SPU_SUCCESS;
 }
 
+/**
+======================================================================================================
+    @brief      Handles access to guard pages of protected RAM
+
+    @details    It is called from signal handler (vectored exception handler on
+                Windows). If fault address is in guard pages, faulting page is
+                made accessible, so that access is repeated and command ends
+                normally, and limits_check is reset, so that run_spu_code(...)
+                calls check_limits(...) before the next command and stops SPU
+                with SPU_RAM_FAULT. Run loop does not pay anything for it.
+
+    @param [in] fault_address       Address of faulting access
+    @param [in] context             SPU structure
+
+    @return PAGES_FAULT_IGNORED if fault address does not belong to SPU RAM
+
+======================================================================================================
+*/
+pages_fault_action_t handle_ram_fault(void *fault_address,
+                                      void *context) {
+    spu_t *spu         = (spu_t *)context;
+    char  *guard_begin = (char *)(spu->random_access_memory + spu->ram_size);
+    char  *guard_end   = (char *) spu->random_access_memory + spu->ram_mapping_size;
+
+    if((char *)fault_address < guard_begin || (char *)fault_address >= guard_end)
+        return PAGES_FAULT_IGNORED;
+
+    size_t offset = (size_t)((char *)fault_address - (char *)spu->random_access_memory);
+    char  *page   = (char *)spu->random_access_memory + offset / pages_size() * pages_size();
+    if(pages_protect(page, pages_size(), PAGES_READ_WRITE) != PAGES_SUCCESS)
+        return PAGES_FAULT_TERMINATE;
+
+    spu->has_ram_fault  = true;
+    spu->ram_fault_cell = offset / sizeof(argument_t);
+    spu->limits_check   = 0;
+    return PAGES_FAULT_CONTINUE;
+}
+
+/**
+======================================================================================================
+    @brief      Returns number of RAM cells in RAM file, 0 if it does not exist
+
+======================================================================================================
+*/
+address_t ram_file_size(const char *file_name) {
+    FILE *ram_file = fopen(file_name, "rb");
+    if(ram_file == NULL)
+        return 0;
+
+    address_t cells_number = file_size(ram_file) / sizeof(argument_t);
+    fclose(ram_file);
+    return cells_number;
+}
+
+/**
+======================================================================================================
+    @brief      Rounds size up to SPU region alignment
+
+======================================================================================================
+*/
+size_t align_to_region(size_t size) {
+    return (size + spu_region_alignment - 1) / spu_region_alignment * spu_region_alignment;
+}
+
+/**
+======================================================================================================
+    @brief      Counts parts of SPU region in memory statistics
+
+    @details    SPU structure is counted under MEMORY_TAG_DEFAULT, value stack
+                and call stack under MEMORY_TAG_STACK, code and symbols under
+                MEMORY_TAG_CODE.
+
+    @param [in] spu                 SPU structure
+    @param [in] count               memory_stats_add or memory_stats_remove
+
+======================================================================================================
+*/
+void count_spu_region(const spu_t *spu,
+                      void       (*count)(memory_tag_t, size_t)) {
+    size_t stack_offset = align_to_region(sizeof(spu_t));
+    size_t code_offset  = (size_t)((const char *)spu->code - (const char *)spu);
+
+    count(MEMORY_TAG_DEFAULT, stack_offset);
+    count(MEMORY_TAG_STACK,   code_offset      - stack_offset);
+    count(MEMORY_TAG_CODE,    spu->region_size - code_offset );
+}
+
+/**
+======================================================================================================
+    @brief      Removes SPU region from memory statistics and unmaps it
+
+======================================================================================================
+*/
+void free_spu_region(spu_t *spu) {
+    count_spu_region(spu, memory_stats_remove);
+    pages_unmap(spu, spu->region_size);
+}
+
 /**
 ======================================================================================================
     @brief      Runs code
 
-    @details    Runs commands from code array, while functions does not return exit code
+    @details    Runs commands from code array, while functions does not return exit code.
+                In protected RAM mode access to guard pages is found by
+                check_limits(...) after the faulting command, and SPU is stopped
+                with SPU_RAM_FAULT.
+                Limits of '--max-instructions' and '--timeout' are checked only
+                when number of commands reaches limits_check, so run loop pays
+                one comparison per command for them.
 
     @param [in] spu                 SPU structure
 
@@ -152,22 +896,32 @@ spu_error_t init_spu_code(spu_t      *spu,
 spu_error_t run_spu_code(spu_t *spu) {
     C_ASSERT(spu != NULL, return SPU_NULL_POINTER);
 
+    if(spu->stats != NULL)
+        run_stats_start(spu->stats);
+
+    if(spu->flags.timeout != 0) {
+        uint64_t now     = clocks_wall_ns();
+        uint64_t timeout = spu->flags.timeout;
+        spu->deadline = timeout > (UINT64_MAX - now) / 1000000000 ?
+                        UINT64_MAX : now + timeout * 1000000000;
+    }
+
     while(true) {
-        spu_error_t error_code = run_command(spu);
-        if(error_code != SPU_SUCCESS && error_code != SPU_EXIT_SUCCESS) {
-            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                         "Error while running command '0x%llx'\r\n"
-                         "on instruction pointer 0x%llx.\r\n"
-                         "Error code '0x%x'\r\n",
-                         spu->code[spu->instruction_pointer],
-                         spu->instruction_pointer,
-                         error_code);
-            run_command_dump(spu);
-            destroy_spu_code(spu);
-            return error_code;
+        if(spu->commands_number >= spu->limits_check) {
+            spu_error_t limit_error = check_limits(spu);
+            if(limit_error != SPU_SUCCESS) {
+                if(limit_error != SPU_RAM_FAULT)
+                    spu->command_pointer = spu->instruction_pointer;
+                return stop_spu(spu, limit_error);
+            }
         }
+
+        spu_error_t error_code = run_command(spu);
+        if(error_code != SPU_SUCCESS && error_code != SPU_EXIT_SUCCESS)
+            return stop_spu(spu, error_code);
+
         if(error_code == SPU_EXIT_SUCCESS) {
-            destroy_spu_code(spu);
+            destroy_spu_code(&spu);
             return SPU_EXIT_SUCCESS;
         }
     }
@@ -175,22 +929,130 @@ spu_error_t run_spu_code(spu_t *spu) {
 
 /**
 ======================================================================================================
-    @brief      Destroys SPU structure
+    @brief      Stops SPU after error
 
-    @details    Frees code array, destroys stack and sets all spu structure to zeros
+    @details    Prints error code and instruction pointer of command which failed,
+                dumps and destroys SPU. SPU which is stopped by limits is dumped
+                the same way, instruction pointer is the one of the next command.
 
     @param [in] spu                 SPU structure
+    @param [in] error_code          Error code of command
+
+    @return Error code of command
+
+======================================================================================================
+*/
+spu_error_t stop_spu(spu_t       *spu,
+                     spu_error_t  error_code) {
+    color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Error while running command '0x%llx'\r\n"
+                 "on instruction pointer 0x%llx.\r\n"
+                 "Error code '0x%x'\r\n",
+                 spu->code[spu->command_pointer],
+                 spu->command_pointer,
+                 error_code);
+    if(error_code == SPU_RAM_FAULT)
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Access to cell %llu out of RAM of %llu cells.\r\n",
+                     spu->ram_fault_cell,
+                     spu->ram_size);
+    if(error_code == SPU_INSTRUCTIONS_LIMIT)
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Limit of %zu instructions is reached.\r\n",
+                     spu->flags.max_instructions);
+    if(error_code == SPU_TIMEOUT)
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Timeout of %zu seconds is reached after %llu instructions.\r\n",
+                     spu->flags.timeout,
+                     spu->commands_number);
+    if((error_code == SPU_STACK_ERROR      && stack_get_size(spu->stack) >= spu->flags.stack_size) ||
+       (error_code == SPU_CALL_STACK_ERROR && spu->call_stack_size       >= spu->call_stack_capacity))
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Stack of %zu elements is full, set bigger size with '--stack-size N'\r\n"
+                     "of run or write it to binary with 'asm --stack-size N'.\r\n",
+                     spu->flags.stack_size);
+
+    run_command_dump(spu);
+    destroy_spu_code(&spu);
+    return error_code;
+}
+
+/**
+======================================================================================================
+    @brief      Destroys SPU structure
+
+    @details    Stops sampler, prints profiles and memory statistics if they were requested,
+                destroys stack, unmaps RAM, frees SPU region and sets pointer to NULL
+
+    @param [in] spu                 Pointer to SPU
 
     @return Error code
 
 ======================================================================================================
 */
-spu_error_t destroy_spu_code(spu_t *spu) {
-    _free(spu->code);
-    _free(spu->random_access_memory);
-    stack_destroy(&spu->stack);
-    memset(spu, 0, sizeof(spu_t));
-    _memory_destroy_log();
+spu_error_t destroy_spu_code(spu_t **spu) {
+    C_ASSERT(spu != NULL, return SPU_NULL_POINTER);
+
+    if(*spu != NULL) {
+        sampler_stop(*spu);
+        #ifdef SPU_PROFILE
+            if((*spu)->profile != NULL) {
+                profile_report ((*spu)->profile, (*spu)->code);
+                profile_destroy(&(*spu)->profile);
+            }
+            if((*spu)->callgraph != NULL) {
+                callgraph_report ((*spu)->callgraph,
+                                  (*spu)->symbols,
+                                  (*spu)->symbols_number,
+                                  (*spu)->flags.code_filename,
+                                  (*spu)->commands_number);
+                callgraph_destroy(&(*spu)->callgraph);
+            }
+            if((*spu)->branches != NULL) {
+                branches_report ((*spu)->branches,
+                                 (*spu)->symbols,
+                                 (*spu)->symbols_number);
+                branches_destroy(&(*spu)->branches);
+            }
+            if((*spu)->ram_profile != NULL) {
+                ram_profile_report ((*spu)->ram_profile);
+                ram_profile_destroy(&(*spu)->ram_profile);
+            }
+            if((*spu)->coverage != NULL) {
+                coverage_write  ((*spu)->coverage, (*spu)->code);
+                coverage_destroy(&(*spu)->coverage);
+            }
+            if((*spu)->trace != NULL) {
+                trace_report ((*spu)->trace,
+                              (*spu)->symbols,
+                              (*spu)->symbols_number,
+                              (*spu)->flags.code_filename);
+                trace_destroy(&(*spu)->trace);
+            }
+        #endif
+        if((*spu)->stats != NULL) {
+            run_stats_report ((*spu)->stats,
+                              (*spu)->commands_number,
+                              (*spu)->stack,
+                              (*spu)->max_call_depth);
+            run_stats_destroy(&(*spu)->stats);
+        }
+        if((*spu)->flags.print_memory_stats)
+            memory_print_stats(stdout);
+
+        stack_destroy(&(*spu)->stack);
+        if((*spu)->flags.protected_ram)
+            pages_remove_fault_handler(handle_ram_fault, *spu);
+
+        memory_stats_remove(MEMORY_TAG_RAM, (*spu)->ram_size * sizeof(argument_t));
+
+        if((*spu)->flags.ram_filename != NULL)
+            pages_unmap_file((*spu)->random_access_memory, (*spu)->ram_mapping_size);
+        else
+            pages_unmap     ((*spu)->random_access_memory, (*spu)->ram_mapping_size);
+        free_spu_region(*spu);
+        *spu = NULL;
+    }
     return SPU_SUCCESS;
 }
 
@@ -198,7 +1060,11 @@ spu_error_t destroy_spu_code(spu_t *spu) {
 ======================================================================================================
     @brief      Runs one command
 
-    @details    Reads command as last element in code array, runs particular command function
+    @details    Reads command as last element in code array, runs particular command function.
+                Commands are counted for profilers and statistics, time of
+                input and output commands is counted if '--stats' is set.
+                If SPU is built with SPU_PROFILE, command is counted, timed and
+                marked in coverage.
 
     @param [in] spu                 SPU structure
 
@@ -207,21 +1073,83 @@ spu_error_t destroy_spu_code(spu_t *spu) {
 ======================================================================================================
 */
 spu_error_t run_command(spu_t *spu) {
+    SPU_PROFILE_COMMAND_BEGIN(spu);
+    SPU_COVERAGE_COMMAND(spu);
+
+    spu->commands_number++;
+    spu->command_pointer = spu->instruction_pointer;
     command_t operation_code = (command_t)(spu->code[spu->instruction_pointer++] &
                                            operation_code_mask);
     if(!is_command_supported(operation_code))
         return SPU_UNKNOWN_COMMAND;
 
-    return command_handlers[operation_code].handler(spu);
+    bool     is_timed = spu->stats != NULL && is_io_command(operation_code);
+    uint64_t io_start = is_timed ? clocks_wall_ns() : 0;
+
+    spu_error_t error_code = command_handlers[operation_code].handler(spu);
+
+    if(is_timed)
+        spu->stats->io_time += clocks_wall_ns() - io_start;
+
+    SPU_PROFILE_COMMAND_END(spu);
+    return error_code;
 }
 
 /**
 ======================================================================================================
-    @brief      Reads and checks file header.
+    @brief      Checks '--max-instructions' and '--timeout' limits and faults of protected RAM
 
-    @details    Compares header assembler name and version. Sets code_size in spu_code.
+    @details    Sets number of commands when limits are checked next time:
+                after timeout_check_period commands if timeout is set,
+                but not after instructions limit.
 
     @param [in] spu                 SPU structure
+
+    @return SPU_RAM_FAULT, SPU_INSTRUCTIONS_LIMIT or SPU_TIMEOUT if limit is reached,
+            SPU_SUCCESS otherwise
+
+======================================================================================================
+*/
+spu_error_t check_limits(spu_t *spu) {
+    if(spu->has_ram_fault)
+        return SPU_RAM_FAULT;
+
+    if(spu->flags.max_instructions != 0 && spu->commands_number >= spu->flags.max_instructions)
+        return SPU_INSTRUCTIONS_LIMIT;
+
+    if(spu->flags.timeout != 0 && clocks_wall_ns() >= spu->deadline)
+        return SPU_TIMEOUT;
+
+    spu->limits_check = UINT64_MAX;
+    if(spu->flags.timeout != 0)
+        spu->limits_check = spu->commands_number + timeout_check_period;
+
+    if(spu->flags.max_instructions != 0 && spu->limits_check > spu->flags.max_instructions)
+        spu->limits_check = spu->flags.max_instructions;
+
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Returns true if command waits for user or prints, its time is counted by '--stats'
+
+======================================================================================================
+*/
+bool is_io_command(command_t operation_code) {
+    return operation_code == CMD_IN   ||
+           operation_code == CMD_OUT  ||
+           operation_code == CMD_DRAW ||
+           operation_code == CMD_DUMP;
+}
+
+/**
+======================================================================================================
+    @brief      Reads and checks file header.
+
+    @details    Compares header assembler name and version.
+
+    @param [in] header              Header structure to read to
     @param [in] code_file           Binary file to run
     @param [in] file_name           Name of binary file
 
@@ -229,38 +1157,35 @@ spu_error_t run_command(spu_t *spu) {
 
 ======================================================================================================
 */
-spu_error_t read_file_header (spu_t      *spu,
-                              FILE       *code_file,
-                              const char *file_name) {
-    program_header_t header = {};
-
-    if(fread(&header, 1, sizeof(program_header_t), code_file) != sizeof(program_header_t)) {
+spu_error_t read_file_header (program_header_t *header,
+                              FILE             *code_file,
+                              const char       *file_name) {
+    if(fread(header, 1, sizeof(program_header_t), code_file) != sizeof(program_header_t)) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Error while reading code from file '%s'.\r\n",
                      file_name);
         return SPU_READING_ERROR;
     }
 
-    if(strcmp(header.assembler_name, assembler_name) != 0) {
+    if(strcmp(header->assembler_name, assembler_name) != 0) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "Program '%s' was compiled with assembler '%s',\r\n"
                      "This processor supports assembler '%s'.\r\n",
                      file_name,
-                     header.assembler_name,
+                     header->assembler_name,
                      assembler_name);
         return SPU_WRONG_ASSEMBLER;
     }
 
-    if(header.assembler_version != assembler_version) {
+    if(header->assembler_version != assembler_version) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
                      "This program was compiled with assembler version %llu\r\n"
                      "And processor supports only %llu.\r\n",
-                     header.assembler_version,
+                     header->assembler_version,
                      assembler_version);
         return SPU_WRONG_VERSION;
     }
 
-    spu->code_size = header.code_size;
     return SPU_SUCCESS;
 }
 
@@ -268,8 +1193,8 @@ spu_error_t read_file_header (spu_t      *spu,
 ======================================================================================================
     @brief      Reads code array.
 
-    @details    Reads code. It is expected that read_file_header(...) called before
-                and ile size is set to correct value.
+    @details    Reads code to SPU region. It is expected that SPU was created
+                with code size from file header.
 
     @param [in] spu                 SPU structure
     @param [in] code_file           Binary file to run
@@ -282,22 +1207,128 @@ spu_error_t read_file_header (spu_t      *spu,
 spu_error_t read_file_code(spu_t      *spu,
                            FILE       *code_file,
                            const char *file_name) {
-    spu->code = (command_t *)_calloc(spu->code_size, sizeof(command_t));
-    if(spu->code == NULL) {
+    if(fread(spu->code, sizeof(command_t), spu->code_size, code_file) != spu->code_size) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                     "Error while allocating memory to code array.\r\n");
+                     "Error while reading code from file '%s'.\r\n",
+                     file_name);
         fclose(code_file);
-        return SPU_MEMORY_ERROR;
+        return SPU_READING_ERROR;
     }
+    return SPU_SUCCESS;
+}
 
-    if(fread(spu->code, sizeof(command_t), spu->code_size, code_file) != spu->code_size) {
+/**
+======================================================================================================
+    @brief      Reads RAM initializer.
+
+    @details    Reads segments of RAM initializer, which follows the code, directly
+                to RAM. Value of fill segment is read to its first cell and copied
+                to other cells. It is expected that RAM is already mapped.
+                If RAM is mapped to file which existed before start, RAM keeps
+                values of previous runs and initializer is skipped.
+
+    @param [in] spu                 SPU structure
+    @param [in] code_file           Binary file to run
+    @param [in] file_name           Name of binary file
+    @param [in] data_size           Size of RAM initializer from file header
+    @param [in] is_ram_kept         RAM file existed before start
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t read_file_data(spu_t      *spu,
+                           FILE       *code_file,
+                           const char *file_name,
+                           uint64_t    data_size,
+                           bool        is_ram_kept) {
+    if(is_ram_kept) {
+        if(data_size > LONG_MAX || fseek(code_file, (long)data_size, SEEK_CUR) != 0) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while reading RAM initializer from file '%s'.\r\n",
+                         file_name);
+            fclose(code_file);
+            return SPU_READING_ERROR;
+        }
+
+        return SPU_SUCCESS;
+    }
+
+    uint64_t read_size = 0;
+    while(read_size < data_size) {
+        ram_segment_t segment = {};
+        if(fread(&segment, sizeof(ram_segment_t), 1, code_file) != 1) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while reading RAM initializer from file '%s'.\r\n",
+                         file_name);
+            fclose(code_file);
+            return SPU_READING_ERROR;
+        }
+
+        if(segment.cells_number == 0                               ||
+           segment.address      >= spu->ram_size                   ||
+           segment.cells_number >  spu->ram_size - segment.address ||
+           (segment.values_number != segment.cells_number && segment.values_number != 1)) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "RAM initializer of '%s' does not fit RAM of %llu cells.\r\n",
+                         file_name,
+                         spu->ram_size);
+            fclose(code_file);
+            return SPU_READING_ERROR;
+        }
+
+        argument_t *cells = spu->random_access_memory + segment.address;
+        if(fread(cells, sizeof(argument_t), segment.values_number, code_file) != segment.values_number) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error while reading RAM initializer from file '%s'.\r\n",
+                         file_name);
+            fclose(code_file);
+            return SPU_READING_ERROR;
+        }
+
+        for(address_t cell = segment.values_number; cell < segment.cells_number; cell++)
+            cells[cell] = cells[0];
+
+        read_size += sizeof(ram_segment_t) + segment.values_number * sizeof(argument_t);
+    }
+
+    return SPU_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Reads symbols.
+
+    @details    Reads symbols, which follow RAM initializer, to SPU region
+                and sorts them by address. It is expected that SPU was created
+                with number of symbols from file header.
+
+    @param [in] spu                 SPU structure
+    @param [in] code_file           Binary file to run
+    @param [in] file_name           Name of binary file
+
+    @return Error code
+
+======================================================================================================
+*/
+spu_error_t read_file_symbols(spu_t      *spu,
+                              FILE       *code_file,
+                              const char *file_name) {
+    if(fread(spu->symbols,
+             sizeof(program_symbol_t),
+             spu->symbols_number,
+             code_file) != spu->symbols_number) {
         color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                     "Error while reading code from file '%s'.\r\n",
+                     "Error while reading symbols from file '%s'.\r\n",
                      file_name);
         fclose(code_file);
-        _free(spu->code);
         return SPU_READING_ERROR;
     }
+
+    for(uint64_t index = 0; index < spu->symbols_number; index++)
+        spu->symbols[index].name[symbol_name_size - 1] = '\0';
+
+    symbols_sort(spu->symbols, spu->symbols_number);
     return SPU_SUCCESS;
 }
 
@@ -133,6 +133,8 @@ spu_error_t run_command_div(spu_t *spu) {
 ======================================================================================================
 */
 spu_error_t run_command_out(spu_t *spu) {
+    SPU_TRACE_COMMAND(spu, CMD_OUT);
+
     argument_t item = 0;
     if(stack_pop(&spu->stack, &item) != STACK_SUCCESS)
         return SPU_STACK_ERROR;
@@ -159,6 +161,8 @@ spu_error_t run_command_out(spu_t *spu) {
 ======================================================================================================
 */
 spu_error_t run_command_in(spu_t *spu) {
+    SPU_TRACE_COMMAND(spu, CMD_IN);
+
     argument_t item = 0;
 
     color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
@@ -225,7 +229,7 @@ spu_error_t run_command_cos(spu_t *spu) {
     @brief      Runs command DUMP
 
     @details    Dumps spu structure
-                Runs other functions to dump code array, registers and RAM, runs stack dump,
+                Runs other functions to dump code array, registers, call stack and RAM, runs stack dump,
                 which is written to "stack.log"
 
     @param [in] spu                 SPU structure
@@ -235,6 +239,8 @@ spu_error_t run_command_cos(spu_t *spu) {
 ======================================================================================================
 */
 spu_error_t run_command_dump(spu_t *spu) {
+    SPU_TRACE_COMMAND(spu, CMD_DUMP);
+
     if(STACK_DUMP(spu->stack, STACK_SUCCESS) != STACK_SUCCESS)
         return SPU_STACK_ERROR;
 
@@ -249,6 +255,9 @@ spu_error_t run_command_dump(spu_t *spu) {
     if((error_code = write_registers_dump(spu)) != SPU_SUCCESS)
         return error_code;
 
+    if((error_code = write_call_stack_dump(spu)) != SPU_SUCCESS)
+        return error_code;
+
     if((error_code = write_ram_dump      (spu)) != SPU_SUCCESS)
         return error_code;
 
@@ -425,7 +434,7 @@ spu_error_t run_command_pop(spu_t *spu) {
 ======================================================================================================
     @brief      Runs command CALL
 
-    @details    Pushes current value of instruction pointer to stack,
+    @details    Pushes return address to call stack,
                 Runs jmp command
 
     @param [in] spu                 SPU structure
@@ -435,21 +444,27 @@ spu_error_t run_command_pop(spu_t *spu) {
 ======================================================================================================
 */
 spu_error_t run_command_call(spu_t *spu) {
-    address_t return_pointer = spu->instruction_pointer + sizeof(address_t);
+    if(spu->call_stack_size >= spu->call_stack_capacity)
+        return SPU_CALL_STACK_ERROR;
 
-    if(stack_push(&spu->stack, &return_pointer) != STACK_SUCCESS)
-        return SPU_STACK_ERROR;
+    spu->call_stack[spu->call_stack_size++] = spu->instruction_pointer + sizeof(address_t);
+    if(spu->max_call_depth < spu->call_stack_size)
+        spu->max_call_depth = spu->call_stack_size;
 
-    return run_command_jmp(spu);
+    spu_error_t error_code = run_command_jmp(spu);
+
+    //call command is right before its argument, which is before return address
+    SPU_CALLGRAPH_CALL(spu, spu->call_stack[spu->call_stack_size - 1] - sizeof(address_t) - 1);
+    SPU_TRACE_CALL(spu);
+    return error_code;
 }
 
 /**
 ======================================================================================================
-    @brief      Runs command JA
+    @brief      Runs command RET
 
-    @details    Pops one element from stack, it is assumed that
-                when the ret command occurs the last element in stack is instruction pointer,
-                which is pushed there by command call.
+    @details    Pops return address, which was pushed by command call,
+                from call stack to instruction pointer.
 
     @param [in] spu                 SPU structure
 
@@ -458,9 +473,12 @@ spu_error_t run_command_call(spu_t *spu) {
 ======================================================================================================
 */
 spu_error_t run_command_ret (spu_t *spu) {
-    if(stack_pop(&spu->stack, &spu->instruction_pointer) != STACK_SUCCESS)
-        return SPU_STACK_ERROR;
+    if(spu->call_stack_size == 0)
+        return SPU_CALL_STACK_ERROR;
 
+    SPU_CALLGRAPH_RET(spu);
+    SPU_TRACE_RET(spu);
+    spu->instruction_pointer = spu->call_stack[--spu->call_stack_size];
     return SPU_SUCCESS;
 }
 
@@ -468,7 +486,8 @@ spu_error_t run_command_ret (spu_t *spu) {
 ======================================================================================================
     @brief      Reads arguments to push and pop
 
-    @details    If the argument is RAM address function returns pointer to particular element in RAM.
+    @details    If the argument is RAM address function returns pointer to particular element in RAM,
+                access is counted by RAM profiler and run statistics.
                 Else if the command is pop it returns the pointer to register.
                 Else the argument type represents the value and function puts it in push_register and
                 returns its address.
@@ -484,8 +503,12 @@ argument_t *get_args_push_pop(spu_t *spu) {
     command_t operation_code = (command_t)(code_element & operation_code_mask);
     command_t argument_type  = (command_t)(code_element & argument_type_mask );
 
-    if(argument_type & random_access_memory_mask)
-        return get_memory_address(spu, argument_type);
+    if(argument_type & random_access_memory_mask) {
+        argument_t *cell = get_memory_address(spu, argument_type);
+        SPU_RAM_PROFILE(spu, cell, operation_code == CMD_POP);
+        SPU_STATS_RAM  (spu, cell);
+        return cell;
+    }
 
     if(operation_code == CMD_POP)
         return get_pop_argument(spu);
@@ -565,6 +588,8 @@ argument_t *get_push_argument(spu_t     *spu,
     @details    It is expected that it is checked that argument type mask of RAM is on.
                 Function treat constants as address_t (uint64_t).
                 Values in registers are casted to address_t.
+                Address is masked with ram_address_mask, so in protected RAM mode
+                it is 32-bit and points either to RAM or to guard pages after it.
                 Function returns pointer to RAM cell.
 
     @param [in] spu                 SPU structure
@@ -595,7 +620,7 @@ argument_t *get_memory_address(spu_t     *spu,
         ram_address += (address_t)spu->registers[register_number - 1];
     }
 
-    return spu->random_access_memory + ram_address;
+    return spu->random_access_memory + (ram_address & spu->ram_address_mask);
 }
 
 /**
@@ -604,6 +629,7 @@ argument_t *get_memory_address(spu_t     *spu,
 
     @details    Scans the first spu_drawing_height * spu_drawing_width elements of RAM.
                 If the element is 0 function prints '.' and if not, it prints '*'.
+                Cells which are out of RAM are printed as '.'.
 
     @param [in] spu                 SPU structure
 
@@ -612,12 +638,17 @@ argument_t *get_memory_address(spu_t     *spu,
 ======================================================================================================
 */
 spu_error_t run_command_draw(spu_t *spu) {
+    SPU_TRACE_COMMAND(spu, CMD_DRAW);
+
     char buffer[spu_drawing_height * (spu_drawing_width + 1) + 1] = {};
     size_t buffer_index = 0;
     for(size_t h = 0; h < spu_drawing_height; h++) {
         for(size_t w = 0; w < spu_drawing_width; w++) {
-            uint64_t memory_element = *(uint64_t *)(spu->random_access_memory +
-                                                    h * spu_drawing_width + w);
+            address_t cell           = h * spu_drawing_width + w;
+            uint64_t  memory_element = 0;
+            if(cell < spu->ram_size)
+                memory_element = *(uint64_t *)(spu->random_access_memory + cell);
+
             if(memory_element == 0)
                 buffer[buffer_index++] = '.';
 
@@ -773,6 +804,7 @@ spu_error_t calculate_for_two(spu_t       *spu,
                 The first argument in comparator will be the result of first pop.
                 If comparator returns true, function calls run_command_jmp.
                 Else it moves instruction pointer to next command.
+                Result of comparator is counted by branch profiler.
 
     @param [in] spu                 SPU structure
     @param [in] comparator          Function which compare to elements.
@@ -790,7 +822,9 @@ spu_error_t jump_with_condition(spu_t  *spu,
     if(pop_two_elements(spu, &first_item, &second_item) != SPU_SUCCESS)
         return SPU_STACK_ERROR;
 
-    if(comparator(first_item, second_item))
+    bool is_taken = comparator(first_item, second_item);
+    SPU_BRANCH_PROFILE(spu, is_taken);
+    if(is_taken)
         return run_command_jmp(spu);
 
     spu->instruction_pointer += sizeof(address_t);
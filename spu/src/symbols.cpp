@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "symbols.h"
+#include "custom_assert.h"
+#include "spu_facilities.h"
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static int compare_symbols(const void *first,
+                           const void *second);
+
+/**
+======================================================================================================
+    @brief      Sorts symbols by address.
+
+======================================================================================================
+*/
+void symbols_sort(program_symbol_t *symbols,
+                  uint64_t          symbols_number) {
+    if(symbols == NULL || symbols_number == 0)
+        return ;
+
+    qsort(symbols, symbols_number, sizeof(program_symbol_t), compare_symbols);
+}
+
+/**
+======================================================================================================
+    @brief      Finds symbol which address is the nearest one not greater than address.
+
+    @param [in] symbols             Sorted symbols.
+    @param [in] symbols_number      Number of symbols.
+    @param [in] address             Address in code.
+
+    @return Symbol or NULL if there is no symbol before address.
+
+======================================================================================================
+*/
+const program_symbol_t *symbols_find(const program_symbol_t *symbols,
+                                     uint64_t                symbols_number,
+                                     address_t               address) {
+    if(symbols == NULL || symbols_number == 0 || symbols[0].address > address)
+        return NULL;
+
+    //binary search of the last symbol with symbol address <= address
+    uint64_t left  = 0;
+    uint64_t right = symbols_number;
+    while(right - left > 1) {
+        uint64_t middle = left + (right - left) / 2;
+        if(symbols[middle].address <= address)
+            left  = middle;
+        else
+            right = middle;
+    }
+
+    return symbols + left;
+}
+
+/**
+======================================================================================================
+    @brief      Prints address as 'symbol' or 'symbol+0xoffset'.
+
+    @details    Address without symbol before it is printed as '0xaddress'.
+
+======================================================================================================
+*/
+void symbols_print(FILE                   *output_file,
+                   const program_symbol_t *symbols,
+                   uint64_t                symbols_number,
+                   address_t               address) {
+    C_ASSERT(output_file != NULL, return );
+
+    const program_symbol_t *symbol = symbols_find(symbols, symbols_number, address);
+    if(symbol == NULL)
+        fprintf(output_file, "0x%llx", address);
+    else if(symbol->address == address)
+        fprintf(output_file, "%s", symbol->name);
+    else
+        fprintf(output_file, "%s+0x%llx", symbol->name, address - symbol->address);
+}
+
+/**
+======================================================================================================
+    @brief      Compares symbols by address.
+
+======================================================================================================
+*/
+int compare_symbols(const void *first,
+                    const void *second) {
+    address_t first_address  = ((const program_symbol_t *)first )->address;
+    address_t second_address = ((const program_symbol_t *)second)->address;
+    return first_address < second_address ? -1 : first_address > second_address;
+}
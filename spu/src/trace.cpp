@@ -0,0 +1,243 @@
+#ifdef SPU_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "trace.h"
+#include "symbols.h"
+#include "custom_assert.h"
+#include "colors.h"
+#include "memory.h"
+#include "pages.h"
+#include "clocks.h"
+#include "spu_facilities.h"
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static void        write_event       (FILE                   *trace_file,
+                                      const trace_event_t    *event,
+                                      double                  timestamp,
+                                      const program_symbol_t *symbols,
+                                      uint64_t                symbols_number);
+static void        write_counters    (FILE                   *trace_file,
+                                      const trace_event_t    *event,
+                                      double                  timestamp);
+static void        write_end         (FILE                   *trace_file,
+                                      double                  timestamp);
+static void        write_json_string (FILE                   *trace_file,
+                                      const char             *string);
+
+/**
+======================================================================================================
+    @brief      Creates tracer.
+
+    @details    Events buffer is mapped once, pages are committed only when
+                events are written to them, so big capacity costs nothing
+                for short runs.
+
+    @param [in] filename            Name of JSON file.
+    @param [in] events_capacity     Maximum number of events.
+
+    @return Tracer or NULL if it was not allocated or size of events buffer
+            does not fit in size_t.
+
+======================================================================================================
+*/
+spu_trace_t *trace_create(const char *filename,
+                          size_t      events_capacity) {
+    C_ASSERT(filename != NULL, return NULL);
+
+    if(events_capacity > (SIZE_MAX - pages_size()) / sizeof(trace_event_t))
+        return NULL;
+
+    spu_trace_t *trace = (spu_trace_t *)_calloc(1, sizeof(spu_trace_t));
+    if(trace == NULL)
+        return NULL;
+
+    trace->filename        = filename;
+    trace->events_capacity = events_capacity;
+    trace->mapping_size    = pages_round_up(events_capacity * sizeof(trace_event_t) + 1);
+    trace->events          = (trace_event_t *)pages_map(trace->mapping_size, PAGES_READ_WRITE);
+    if(trace->events == NULL) {
+        trace_destroy(&trace);
+        return NULL;
+    }
+
+    trace->start_time = clocks_wall_ns();
+    return trace;
+}
+
+/**
+======================================================================================================
+    @brief      Writes events to Chrome trace-event JSON file.
+
+    @details    Call and ret are written as 'B' and 'E' events of span which is
+                named by symbol of callee, commands are instant events and
+                every event is followed by counters of value stack size and
+                call depth. The whole run is span '[entry]', spans which are
+                not finished are closed at the end of run.
+                Timestamps are microseconds from creation of tracer.
+
+    @param [in] trace               Tracer.
+    @param [in] symbols             Sorted symbols of program.
+    @param [in] symbols_number      Number of symbols.
+    @param [in] binary_name         Name of binary, it is name of process in trace.
+
+======================================================================================================
+*/
+void trace_report(spu_trace_t            *trace,
+                  const program_symbol_t *symbols,
+                  uint64_t                symbols_number,
+                  const char             *binary_name) {
+    C_ASSERT(trace       != NULL, return );
+    C_ASSERT(binary_name != NULL, return );
+
+    double end_time   = (double)(clocks_wall_ns() - trace->start_time) / 1000;
+    FILE  *trace_file = fopen(trace->filename, "wb");
+    if(trace_file == NULL) {
+        color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "Error while opening trace file '%s'.\r\n",
+                     trace->filename);
+        return ;
+    }
+
+    fprintf(trace_file, "{\"traceEvents\":[\n"
+                        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                        "\"args\":{\"name\":\"");
+    write_json_string(trace_file, binary_name);
+    fprintf(trace_file, "\"}},\n"
+                        "{\"name\":\"[entry]\",\"cat\":\"call\",\"ph\":\"B\",\"ts\":0,"
+                        "\"pid\":1,\"tid\":1}");
+
+    size_t open_frames = 0;
+    for(size_t index = 0; index < trace->events_number; index++) {
+        const trace_event_t *event     = trace->events + index;
+        double               timestamp = (double)(event->timestamp - trace->start_time) / 1000;
+        if(event->type == TRACE_EVENT_RET) {
+            if(open_frames == 0)
+                continue;
+            open_frames--;
+        }
+        if(event->type == TRACE_EVENT_CALL)
+            open_frames++;
+
+        write_event   (trace_file, event, timestamp, symbols, symbols_number);
+        write_counters(trace_file, event, timestamp);
+    }
+
+    for(size_t frame = 0; frame < open_frames + 1; frame++)
+        write_end(trace_file, end_time);
+
+    fprintf(trace_file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    fclose(trace_file);
+
+    color_printf(GREEN_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                 "Trace: %zu events are written to '%s'.\r\n",
+                 trace->events_number,
+                 trace->filename);
+    if(trace->dropped_events != 0)
+        color_printf(YELLOW_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                     "%llu events were dropped, trace is cut at %zu events.\r\n",
+                     trace->dropped_events,
+                     trace->events_capacity);
+}
+
+/**
+======================================================================================================
+    @brief      Frees tracer and sets pointer to NULL.
+
+======================================================================================================
+*/
+void trace_destroy(spu_trace_t **trace) {
+    C_ASSERT(trace != NULL, return );
+    if(*trace == NULL)
+        return ;
+
+    if((*trace)->events != NULL)
+        pages_unmap((*trace)->events, (*trace)->mapping_size);
+
+    _free(*trace);
+    *trace = NULL;
+}
+
+/**
+======================================================================================================
+    @brief      Writes event as 'B', 'E' or instant event.
+
+======================================================================================================
+*/
+void write_event(FILE                   *trace_file,
+                 const trace_event_t    *event,
+                 double                  timestamp,
+                 const program_symbol_t *symbols,
+                 uint64_t                symbols_number) {
+    switch(event->type) {
+        case TRACE_EVENT_CALL:
+            fprintf(trace_file, ",\n{\"name\":\"");
+            symbols_print(trace_file, symbols, symbols_number, event->address);
+            fprintf(trace_file, "\",\"cat\":\"call\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":1,"
+                                "\"args\":{\"entry\":\"0x%llx\"}}",
+                    timestamp,
+                    event->address);
+            break;
+        case TRACE_EVENT_RET:
+            write_end(trace_file, timestamp);
+            break;
+        case TRACE_EVENT_COMMAND:
+            fprintf(trace_file, ",\n{\"name\":\"%s\",\"cat\":\"io\",\"ph\":\"i\",\"s\":\"t\","
+                                "\"ts\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"ip\":\"0x%llx\"}}",
+                    spu_command_name(event->command),
+                    timestamp,
+                    event->address);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+======================================================================================================
+    @brief      Writes counters of value stack size and call depth after event.
+
+======================================================================================================
+*/
+void write_counters(FILE                *trace_file,
+                    const trace_event_t *event,
+                    double               timestamp) {
+    fprintf(trace_file, ",\n{\"name\":\"depth\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":1,"
+                        "\"args\":{\"value stack\":%llu,\"call stack\":%u}}",
+            timestamp,
+            event->stack_size,
+            event->call_depth);
+}
+
+/**
+======================================================================================================
+    @brief      Writes end of the last open span.
+
+======================================================================================================
+*/
+void write_end(FILE  *trace_file,
+               double timestamp) {
+    fprintf(trace_file, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":1}",
+            timestamp);
+}
+
+/**
+======================================================================================================
+    @brief      Writes string with escaped quotes and backslashes (names of files on Windows).
+
+======================================================================================================
+*/
+void write_json_string(FILE       *trace_file,
+                       const char *string) {
+    for(const char *symbol = string; *symbol != '\0'; symbol++) {
+        if(*symbol == '"' || *symbol == '\\')
+            fputc('\\', trace_file);
+        fputc(*symbol, trace_file);
+    }
+}
+
+#endif
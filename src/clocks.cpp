@@ -0,0 +1,48 @@
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#include "clocks.h"
+
+#ifdef _WIN32
+    uint64_t clocks_wall_ns(void) {
+        LARGE_INTEGER counter   = {};
+        LARGE_INTEGER frequency = {};
+        QueryPerformanceCounter  (&counter);
+        QueryPerformanceFrequency(&frequency);
+
+        uint64_t ticks     = (uint64_t)counter.QuadPart;
+        uint64_t tick_rate = (uint64_t)frequency.QuadPart;
+        return ticks / tick_rate * 1000000000 + ticks % tick_rate * 1000000000 / tick_rate;
+    }
+
+    uint64_t clocks_cpu_ns(void) {
+        FILETIME creation_time = {};
+        FILETIME exit_time     = {};
+        FILETIME kernel_time   = {};
+        FILETIME user_time     = {};
+        if(!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+            return 0;
+
+        //FILETIME counts intervals of 100 nanoseconds
+        uint64_t kernel = (uint64_t)kernel_time.dwHighDateTime << 32 | kernel_time.dwLowDateTime;
+        uint64_t user   = (uint64_t)user_time.dwHighDateTime   << 32 | user_time.dwLowDateTime;
+        return (kernel + user) * 100;
+    }
+#else
+    uint64_t clocks_wall_ns(void) {
+        timespec time = {};
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+    }
+
+    uint64_t clocks_cpu_ns(void) {
+        timespec time = {};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+        return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+    }
+#endif
@@ -0,0 +1,325 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "concurrent_stack.h"
+#include "memory.h"
+#include "custom_assert.h"
+
+//==============================================================================
+//REFERENCE TO NODE IS 64 BIT WORD: LOW HALF IS NODE NUMBER (INDEX + 1, 0 IS
+//NULL), HIGH HALF IS TAG WHICH IS INCREMENTED ON EVERY CHANGE OF LIST HEAD
+//==============================================================================
+typedef uint64_t node_reference_t;
+
+static const node_reference_t node_number_mask = 0xffffffff;
+static const size_t           max_capacity     = 0xfffffffe;
+
+//==============================================================================
+//ELIMINATION SLOT STATES: EMPTY, TAKEN BY POP OR NUMBER OF WAITING PUSH NODE
+//==============================================================================
+static const uint64_t elimination_empty = 0         ;
+static const uint64_t elimination_taken = UINT64_MAX;
+static const size_t   elimination_spins = 128       ;
+
+static const size_t   cache_line_size   = 64;
+
+//==============================================================================
+//THE DEFINITION OF NODE STRUCTURE
+//ELEMENT IS PLACED RIGHT AFTER NODE STRUCTURE
+//==============================================================================
+struct stack_node_t {
+    uint64_t next;
+};
+
+//==============================================================================
+//ELIMINATION SLOTS ARE PADDED TO CACHE LINE
+//==============================================================================
+struct elimination_slot_t {
+    alignas(cache_line_size) uint64_t state;
+};
+
+//==============================================================================
+//THE DEFINITION OF CONCURRENT STACK STRUCTURE
+//==============================================================================
+struct concurrent_stack_t {
+    alignas(cache_line_size) node_reference_t top;
+    alignas(cache_line_size) node_reference_t free_nodes;
+
+    alignas(cache_line_size) char *            nodes;
+    size_t                                     node_size;
+    size_t                                     capacity;
+    size_t                                     element_size;
+    elimination_slot_t *                       elimination;
+    size_t                                     elimination_size;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static stack_node_t *get_node             (concurrent_stack_t *stack,
+                                           uint64_t            node_number);
+static bool          list_try_push        (concurrent_stack_t *stack,
+                                           node_reference_t   *head,
+                                           uint64_t            node_number);
+static void          list_push            (concurrent_stack_t *stack,
+                                           node_reference_t   *head,
+                                           uint64_t            node_number);
+static bool          list_try_pop         (concurrent_stack_t *stack,
+                                           node_reference_t   *head,
+                                           uint64_t           *node_number);
+static uint64_t      list_pop             (concurrent_stack_t *stack,
+                                           node_reference_t   *head);
+static bool          eliminate_push       (concurrent_stack_t *stack,
+                                           uint64_t            node_number);
+static uint64_t      eliminate_pop        (concurrent_stack_t *stack);
+static size_t        random_slot          (concurrent_stack_t *stack);
+
+//==============================================================================
+//GLOBAL FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//INITIALIZES STACK, ALL NODES ARE PUT IN FREE NODES LIST
+//------------------------------------------------------------------------------
+concurrent_stack_t *concurrent_stack_init(size_t capacity,
+                                          size_t element_size,
+                                          size_t elimination_size) {
+    C_ASSERT(element_size != 0           , return NULL);
+    C_ASSERT(capacity     <= max_capacity, return NULL);
+
+    concurrent_stack_t *stack = (concurrent_stack_t *)_aligned_calloc(1,
+                                                                          sizeof(concurrent_stack_t),
+                                                                          cache_line_size);
+    if(stack == NULL)
+        return NULL;
+
+    stack->capacity         = capacity;
+    stack->element_size     = element_size;
+    stack->elimination_size = elimination_size;
+    stack->node_size        = sizeof(stack_node_t) +
+                              (element_size + sizeof(stack_node_t) - 1) /
+                              sizeof(stack_node_t) * sizeof(stack_node_t);
+
+    stack->nodes = (char *)_calloc_tagged(MEMORY_TAG_STACK, capacity, stack->node_size);
+    if(stack->nodes == NULL) {
+        concurrent_stack_destroy(&stack);
+        return NULL;
+    }
+
+    if(elimination_size != 0) {
+        stack->elimination = (elimination_slot_t *)_aligned_calloc(elimination_size,
+                                                                   sizeof(elimination_slot_t),
+                                                                   cache_line_size);
+        if(stack->elimination == NULL) {
+            concurrent_stack_destroy(&stack);
+            return NULL;
+        }
+    }
+
+    for(uint64_t node_number = capacity; node_number > 0; node_number--) {
+        get_node(stack, node_number)->next = stack->free_nodes;
+        stack->free_nodes                  = node_number;
+    }
+
+    return stack;
+}
+
+//------------------------------------------------------------------------------
+//PUSHES ELEMENT IN STACK
+//------------------------------------------------------------------------------
+stack_error_t concurrent_stack_push(concurrent_stack_t *stack,
+                                    const void         *element) {
+    C_ASSERT(stack   != NULL, return STACK_NULL         );
+    C_ASSERT(element != NULL, return STACK_INVALID_INPUT);
+
+    uint64_t node_number = list_pop(stack, &stack->free_nodes);
+    if(node_number == 0)
+        return STACK_OVERFLOW;
+
+    memcpy(get_node(stack, node_number) + 1, element, stack->element_size);
+
+    while(!list_try_push(stack, &stack->top, node_number)) {
+        if(stack->elimination_size != 0 &&
+           eliminate_push(stack, node_number))
+            return STACK_SUCCESS;
+    }
+    return STACK_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//POPS ELEMENT FROM STACK, WRITES ELEMENT TO OUTPUT
+//------------------------------------------------------------------------------
+stack_error_t concurrent_stack_pop(concurrent_stack_t *stack,
+                                   void               *output) {
+    C_ASSERT(stack  != NULL, return STACK_NULL          );
+    C_ASSERT(output != NULL, return STACK_INVALID_OUTPUT);
+
+    uint64_t node_number = 0;
+    while(!list_try_pop(stack, &stack->top, &node_number)) {
+        if(stack->elimination_size != 0 &&
+           (node_number = eliminate_pop(stack)) != 0)
+            break;
+    }
+
+    if(node_number == 0)
+        return STACK_EMPTY;
+
+    memcpy(output, get_node(stack, node_number) + 1, stack->element_size);
+    list_push(stack, &stack->free_nodes, node_number);
+    return STACK_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//DESTROYS STACK, IT IS EXPECTED THAT NO THREAD USES IT ANYMORE
+//------------------------------------------------------------------------------
+stack_error_t concurrent_stack_destroy(concurrent_stack_t **stack) {
+    C_ASSERT(stack != NULL, return STACK_NULL);
+
+    if(*stack == NULL)
+        return STACK_SUCCESS;
+
+    _free        ((*stack)->nodes      );
+    _aligned_free((*stack)->elimination);
+    _aligned_free(*stack);
+
+    *stack = NULL;
+    return STACK_SUCCESS;
+}
+
+//==============================================================================
+//STATIC FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//RETURNS NODE BY ITS NUMBER (INDEX + 1)
+//------------------------------------------------------------------------------
+stack_node_t *get_node(concurrent_stack_t *stack,
+                       uint64_t            node_number) {
+    return (stack_node_t *)(stack->nodes + (node_number - 1) * stack->node_size);
+}
+
+//------------------------------------------------------------------------------
+//TRIES ONCE TO PUT NODE ON TOP OF LIST, RETURNS FALSE IF HEAD WAS CHANGED
+//------------------------------------------------------------------------------
+bool list_try_push(concurrent_stack_t *stack,
+                   node_reference_t   *head,
+                   uint64_t            node_number) {
+    node_reference_t old_head = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    node_reference_t new_head = ((old_head & ~node_number_mask) + node_number_mask + 1) |
+                                node_number;
+
+    __atomic_store_n(&get_node(stack, node_number)->next,
+                     old_head & node_number_mask,
+                     __ATOMIC_RELAXED);
+
+    return __atomic_compare_exchange_n(head, &old_head, new_head, false,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+//PUTS NODE ON TOP OF LIST
+//------------------------------------------------------------------------------
+void list_push(concurrent_stack_t *stack,
+               node_reference_t   *head,
+               uint64_t            node_number) {
+    while(!list_try_push(stack, head, node_number))
+        ;
+}
+
+//------------------------------------------------------------------------------
+//TRIES ONCE TO TAKE NODE FROM TOP OF LIST
+//RETURNS TRUE AND 0 IN NODE_NUMBER IF LIST IS EMPTY
+//NODE NEXT IS READ FROM POOL, SO IT IS SAFE EVEN IF NODE WAS ALREADY TAKEN,
+//TAG MAKES COMPARE AND SWAP FAIL IN THIS CASE
+//------------------------------------------------------------------------------
+bool list_try_pop(concurrent_stack_t *stack,
+                  node_reference_t   *head,
+                  uint64_t           *node_number) {
+    node_reference_t old_head = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    *node_number = old_head & node_number_mask;
+    if(*node_number == 0)
+        return true;
+
+    uint64_t         next     = __atomic_load_n(&get_node(stack, *node_number)->next,
+                                                __ATOMIC_RELAXED);
+    node_reference_t new_head = ((old_head & ~node_number_mask) + node_number_mask + 1) |
+                                next;
+
+    if(__atomic_compare_exchange_n(head, &old_head, new_head, false,
+                                   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return true;
+
+    *node_number = 0;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+//TAKES NODE FROM TOP OF LIST, RETURNS 0 IF LIST IS EMPTY
+//------------------------------------------------------------------------------
+uint64_t list_pop(concurrent_stack_t *stack,
+                  node_reference_t   *head) {
+    uint64_t node_number = 0;
+    while(!list_try_pop(stack, head, &node_number))
+        ;
+    return node_number;
+}
+
+//------------------------------------------------------------------------------
+//OFFERS NODE IN RANDOM ELIMINATION SLOT AND WAITS FOR POP TO TAKE IT
+//RETURNS TRUE IF NODE WAS TAKEN BY POP
+//------------------------------------------------------------------------------
+bool eliminate_push(concurrent_stack_t *stack,
+                    uint64_t            node_number) {
+    uint64_t *slot  = &stack->elimination[random_slot(stack)].state;
+    uint64_t  state = elimination_empty;
+
+    if(!__atomic_compare_exchange_n(slot, &state, node_number, false,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        return false;
+
+    for(size_t spin = 0; spin < elimination_spins; spin++)
+        if(__atomic_load_n(slot, __ATOMIC_RELAXED) == elimination_taken)
+            break;
+
+    state = node_number;
+    if(__atomic_compare_exchange_n(slot, &state, elimination_empty, false,
+                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        return false;
+
+    __atomic_store_n(slot, elimination_empty, __ATOMIC_RELAXED);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//TAKES NODE OFFERED BY PUSH IN RANDOM ELIMINATION SLOT, RETURNS 0 IF NONE
+//SLOT IS RELEASED BY PUSH WHICH OFFERED NODE
+//------------------------------------------------------------------------------
+uint64_t eliminate_pop(concurrent_stack_t *stack) {
+    uint64_t *slot  = &stack->elimination[random_slot(stack)].state;
+    uint64_t  state = __atomic_load_n(slot, __ATOMIC_RELAXED);
+
+    if(state == elimination_empty || state == elimination_taken)
+        return 0;
+
+    if(!__atomic_compare_exchange_n(slot, &state, elimination_taken, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return 0;
+
+    return state;
+}
+
+//------------------------------------------------------------------------------
+//RETURNS RANDOM ELIMINATION SLOT INDEX (XORSHIFT, STATE IS PER THREAD)
+//------------------------------------------------------------------------------
+size_t random_slot(concurrent_stack_t *stack) {
+    static thread_local uint64_t random_state = 0;
+    if(random_state == 0)
+        random_state = (uint64_t)(uintptr_t)&random_state | 1;
+
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (size_t)(random_state % stack->elimination_size);
+}
@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <signal.h>
+#endif
+
+#include "dump_writer.h"
+#include "memory.h"
+#include "custom_assert.h"
+
+//==============================================================================
+//THREAD PRIMITIVES OF PLATFORM
+//==============================================================================
+#ifdef _WIN32
+    typedef HANDLE             thread_t;
+    typedef CRITICAL_SECTION   mutex_t;
+    typedef CONDITION_VARIABLE condition_t;
+#else
+    typedef pthread_t          thread_t;
+    typedef pthread_mutex_t    mutex_t;
+    typedef pthread_cond_t     condition_t;
+#endif
+
+//==============================================================================
+//THE DEFINITION OF DUMP WRITER STRUCTURE
+//PRODUCER WRITES TO [TAIL, HEAD + BUFFER_SIZE), BACKGROUND THREAD WRITES
+//[HEAD, TAIL) TO FILE WITHOUT HOLDING MUTEX, POSITIONS GROW INFINITELY
+//==============================================================================
+struct dump_writer_t {
+    FILE *      file;
+    char *      buffer;
+    size_t      buffer_size;
+    size_t      head;
+    size_t      tail;
+    bool        is_closing;
+    bool        has_error;
+
+    thread_t    thread;
+    mutex_t     mutex;
+    condition_t data_written;
+    condition_t data_ready;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static void writer_loop      (dump_writer_t *writer);
+static void copy_to_buffer   (dump_writer_t *writer,
+                              const char    *data,
+                              size_t         size);
+static void wait_for_space   (dump_writer_t *writer,
+                              size_t         size);
+
+static bool thread_start     (dump_writer_t *writer);
+static void thread_join      (dump_writer_t *writer);
+static void mutex_init       (mutex_t       *mutex);
+static void mutex_destroy    (mutex_t       *mutex);
+static void mutex_lock       (mutex_t       *mutex);
+static void mutex_unlock     (mutex_t       *mutex);
+static void condition_init   (condition_t   *condition);
+static void condition_destroy(condition_t   *condition);
+static void condition_wait   (condition_t   *condition,
+                              mutex_t       *mutex);
+static void condition_signal (condition_t   *condition);
+
+//==============================================================================
+//GLOBAL FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//OPENS FILE AND STARTS BACKGROUND THREAD WHICH WRITES BUFFER TO IT
+//------------------------------------------------------------------------------
+dump_writer_t *dump_writer_open(const char *filename,
+                                size_t      buffer_size) {
+    C_ASSERT(filename    != NULL, return NULL);
+    C_ASSERT(buffer_size != 0   , return NULL);
+
+    dump_writer_t *writer = (dump_writer_t *)_calloc(1, sizeof(dump_writer_t));
+    if(writer == NULL)
+        return NULL;
+
+    writer->buffer_size = buffer_size;
+    writer->buffer      = (char *)_calloc(buffer_size, 1);
+    if(writer->buffer == NULL) {
+        _free(writer);
+        return NULL;
+    }
+
+    writer->file = fopen(filename, "wb");
+    if(writer->file == NULL) {
+        _free(writer->buffer);
+        _free(writer);
+        return NULL;
+    }
+
+    mutex_init    (&writer->mutex       );
+    condition_init(&writer->data_written);
+    condition_init(&writer->data_ready  );
+
+    if(!thread_start(writer)) {
+        condition_destroy(&writer->data_ready  );
+        condition_destroy(&writer->data_written);
+        mutex_destroy    (&writer->mutex       );
+        fclose(writer->file);
+        _free (writer->buffer);
+        _free (writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+//------------------------------------------------------------------------------
+//COPIES RECORD TO BUFFER, WAITS ONLY IF BUFFER DOES NOT HAVE ENOUGH SPACE.
+//RECORD WHICH IS BIGGER THAN BUFFER IS WRITTEN TO FILE DIRECTLY AFTER
+//BACKGROUND THREAD WRITES EVERYTHING BEFORE IT
+//------------------------------------------------------------------------------
+dump_writer_error_t dump_writer_write(dump_writer_t            *writer,
+                                      const dump_writer_part_t *parts,
+                                      size_t                    parts_number) {
+    C_ASSERT(writer != NULL, return DUMP_WRITER_NULL);
+    C_ASSERT(parts  != NULL, return DUMP_WRITER_NULL);
+
+    size_t record_size = 0;
+    for(size_t part = 0; part < parts_number; part++)
+        record_size += parts[part].size;
+
+    mutex_lock(&writer->mutex);
+
+    if(record_size > writer->buffer_size) {
+        wait_for_space(writer, writer->buffer_size);
+
+        for(size_t part = 0; part < parts_number; part++)
+            if(fwrite(parts[part].data, 1, parts[part].size, writer->file) != parts[part].size)
+                writer->has_error = true;
+    }
+    else {
+        wait_for_space(writer, record_size);
+
+        for(size_t part = 0; part < parts_number; part++)
+            copy_to_buffer(writer, (const char *)parts[part].data, parts[part].size);
+
+        condition_signal(&writer->data_ready);
+    }
+
+    bool has_error = writer->has_error;
+    mutex_unlock(&writer->mutex);
+
+    if(has_error)
+        return DUMP_WRITER_FILE_ERROR;
+
+    return DUMP_WRITER_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//WAITS UNTIL BUFFER IS EMPTY AND FLUSHES FILE
+//------------------------------------------------------------------------------
+dump_writer_error_t dump_writer_flush(dump_writer_t *writer) {
+    C_ASSERT(writer != NULL, return DUMP_WRITER_NULL);
+
+    mutex_lock(&writer->mutex);
+    wait_for_space(writer, writer->buffer_size);
+    if(fflush(writer->file) != 0)
+        writer->has_error = true;
+
+    bool has_error = writer->has_error;
+    mutex_unlock(&writer->mutex);
+
+    if(has_error)
+        return DUMP_WRITER_FILE_ERROR;
+
+    return DUMP_WRITER_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//WRITES EVERYTHING LEFT IN BUFFER, STOPS BACKGROUND THREAD AND CLOSES FILE
+//------------------------------------------------------------------------------
+dump_writer_error_t dump_writer_close(dump_writer_t **writer) {
+    C_ASSERT(writer != NULL, return DUMP_WRITER_NULL);
+
+    if(*writer == NULL)
+        return DUMP_WRITER_SUCCESS;
+
+    mutex_lock(&(*writer)->mutex);
+    (*writer)->is_closing = true;
+    condition_signal(&(*writer)->data_ready);
+    mutex_unlock(&(*writer)->mutex);
+
+    thread_join(*writer);
+
+    dump_writer_error_t error_code = DUMP_WRITER_SUCCESS;
+    if(fclose((*writer)->file) != 0 || (*writer)->has_error)
+        error_code = DUMP_WRITER_FILE_ERROR;
+
+    condition_destroy(&(*writer)->data_ready  );
+    condition_destroy(&(*writer)->data_written);
+    mutex_destroy    (&(*writer)->mutex       );
+
+    _free(( *writer)->buffer);
+    _free(  *writer);
+    *writer = NULL;
+    return error_code;
+}
+
+//==============================================================================
+//STATIC FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//BACKGROUND THREAD: WRITES FILLED PART OF BUFFER TO FILE UNTIL WRITER IS CLOSED
+//------------------------------------------------------------------------------
+void writer_loop(dump_writer_t *writer) {
+    mutex_lock(&writer->mutex);
+
+    while(true) {
+        while(writer->head == writer->tail && !writer->is_closing)
+            condition_wait(&writer->data_ready, &writer->mutex);
+
+        if(writer->head == writer->tail)
+            break;
+
+        size_t start = writer->head % writer->buffer_size;
+        size_t size  = writer->tail - writer->head;
+        if(size > writer->buffer_size - start)
+            size = writer->buffer_size - start;
+
+        mutex_unlock(&writer->mutex);
+        size_t written = fwrite(writer->buffer + start, 1, size, writer->file);
+        mutex_lock(&writer->mutex);
+
+        if(written != size)
+            writer->has_error = true;
+
+        writer->head += size;
+        condition_signal(&writer->data_written);
+    }
+
+    mutex_unlock(&writer->mutex);
+}
+
+//------------------------------------------------------------------------------
+//COPIES DATA TO FREE PART OF BUFFER, IT IS EXPECTED THAT SPACE IS ENOUGH
+//------------------------------------------------------------------------------
+void copy_to_buffer(dump_writer_t *writer,
+                    const char    *data,
+                    size_t         size) {
+    size_t start      = writer->tail % writer->buffer_size;
+    size_t first_part = writer->buffer_size - start;
+    if(first_part > size)
+        first_part = size;
+
+    memcpy(writer->buffer + start, data             , first_part       );
+    memcpy(writer->buffer        , data + first_part, size - first_part);
+    writer->tail += size;
+}
+
+//------------------------------------------------------------------------------
+//WAITS UNTIL BUFFER HAS SIZE FREE BYTES, MUTEX MUST BE LOCKED
+//------------------------------------------------------------------------------
+void wait_for_space(dump_writer_t *writer,
+                    size_t         size) {
+    while(writer->buffer_size - (writer->tail - writer->head) < size)
+        condition_wait(&writer->data_written, &writer->mutex);
+}
+
+#ifdef _WIN32
+    static DWORD WINAPI thread_routine(LPVOID writer) {
+        writer_loop((dump_writer_t *)writer);
+        return 0;
+    }
+
+    bool thread_start(dump_writer_t *writer) {
+        writer->thread = CreateThread(NULL, 0, thread_routine, writer, 0, NULL);
+        return writer->thread != NULL;
+    }
+
+    void thread_join(dump_writer_t *writer) {
+        WaitForSingleObject(writer->thread, INFINITE);
+        CloseHandle(writer->thread);
+    }
+
+    void mutex_init       (mutex_t     *mutex)     { InitializeCriticalSection(mutex); }
+    void mutex_destroy    (mutex_t     *mutex)     { DeleteCriticalSection    (mutex); }
+    void mutex_lock       (mutex_t     *mutex)     { EnterCriticalSection     (mutex); }
+    void mutex_unlock     (mutex_t     *mutex)     { LeaveCriticalSection     (mutex); }
+    void condition_init   (condition_t *condition) { InitializeConditionVariable(condition); }
+    void condition_destroy(condition_t */*condition*/) {}
+    void condition_signal (condition_t *condition) { WakeConditionVariable    (condition); }
+
+    void condition_wait(condition_t *condition, mutex_t *mutex) {
+        SleepConditionVariableCS(condition, mutex, INFINITE);
+    }
+#else
+    static void *thread_routine(void *writer) {
+        writer_loop((dump_writer_t *)writer);
+        return NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    //NEW THREAD TAKES SIGNAL MASK OF ITS CREATOR, SIGPROF IS BLOCKED IN IT, SO
+    //SAMPLES OF SAMPLE TIMER ARE TAKEN ONLY ON THREAD WHICH RUNS PROGRAM
+    //--------------------------------------------------------------------------
+    bool thread_start(dump_writer_t *writer) {
+        sigset_t blocked_signals  = {};
+        sigset_t previous_signals = {};
+        sigemptyset(&blocked_signals);
+        sigaddset  (&blocked_signals, SIGPROF);
+        pthread_sigmask(SIG_BLOCK, &blocked_signals, &previous_signals);
+
+        bool is_started = pthread_create(&writer->thread, NULL, thread_routine, writer) == 0;
+
+        pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+        return is_started;
+    }
+
+    void thread_join(dump_writer_t *writer) {
+        pthread_join(writer->thread, NULL);
+    }
+
+    void mutex_init       (mutex_t     *mutex)     { pthread_mutex_init   (mutex, NULL); }
+    void mutex_destroy    (mutex_t     *mutex)     { pthread_mutex_destroy(mutex);       }
+    void mutex_lock       (mutex_t     *mutex)     { pthread_mutex_lock   (mutex);       }
+    void mutex_unlock     (mutex_t     *mutex)     { pthread_mutex_unlock (mutex);       }
+    void condition_init   (condition_t *condition) { pthread_cond_init    (condition, NULL); }
+    void condition_destroy(condition_t *condition) { pthread_cond_destroy (condition);       }
+    void condition_signal (condition_t *condition) { pthread_cond_signal  (condition);       }
+
+    void condition_wait(condition_t *condition, mutex_t *mutex) {
+        pthread_cond_wait(condition, mutex);
+    }
+#endif
@@ -1,152 +1,1199 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <time.h>
+    #include <link.h>
+#endif
 
 #include "memory.h"
+#include "memory_trace.h"
+#include "pages.h"
 #include "colors.h"
 #include "custom_assert.h"
 
-enum memory_operation_t {
-    MEMORY_ALLOCATION  ,
-    MEMORY_REALLOCATION,
-    MEMORY_FREE        ,
-    MEMORY_LOG_OPEN    ,
-    MEMORY_LOG_CLOSE   ,
+//==============================================================================
+//EVERY BLOCK STARTS WITH HEADER WHICH TELLS WHICH ALLOCATOR OWNS IT,
+//HEADER SIZE KEEPS ALIGNMENT OF SYSTEM ALLOCATOR FOR USER MEMORY
+//==============================================================================
+struct alignas(16) block_header_t {
+    memory_allocator_t *allocator;
+    uint64_t            size : 56;
+    uint64_t            tag  : 8;
+};
+
+static const uint64_t block_size_mask = ((uint64_t)1 << 56) - 1;
+static const uint64_t block_tag_mask  = 0xff;
+//largest block whose size fits header and does not wrap with header added
+static const size_t   max_block_size  = (size_t)(block_size_mask < SIZE_MAX ? block_size_mask : SIZE_MAX) -
+                                        sizeof(block_header_t);
+
+enum memory_backend_t {
+    MEMORY_BACKEND_ARENA,
+    MEMORY_BACKEND_POOLS,
+    MEMORY_BACKEND_PAGES,
+};
+
+//==============================================================================
+//ARENA IS LIST OF CHUNKS, BLOCKS ARE CUT FROM THE FIRST ONE
+//==============================================================================
+struct alignas(16) arena_chunk_t {
+    arena_chunk_t *next;
+    size_t         capacity;
+    size_t         used;
+};
+
+//==============================================================================
+//POOLS CUT SLABS IN BLOCKS OF THE SAME SIZE CLASS, FREE BLOCKS ARE LINKED
+//THROUGH THEIR USER MEMORY
+//==============================================================================
+struct alignas(16) pool_slab_t {
+    pool_slab_t *next;
+};
+
+struct pool_free_block_t {
+    block_header_t     header;
+    pool_free_block_t *next;
+};
+
+static const size_t pool_classes_number = 8;
+static const size_t pool_min_block_size = 32;
+static const size_t pool_slab_size      = 64 * 1024;
+
+struct memory_allocator_t {
+    memory_backend_t   backend;
+
+    size_t             chunk_size;
+    arena_chunk_t *    chunks;
+    block_header_t *   last_block;
+    //blocks of arena are freed only with arena, so their bytes and number
+    //are counted as freed in memory_allocator_destroy(...), not in _free(...)
+    int64_t            tag_bytes [MEMORY_TAGS_NUMBER];
+    uint64_t           tag_blocks[MEMORY_TAGS_NUMBER];
+
+    pool_free_block_t *free_blocks[pool_classes_number];
+    pool_slab_t *      slabs;
+};
+
+static thread_local memory_allocator_t *bound_allocators[MEMORY_TAGS_NUMBER] = {};
+
+//==============================================================================
+//BLOCKS OF ANY ALLOCATOR WHICH ARE NOT SMALLER THAN large_block_size ARE
+//MAPPED AS SEPARATE PAGES, SO THEY GROW WITHOUT COPYING AND NEW PAGES ARE
+//ALREADY ZEROED. SUCH BLOCKS ARE OWNED BY pages_allocator
+//==============================================================================
+static const size_t       large_block_size = 1024 * 1024;
+static memory_allocator_t pages_allocator  = {.backend = MEMORY_BACKEND_PAGES};
+
+//==============================================================================
+//EVERY THREAD COUNTS ITS OWN OPERATIONS WITHOUT LOCKS, COUNTERS OF ALL
+//THREADS ARE SUMMED IN memory_get_stats(...). COUNTERS OF FINISHED THREAD
+//STAY IN LIST, SO ITS OPERATIONS ARE STILL COUNTED, AND ARE TAKEN BY THE
+//NEXT NEW THREAD, WHICH ADDS ITS OPERATIONS TO THEM. LIVE AND PEAK BYTES
+//ARE COUNTED FOR WHOLE PROCESS, SO PEAK IS EXACT WHEN THREADS FREE MEMORY
+//OF EACH OTHER OR DO NOT RUN AT THE SAME TIME
+//==============================================================================
+struct thread_stats_t {
+    thread_stats_t *next;
+    bool            is_free;
+    uint64_t        reallocations;
+    uint64_t        realloc_moves;
+    uint64_t        tag_allocations[MEMORY_TAGS_NUMBER];
+    uint64_t        tag_frees      [MEMORY_TAGS_NUMBER];
+};
+
+//counters are given back when thread exits, operations which thread makes
+//after that (from destructors of other thread_local objects) are not counted
+struct stats_owner_t {
+    thread_stats_t *stats;
+    bool            is_destroyed;
+
+    ~stats_owner_t();
 };
 
+static thread_stats_t *           stats_list                         = NULL;
+static thread_local stats_owner_t thread_stats                       = {};
+static int64_t                    live_bytes                         = 0;
+static int64_t                    peak_bytes                         = 0;
+static int64_t                    tag_live_bytes[MEMORY_TAGS_NUMBER] = {};
+static int64_t                    tag_peak_bytes[MEMORY_TAGS_NUMBER] = {};
+
+static const char *memory_tag_names[MEMORY_TAGS_NUMBER] = {
+    "default",
+    "code"   ,
+    "stack"  ,
+    "ram"    ,
+    "labels" ,
+    "fixups" ,
+    "source" ,
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static void           *allocate_block (memory_tag_t        tag,
+                                       size_t              number,
+                                       size_t              element_size,
+                                       const void         *call_site);
+static void            free_block     (void               *memory_cell,
+                                       const void         *call_site);
+static thread_stats_t *get_thread_stats(void);
+static void            count_bytes     (size_t              tag,
+                                        int64_t             bytes);
+static void            update_peak     (int64_t            *peak,
+                                        int64_t             live);
+static void            add_counter     (uint64_t           *counter);
+static void            add_counters    (uint64_t           *counter,
+                                        uint64_t            number);
+static bool            is_arena        (memory_allocator_t *allocator);
+static block_header_t *get_header     (void               *memory_cell);
+static block_header_t *system_allocate(size_t              size);
+static void            release_block  (block_header_t     *header);
+static block_header_t *move_to_pages  (block_header_t     *header,
+                                       size_t              new_size);
+static block_header_t *pages_allocate (size_t              size);
+static block_header_t *pages_resize   (block_header_t     *header,
+                                       size_t              new_size);
+static block_header_t *arena_allocate (memory_allocator_t *arena,
+                                       size_t              size);
+static block_header_t *arena_resize   (memory_allocator_t *arena,
+                                       block_header_t     *header,
+                                       size_t              new_size);
+static size_t          pool_class     (size_t              size);
+static block_header_t *pools_allocate (memory_allocator_t *pools,
+                                       size_t              size);
+static void            pools_free     (memory_allocator_t *pools,
+                                       block_header_t     *header);
+static block_header_t *pools_resize   (memory_allocator_t *pools,
+                                       block_header_t     *header,
+                                       size_t              new_size);
+
 #ifndef NDEBUG
-    static FILE       *log_file      = NULL        ;
-    static const char *LOG_FILE_NAME = "memory.log";
+    //==========================================================================
+    //EVERY THREAD PUTS TRACE RECORDS TO ITS OWN RING WITHOUT LOCKS, BACKGROUND
+    //THREAD MOVES THEM FROM ALL RINGS TO FILE. RING OF FINISHED THREAD STAYS IN
+    //LIST, SO ITS RECORDS ARE STILL WRITTEN, AND IS TAKEN BY THE NEXT NEW THREAD,
+    //SO NUMBER OF RINGS IS THE BIGGEST NUMBER OF THREADS WHICH RUN AT ONCE
+    //==========================================================================
+    #ifdef _WIN32
+        typedef HANDLE    trace_thread_t;
+    #else
+        typedef pthread_t trace_thread_t;
+    #endif
 
-    #define MEMORY_LOG(operation, ...) memory_log(operation, __VA_ARGS__)
+    static const size_t trace_ring_size      = 4096;
+    static const size_t trace_cache_line     = 64;
+    static const char  *TRACE_FILE_NAME      = "memory.trace";
 
-    static void memory_log(memory_operation_t operation, ...);
+    struct trace_ring_t {
+        size_t                head;
+        char                  head_padding[trace_cache_line - sizeof(size_t)];
+        size_t                tail;
+        char                  tail_padding[trace_cache_line - sizeof(size_t)];
+        trace_ring_t *        next;
+        uint64_t              thread;
+        bool                  is_free;
+        memory_trace_record_t records[trace_ring_size];
+    };
+
+    //ring is given back when thread exits, records which thread makes after
+    //that (from destructors of other thread_local objects) are not traced
+    struct trace_owner_t {
+        trace_ring_t *ring;
+        bool          is_destroyed;
+
+        ~trace_owner_t();
+    };
+
+    //only the thread which moves state from CLOSED to OPENING opens trace and
+    //only the thread which moves it from RUNNING to CLOSING closes it
+    enum trace_state_t {
+        TRACE_CLOSED  ,
+        TRACE_OPENING ,
+        TRACE_RUNNING ,
+        TRACE_CLOSING ,
+        TRACE_DISABLED,
+    };
+
+    static trace_ring_t *             trace_rings      = NULL;
+    static thread_local trace_owner_t thread_ring      = {};
+    static uint64_t                   threads_number   = 0;
+    static int                        trace_state      = TRACE_CLOSED;
+    static bool                       trace_stopping   = false;
+    static bool                       trace_was_opened = false;
+    static bool                       trace_at_exit    = false;
+    static FILE *                     trace_file       = NULL;
+    static trace_thread_t             trace_thread     = {};
+
+    #define MEMORY_TRACE(operation, tag, memory, size, old_memory, old_size, call_site)\
+        memory_trace(operation, tag, memory, size, old_memory, old_size, call_site)
+
+    static void          memory_trace      (memory_trace_operation_t operation,
+                                            size_t                   tag,
+                                            const void              *memory,
+                                            size_t                   size,
+                                            const void              *old_memory,
+                                            size_t                   old_size,
+                                            const void              *call_site);
+    static trace_ring_t *get_thread_ring   (void);
+    static void          trace_open        (void);
+    static void          trace_loop        (void);
+    static size_t        trace_drain       (trace_ring_t            *ring);
+    static uint64_t      trace_timestamp   (void);
+    static uint64_t      trace_load_bias   (void);
+    static void          trace_yield       (void);
+    static void          trace_sleep       (void);
+    static bool          trace_thread_start(void);
+    static void          trace_thread_join (void);
 #else
-    #define MEMORY_LOG(operation, ...) ((void)0);
+    #define MEMORY_TRACE(operation, tag, memory, size, old_memory, old_size, call_site)\
+        ((void)(tag), (void)(call_site))
 #endif
 
 void *_recalloc(void * memory_cell,
-                size_t old_size,
+                size_t /*old_size*/,
                 size_t new_size,
                 size_t element_size) {
-    void *new_memory_cell = realloc(memory_cell,
-                                    new_size * element_size);
+    const void *call_site = __builtin_return_address(0);
+    if(memory_cell == NULL)
+        return allocate_block(MEMORY_TAG_DEFAULT, new_size, element_size, call_site);
+    if(element_size != 0 && new_size > max_block_size / element_size)
+        return NULL;
+
+    block_header_t     *header        = get_header(memory_cell);
+    size_t              tag           = header->tag;
+    size_t              old_bytes     = header->size;
+    size_t              new_bytes     = new_size * element_size;
+    block_header_t     *new_header    = NULL;
+    uintptr_t           old_address   = (uintptr_t)header;
+    memory_allocator_t *old_allocator = header->allocator;
+
+    if(header->allocator == &pages_allocator)
+        new_header = pages_resize(header, new_bytes);
+    else if(sizeof(block_header_t) + new_bytes >= large_block_size)
+        new_header = move_to_pages(header, new_bytes);
+    else if(header->allocator == NULL)
+        new_header = (block_header_t *)realloc(header, sizeof(block_header_t) + new_bytes);
+    else if(header->allocator->backend == MEMORY_BACKEND_ARENA)
+        new_header = arena_resize(header->allocator, header, new_bytes);
+    else
+        new_header = pools_resize(header->allocator, header, new_bytes);
 
-    MEMORY_LOG(MEMORY_REALLOCATION, memory_cell, old_size, new_memory_cell, new_size);
+    void *new_memory_cell = new_header == NULL ? NULL : new_header + 1;
+
+    MEMORY_TRACE(MEMORY_TRACE_REALLOCATION, tag, new_memory_cell, new_bytes,
+                 memory_cell, old_bytes, call_site);
     if(new_memory_cell == NULL)
         return NULL;
-    if(new_size > old_size)
-        memset((char *)new_memory_cell + old_size * element_size,
+
+    thread_stats_t *stats = get_thread_stats();
+    if(stats != NULL) {
+        add_counter(&stats->reallocations);
+        if((uintptr_t)new_header != old_address)
+            add_counter(&stats->realloc_moves);
+    }
+    count_bytes(tag, (int64_t)new_bytes - (int64_t)old_bytes);
+
+    //block which is moved from arena to pages is not freed with arena any more
+    if(is_arena(old_allocator)) {
+        if(new_header->allocator == old_allocator)
+            old_allocator->tag_bytes[tag] += (int64_t)new_bytes - (int64_t)old_bytes;
+        else {
+            old_allocator->tag_bytes [tag] -= (int64_t)old_bytes;
+            old_allocator->tag_blocks[tag]--;
+        }
+    }
+
+    new_header->size = new_bytes & block_size_mask;
+    if(new_bytes > old_bytes && new_header->allocator != &pages_allocator)
+        memset((char *)new_memory_cell + old_bytes,
                0,
-               (new_size - old_size) * element_size);
+               new_bytes - old_bytes);
     return new_memory_cell;
 }
 
 void *_calloc(size_t number,
               size_t element_size) {
-    void *memory_cell = calloc(number, element_size);
-    MEMORY_LOG(MEMORY_ALLOCATION, memory_cell, number, element_size);
-    return memory_cell;
+    return allocate_block(MEMORY_TAG_DEFAULT, number, element_size, __builtin_return_address(0));
+}
+
+void *_calloc_tagged(memory_tag_t tag,
+                     size_t       number,
+                     size_t       element_size) {
+    return allocate_block(tag, number, element_size, __builtin_return_address(0));
 }
 
 void _free(void *memory_cell) {
-    MEMORY_LOG(MEMORY_FREE, memory_cell);
-    free(memory_cell);
+    free_block(memory_cell, __builtin_return_address(0));
+}
+
+//pointer returned by _calloc is stored right before aligned memory
+void *_aligned_calloc(size_t number,
+                      size_t element_size,
+                      size_t alignment) {
+    if(alignment == 0 || alignment > max_block_size - sizeof(void *))
+        return NULL;
+    if(element_size != 0 && number > (max_block_size - alignment - sizeof(void *)) / element_size)
+        return NULL;
+
+    char *memory_cell = (char *)allocate_block(MEMORY_TAG_DEFAULT,
+                                               number * element_size + alignment - 1 + sizeof(void *),
+                                               1,
+                                               __builtin_return_address(0));
+    if(memory_cell == NULL)
+        return NULL;
+
+    char *aligned_memory = memory_cell + sizeof(void *);
+    aligned_memory      += (alignment - (uintptr_t)aligned_memory % alignment) % alignment;
+
+    memcpy(aligned_memory - sizeof(void *), &memory_cell, sizeof(void *));
+    return aligned_memory;
+}
+
+void _aligned_free(void *memory_cell) {
+    if(memory_cell == NULL)
+        return ;
+
+    void *allocated_memory = NULL;
+    memcpy(&allocated_memory, (char *)memory_cell - sizeof(void *), sizeof(void *));
+    free_block(allocated_memory, __builtin_return_address(0));
+}
+
+//arena takes chunk_size bytes from system at once
+memory_allocator_t *memory_arena_create(size_t chunk_size) {
+    C_ASSERT(chunk_size != 0, return NULL);
+
+    memory_allocator_t *arena = (memory_allocator_t *)calloc(1, sizeof(memory_allocator_t));
+    if(arena == NULL)
+        return NULL;
+
+    arena->backend    = MEMORY_BACKEND_ARENA;
+    arena->chunk_size = chunk_size;
+    return arena;
+}
+
+memory_allocator_t *memory_pools_create(void) {
+    memory_allocator_t *pools = (memory_allocator_t *)calloc(1, sizeof(memory_allocator_t));
+    if(pools == NULL)
+        return NULL;
+
+    pools->backend = MEMORY_BACKEND_POOLS;
+    return pools;
+}
+
+//frees all memory of allocator with one operation, blocks of pools which
+//were too big for size classes and large blocks of any allocator are owned
+//by system and pages and must be freed before
+void memory_allocator_destroy(memory_allocator_t **allocator) {
+    C_ASSERT(allocator != NULL, return );
+
+    if(*allocator == NULL)
+        return ;
+
+    for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++)
+        if(bound_allocators[tag] == *allocator)
+            bound_allocators[tag] = NULL;
+
+    thread_stats_t *stats = get_thread_stats();
+    for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++) {
+        if(stats != NULL)
+            add_counters(&stats->tag_frees[tag], (*allocator)->tag_blocks[tag]);
+        count_bytes(tag, -(*allocator)->tag_bytes[tag]);
+    }
+
+    arena_chunk_t *chunk = (*allocator)->chunks;
+    while(chunk != NULL) {
+        arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    pool_slab_t *slab = (*allocator)->slabs;
+    while(slab != NULL) {
+        pool_slab_t *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    free(*allocator);
+    *allocator = NULL;
+}
+
+void memory_bind(memory_tag_t        tag,
+                 memory_allocator_t *allocator) {
+    C_ASSERT(tag < MEMORY_TAGS_NUMBER, return );
+
+    bound_allocators[tag] = allocator;
+}
+
+memory_allocator_t *memory_bound(memory_tag_t tag) {
+    C_ASSERT(tag < MEMORY_TAGS_NUMBER, return NULL);
+
+    return bound_allocators[tag];
+}
+
+void memory_stats_add(memory_tag_t tag,
+                      size_t       bytes) {
+    C_ASSERT(tag < MEMORY_TAGS_NUMBER, return );
+
+    thread_stats_t *stats = get_thread_stats();
+    if(stats != NULL)
+        add_counter(&stats->tag_allocations[tag]);
+    count_bytes(tag, (int64_t)bytes);
+}
+
+void memory_stats_remove(memory_tag_t tag,
+                         size_t       bytes) {
+    C_ASSERT(tag < MEMORY_TAGS_NUMBER, return );
+
+    thread_stats_t *stats = get_thread_stats();
+    if(stats != NULL)
+        add_counter(&stats->tag_frees[tag]);
+    count_bytes(tag, -(int64_t)bytes);
+}
+
+//------------------------------------------------------------------------------
+//SUMS COUNTERS OF ALL THREADS, COUNTERS CAN BE CHANGED WHILE THEY ARE READ,
+//SO STATISTICS ARE NOT EXACT IF OTHER THREADS ALLOCATE AT THE SAME TIME
+//------------------------------------------------------------------------------
+void memory_get_stats(memory_stats_t *stats) {
+    C_ASSERT(stats != NULL, return );
+
+    memset(stats, 0, sizeof(memory_stats_t));
+
+    for(thread_stats_t *thread = __atomic_load_n(&stats_list, __ATOMIC_ACQUIRE);
+        thread != NULL;
+        thread = thread->next) {
+        stats->reallocations += __atomic_load_n(&thread->reallocations, __ATOMIC_RELAXED);
+        stats->realloc_moves += __atomic_load_n(&thread->realloc_moves, __ATOMIC_RELAXED);
+
+        for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++) {
+            stats->tags[tag].allocations += __atomic_load_n(&thread->tag_allocations[tag], __ATOMIC_RELAXED);
+            stats->tags[tag].frees       += __atomic_load_n(&thread->tag_frees      [tag], __ATOMIC_RELAXED);
+        }
+    }
+
+    for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++) {
+        int64_t tag_live = __atomic_load_n(&tag_live_bytes[tag], __ATOMIC_RELAXED);
+        int64_t tag_peak = __atomic_load_n(&tag_peak_bytes[tag], __ATOMIC_RELAXED);
+        stats->tags[tag].live_bytes = tag_live > 0 ? (size_t)tag_live : 0;
+        stats->tags[tag].peak_bytes = tag_peak > 0 ? (size_t)tag_peak : 0;
+        stats->allocations         += stats->tags[tag].allocations;
+        stats->frees               += stats->tags[tag].frees;
+    }
+
+    int64_t live = __atomic_load_n(&live_bytes, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&peak_bytes, __ATOMIC_RELAXED);
+    stats->live_bytes = live > 0 ? (size_t)live : 0;
+    stats->peak_bytes = peak > 0 ? (size_t)peak : 0;
+}
+
+void memory_print_stats(FILE *stream) {
+    C_ASSERT(stream != NULL, return );
+
+    memory_stats_t stats = {};
+    memory_get_stats(&stats);
+
+    fprintf(stream,
+            "Memory statistics:\r\n"
+            "Live bytes:     %llu\r\n"
+            "Peak bytes:     %llu\r\n"
+            "Allocations:    %llu\r\n"
+            "Frees:          %llu\r\n"
+            "Reallocations:  %llu (%llu moved)\r\n"
+            "%-10s %12s %12s %12s %12s\r\n",
+            (unsigned long long)stats.live_bytes,
+            (unsigned long long)stats.peak_bytes,
+            (unsigned long long)stats.allocations,
+            (unsigned long long)stats.frees,
+            (unsigned long long)stats.reallocations,
+            (unsigned long long)stats.realloc_moves,
+            "tag", "live bytes", "peak bytes", "allocations", "frees");
+
+    for(size_t tag = 0; tag < MEMORY_TAGS_NUMBER; tag++)
+        fprintf(stream,
+                "%-10s %12llu %12llu %12llu %12llu\r\n",
+                memory_tag_names[tag],
+                (unsigned long long)stats.tags[tag].live_bytes,
+                (unsigned long long)stats.tags[tag].peak_bytes,
+                (unsigned long long)stats.tags[tag].allocations,
+                (unsigned long long)stats.tags[tag].frees);
+}
+
+const char *memory_tag_name(memory_tag_t tag) {
+    C_ASSERT(tag < MEMORY_TAGS_NUMBER, return NULL);
+
+    return memory_tag_names[tag];
+}
+
+//------------------------------------------------------------------------------
+//ALLOCATES BLOCK WITH ALLOCATOR BOUND TO TAG, CALL SITE GOES TO TRACE
+//------------------------------------------------------------------------------
+void *allocate_block(memory_tag_t tag,
+                     size_t       number,
+                     size_t       element_size,
+                     const void  *call_site) {
+    C_ASSERT(tag < MEMORY_TAGS_NUMBER, return NULL);
+    if(element_size != 0 && number > max_block_size / element_size)
+        return NULL;
+
+    size_t              size      = number * element_size;
+    memory_allocator_t *allocator = bound_allocators[tag];
+    block_header_t     *header    = NULL;
+
+    if(sizeof(block_header_t) + size >= large_block_size)
+        header = pages_allocate(size);
+    else if(allocator == NULL)
+        header = system_allocate(size);
+    else if(allocator->backend == MEMORY_BACKEND_ARENA)
+        header = arena_allocate(allocator, size);
+    else
+        header = pools_allocate(allocator, size);
+
+    void *memory_cell = NULL;
+    if(header != NULL) {
+        header->size = size & block_size_mask;
+        header->tag  = tag  & block_tag_mask;
+        memory_cell  = header + 1;
+    }
+
+    MEMORY_TRACE(MEMORY_TRACE_ALLOCATION, tag, memory_cell, size, NULL, 0, call_site);
+
+    if(memory_cell == NULL)
+        return NULL;
+
+    thread_stats_t *stats = get_thread_stats();
+    if(stats != NULL)
+        add_counter(&stats->tag_allocations[tag]);
+    count_bytes(tag, (int64_t)size);
+
+    if(is_arena(header->allocator)) {
+        header->allocator->tag_bytes [tag] += (int64_t)size;
+        header->allocator->tag_blocks[tag]++;
+    }
+    return memory_cell;
+}
+
+void free_block(void       *memory_cell,
+                const void *call_site) {
+    if(memory_cell == NULL)
+        return ;
+
+    block_header_t *header = get_header(memory_cell);
+    MEMORY_TRACE(MEMORY_TRACE_FREE, header->tag, NULL, 0, memory_cell, header->size, call_site);
+
+    //block stays in arena until arena is destroyed, it is counted there
+    if(is_arena(header->allocator))
+        return ;
+
+    thread_stats_t *stats = get_thread_stats();
+    if(stats != NULL)
+        add_counter(&stats->tag_frees[header->tag]);
+    count_bytes(header->tag, -(int64_t)header->size);
+
+    release_block(header);
+}
+
+//------------------------------------------------------------------------------
+//ON ITS FIRST OPERATION THREAD TAKES COUNTERS OF FINISHED THREAD OR CREATES
+//NEW ONES AND PUSHES THEM TO GLOBAL LIST, ONLY OWNER THREAD CHANGES THEM.
+//COUNTERS ARE NEVER REMOVED FROM LIST, SO IT IS READ WITHOUT LOCKS
+//------------------------------------------------------------------------------
+thread_stats_t *get_thread_stats(void) {
+    if(thread_stats.stats != NULL || thread_stats.is_destroyed)
+        return thread_stats.stats;
+
+    for(thread_stats_t *stats = __atomic_load_n(&stats_list, __ATOMIC_ACQUIRE);
+        stats != NULL;
+        stats = stats->next) {
+        bool expected = true;
+        if(__atomic_load_n(&stats->is_free, __ATOMIC_RELAXED) &&
+           __atomic_compare_exchange_n(&stats->is_free, &expected, false, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            thread_stats.stats = stats;
+            return stats;
+        }
+    }
+
+    thread_stats_t *stats = (thread_stats_t *)calloc(1, sizeof(thread_stats_t));
+    if(stats == NULL)
+        return NULL;
+
+    stats->next = __atomic_load_n(&stats_list, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n(&stats_list, &stats->next, stats, true,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+
+    thread_stats.stats = stats;
+    return stats;
+}
+
+stats_owner_t::~stats_owner_t() {
+    if(stats != NULL)
+        __atomic_store_n(&stats->is_free, true, __ATOMIC_RELEASE);
+
+    stats        = NULL;
+    is_destroyed = true;
+}
+
+//------------------------------------------------------------------------------
+//BYTES ARE COUNTED BY ALL THREADS, SO PEAK IS RAISED BY COMPARE AND SWAP
+//------------------------------------------------------------------------------
+void count_bytes(size_t  tag,
+                 int64_t bytes) {
+    update_peak(&peak_bytes,          __atomic_add_fetch(&live_bytes,          bytes, __ATOMIC_RELAXED));
+    update_peak(&tag_peak_bytes[tag], __atomic_add_fetch(&tag_live_bytes[tag], bytes, __ATOMIC_RELAXED));
+}
+
+void update_peak(int64_t *peak,
+                 int64_t  live) {
+    int64_t old_peak = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while(live > old_peak &&
+          !__atomic_compare_exchange_n(peak, &old_peak, live, true,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+//only owner thread writes counter, so it does not need atomic increment
+void add_counter(uint64_t *counter) {
+    add_counters(counter, 1);
+}
+
+void add_counters(uint64_t *counter,
+                  uint64_t  number) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + number, __ATOMIC_RELAXED);
+}
+
+bool is_arena(memory_allocator_t *allocator) {
+    return allocator != NULL && allocator->backend == MEMORY_BACKEND_ARENA;
+}
+
+block_header_t *get_header(void *memory_cell) {
+    return (block_header_t *)memory_cell - 1;
+}
+
+block_header_t *system_allocate(size_t size) {
+    return (block_header_t *)calloc(1, sizeof(block_header_t) + size);
+}
+
+//------------------------------------------------------------------------------
+//RETURNS BLOCK TO ITS ALLOCATOR, ARENA FREES BLOCKS ONLY WHEN IT IS DESTROYED
+//------------------------------------------------------------------------------
+void release_block(block_header_t *header) {
+    if(header->allocator == NULL)
+        free(header);
+    else if(header->allocator->backend == MEMORY_BACKEND_POOLS)
+        pools_free(header->allocator, header);
+    else if(header->allocator->backend == MEMORY_BACKEND_PAGES)
+        pages_unmap(header, sizeof(block_header_t) + header->size);
+}
+
+//------------------------------------------------------------------------------
+//BLOCK WHICH GROWS OVER large_block_size LEAVES ITS ALLOCATOR FOR PAGES
+//------------------------------------------------------------------------------
+block_header_t *move_to_pages(block_header_t *header,
+                              size_t          new_size) {
+    block_header_t *new_header = pages_allocate(new_size);
+    if(new_header == NULL)
+        return NULL;
+
+    memcpy(new_header + 1, header + 1, header->size < new_size ? header->size : new_size);
+    new_header->tag = header->tag;
+    release_block(header);
+    return new_header;
+}
+
+block_header_t *pages_allocate(size_t size) {
+    block_header_t *header = (block_header_t *)pages_map(sizeof(block_header_t) + size,
+                                                         PAGES_READ_WRITE);
+    if(header != NULL)
+        header->allocator = &pages_allocator;
+
+    return header;
+}
+
+//------------------------------------------------------------------------------
+//BYTES AFTER THE END OF BLOCK ARE KEPT ZEROED, SO GROWN BLOCK DOES NOT NEED
+//MEMSET: TAIL OF THE LAST PAGE IS CLEARED ON SHRINK AND NEW PAGES ARE ZEROED
+//------------------------------------------------------------------------------
+block_header_t *pages_resize(block_header_t *header,
+                             size_t          new_size) {
+    size_t old_size = header->size;
+
+    block_header_t *new_header = (block_header_t *)pages_remap(header,
+                                                               sizeof(block_header_t) + old_size,
+                                                               sizeof(block_header_t) + new_size);
+    if(new_header == NULL)
+        return NULL;
+
+    size_t kept_size = pages_round_up(sizeof(block_header_t) + new_size) - sizeof(block_header_t);
+    if(old_size > new_size)
+        memset((char *)(new_header + 1) + new_size,
+               0,
+               (old_size < kept_size ? old_size : kept_size) - new_size);
+
+    return new_header;
+}
+
+//------------------------------------------------------------------------------
+//BLOCKS BIGGER THAN HALF OF CHUNK GET THEIR OWN CHUNK, WHICH IS LINKED AFTER
+//CURRENT ONE, SO CURRENT CHUNK IS STILL USED FOR SMALL BLOCKS
+//------------------------------------------------------------------------------
+block_header_t *arena_allocate(memory_allocator_t *arena,
+                               size_t              size) {
+    size_t block_size = sizeof(block_header_t) +
+                        (size + sizeof(block_header_t) - 1) /
+                        sizeof(block_header_t) * sizeof(block_header_t);
+
+    arena_chunk_t *chunk = arena->chunks;
+    if(chunk == NULL || chunk->capacity - chunk->used < block_size) {
+        bool   is_dedicated = block_size > arena->chunk_size / 2;
+        size_t capacity     = is_dedicated ? block_size : arena->chunk_size;
+
+        chunk = (arena_chunk_t *)calloc(1, sizeof(arena_chunk_t) + capacity);
+        if(chunk == NULL)
+            return NULL;
+
+        chunk->capacity = capacity;
+        if(is_dedicated && arena->chunks != NULL) {
+            chunk->next         = arena->chunks->next;
+            arena->chunks->next = chunk;
+        }
+        else {
+            chunk->next   = arena->chunks;
+            arena->chunks = chunk;
+        }
+    }
+
+    block_header_t *header = (block_header_t *)((char *)(chunk + 1) + chunk->used);
+    chunk->used      += block_size;
+    header->allocator = arena;
+
+    if(chunk == arena->chunks)
+        arena->last_block = header;
+
+    return header;
+}
+
+//------------------------------------------------------------------------------
+//THE LAST BLOCK OF CURRENT CHUNK IS RESIZED IN PLACE, OTHER BLOCKS ARE COPIED
+//------------------------------------------------------------------------------
+block_header_t *arena_resize(memory_allocator_t *arena,
+                             block_header_t     *header,
+                             size_t              new_size) {
+    arena_chunk_t *chunk = arena->chunks;
+    if(header == arena->last_block) {
+        size_t old_block_size = (size_t)((char *)(chunk + 1) + chunk->used - (char *)header);
+        size_t new_block_size = sizeof(block_header_t) +
+                                (new_size + sizeof(block_header_t) - 1) /
+                                sizeof(block_header_t) * sizeof(block_header_t);
+
+        if(chunk->used - old_block_size + new_block_size <= chunk->capacity) {
+            chunk->used = chunk->used - old_block_size + new_block_size;
+            if(new_block_size < old_block_size)
+                memset((char *)header + new_block_size, 0, old_block_size - new_block_size);
+            return header;
+        }
+    }
+
+    block_header_t *new_header = arena_allocate(arena, new_size);
+    if(new_header == NULL)
+        return NULL;
+
+    memcpy(new_header + 1, header + 1, header->size < new_size ? header->size : new_size);
+    new_header->tag = header->tag;
+    return new_header;
+}
+
+//------------------------------------------------------------------------------
+//RETURNS SIZE CLASS OF BLOCK OR pool_classes_number IF IT IS TOO BIG
+//------------------------------------------------------------------------------
+size_t pool_class(size_t size) {
+    size_t block_size = sizeof(block_header_t) + size;
+    size_t class_size = pool_min_block_size;
+
+    for(size_t index = 0; index < pool_classes_number; index++, class_size *= 2)
+        if(block_size <= class_size)
+            return index;
+
+    return pool_classes_number;
+}
+
+block_header_t *pools_allocate(memory_allocator_t *pools,
+                               size_t              size) {
+    size_t index = pool_class(size);
+    if(index == pool_classes_number)
+        return system_allocate(size);
+
+    size_t class_size = pool_min_block_size << index;
+
+    if(pools->free_blocks[index] == NULL) {
+        pool_slab_t *slab = (pool_slab_t *)calloc(1, sizeof(pool_slab_t) + pool_slab_size);
+        if(slab == NULL)
+            return NULL;
+
+        slab->next   = pools->slabs;
+        pools->slabs = slab;
+
+        for(size_t offset = 0; offset + class_size <= pool_slab_size; offset += class_size) {
+            pool_free_block_t *block = (pool_free_block_t *)((char *)(slab + 1) + offset);
+            block->next               = pools->free_blocks[index];
+            pools->free_blocks[index] = block;
+        }
+    }
+
+    pool_free_block_t *block  = pools->free_blocks[index];
+    pools->free_blocks[index] = block->next;
+
+    memset(block, 0, class_size);
+    block->header.allocator = pools;
+    return &block->header;
+}
+
+void pools_free(memory_allocator_t *pools,
+                block_header_t     *header) {
+    size_t index = pool_class(header->size);
+
+    pool_free_block_t *block  = (pool_free_block_t *)header;
+    block->next               = pools->free_blocks[index];
+    pools->free_blocks[index] = block;
+}
+
+block_header_t *pools_resize(memory_allocator_t *pools,
+                             block_header_t     *header,
+                             size_t              new_size) {
+    if(pool_class(new_size) == pool_class(header->size))
+        return header;
+
+    block_header_t *new_header = pools_allocate(pools, new_size);
+    if(new_header == NULL)
+        return NULL;
+
+    memcpy(new_header + 1, header + 1, header->size < new_size ? header->size : new_size);
+    new_header->tag = header->tag;
+    pools_free(pools, header);
+    return new_header;
 }
 
 #ifndef NDEBUG
-    void memory_log(memory_operation_t operation, ...) {
-        if(log_file == NULL) {
-            log_file = fopen(LOG_FILE_NAME, "wb");
-            if(log_file == NULL) {
-                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                "Error opening memory dump file.\n");
+    //--------------------------------------------------------------------------
+    //PUTS RECORD TO RING OF CALLING THREAD, WAITS ONLY IF RING IS FULL
+    //--------------------------------------------------------------------------
+    void memory_trace(memory_trace_operation_t operation,
+                      size_t                   tag,
+                      const void              *memory,
+                      size_t                   size,
+                      const void              *old_memory,
+                      size_t                   old_size,
+                      const void              *call_site) {
+        if(__atomic_load_n(&trace_state, __ATOMIC_ACQUIRE) == TRACE_CLOSED)
+            trace_open();
+
+        trace_ring_t *ring = get_thread_ring();
+        if(ring == NULL)
+            return ;
+
+        size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        while(tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == trace_ring_size) {
+            int state = __atomic_load_n(&trace_state, __ATOMIC_ACQUIRE);
+            if(state == TRACE_DISABLED)
                 return ;
+            if(state == TRACE_CLOSED)
+                trace_open();
+
+            trace_yield();
+        }
+
+        memory_trace_record_t *record = &ring->records[tail % trace_ring_size];
+        record->operation  = operation;
+        record->tag        = (uint32_t)tag;
+        record->thread     = ring->thread;
+        record->timestamp  = trace_timestamp();
+        record->call_site  = (uint64_t)(uintptr_t)call_site;
+        record->memory     = (uint64_t)(uintptr_t)memory;
+        record->size       = size;
+        record->old_memory = (uint64_t)(uintptr_t)old_memory;
+        record->old_size   = old_size;
+
+        __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    //--------------------------------------------------------------------------
+    //ON ITS FIRST RECORD THREAD TAKES RING OF FINISHED THREAD OR CREATES NEW
+    //ONE AND PUSHES IT TO GLOBAL LIST. RINGS ARE NEVER REMOVED FROM LIST, SO
+    //BACKGROUND THREAD WALKS IT WITHOUT LOCKS. RECORDS OF PREVIOUS OWNER WHICH
+    //ARE NOT WRITTEN YET STAY IN RING BEFORE RECORDS OF NEW OWNER
+    //--------------------------------------------------------------------------
+    trace_ring_t *get_thread_ring(void) {
+        if(thread_ring.ring != NULL || thread_ring.is_destroyed)
+            return thread_ring.ring;
+
+        uint64_t thread = __atomic_fetch_add(&threads_number, 1, __ATOMIC_RELAXED);
+        for(trace_ring_t *ring = __atomic_load_n(&trace_rings, __ATOMIC_ACQUIRE);
+            ring != NULL;
+            ring = ring->next) {
+            bool expected = true;
+            if(__atomic_load_n(&ring->is_free, __ATOMIC_RELAXED) &&
+               __atomic_compare_exchange_n(&ring->is_free, &expected, false, false,
+                                           __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                ring->thread     = thread;
+                thread_ring.ring = ring;
+                return ring;
             }
-            MEMORY_LOG(MEMORY_LOG_OPEN, NULL);
-        }
-        va_list args;
-        va_start(args, operation);
-
-        switch(operation) {
-            case MEMORY_ALLOCATION:   {
-                const void *allocated = va_arg(args, void *);
-                size_t number = va_arg(args, size_t);
-                size_t element_size = va_arg(args, size_t);
-
-                fprintf(log_file,
-                        "=====================================\r\n"
-                        "ALLOCATION\r\n"
-                        "Memory:       0x%p\r\n"
-                        "Number:       %llu\r\n"
-                        "Element size: %llu\r\n"
-                        "=====================================\r\n\r\n",
-                        allocated,
-                        number,
-                        element_size);
-                break;
-            }
-            case MEMORY_REALLOCATION: {
-                const void *old_memory = va_arg(args, void *);
-                size_t old_size = va_arg(args, size_t);
-                const void *new_memory = va_arg(args, void *);
-                size_t new_size = va_arg(args, size_t);
-
-                fprintf(log_file,
-                        "=====================================\r\n"
-                        "REALLOCATION\r\n"
-                        "Old memory:   0x%p\r\n"
-                        "Old size:     %llu\r\n"
-                        "New memory:   0x%p\r\n"
-                        "New size:     %llu\r\n"
-                        "=====================================\r\n\r\n",
-                        old_memory,
-                        old_size,
-                        new_memory,
-                        new_size);
-                break;
-            }
-            case MEMORY_FREE:         {
-                const void *memory = va_arg(args, void *);
-                fprintf(log_file,
-                        "=====================================\r\n"
-                        "FREE\r\n"
-                        "Memory:       0x%p\r\n"
-                        "=====================================\r\n\r\n",
-                        memory);
-                break;
-            }
-            case MEMORY_LOG_OPEN:     {
-                fprintf(log_file,
-                        "=====================================\r\n"
-                        "LOG_FILE_OPEN\r\n"
-                        "=====================================\r\n\r\n");
-                break;
-            }
-            case MEMORY_LOG_CLOSE:    {
-                fprintf(log_file,
-                        "=====================================\r\n"
-                        "LOG_FILE_CLOSE\r\n"
-                        "=====================================\r\n\r\n");
-                break;
-            }
-            default:                  {
-                fprintf(log_file,
-                        "=====================================\r\n"
-                        "Incorrect log call\r\n"
-                        "=====================================\r\n\r\n");
+        }
+
+        trace_ring_t *ring = (trace_ring_t *)calloc(1, sizeof(trace_ring_t));
+        if(ring == NULL)
+            return NULL;
+
+        ring->thread = thread;
+        ring->next   = __atomic_load_n(&trace_rings, __ATOMIC_RELAXED);
+        while(!__atomic_compare_exchange_n(&trace_rings, &ring->next, ring, true,
+                                           __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+
+        thread_ring.ring = ring;
+        return ring;
+    }
+
+    trace_owner_t::~trace_owner_t() {
+        if(ring != NULL)
+            __atomic_store_n(&ring->is_free, true, __ATOMIC_RELEASE);
+
+        ring         = NULL;
+        is_destroyed = true;
+    }
+
+    //--------------------------------------------------------------------------
+    //THE FIRST THREAD WHICH SEES CLOSED TRACE OPENS FILE AND STARTS BACKGROUND
+    //THREAD. FILE IS TRUNCATED ONLY ONCE, REOPENED TRACE IS APPENDED TO IT
+    //--------------------------------------------------------------------------
+    void trace_open(void) {
+        int expected = TRACE_CLOSED;
+        if(!__atomic_compare_exchange_n(&trace_state, &expected, TRACE_OPENING, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return ;
+
+        trace_file = fopen(TRACE_FILE_NAME, trace_was_opened ? "ab" : "wb");
+        if(trace_file == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error opening memory trace file.\r\n");
+            __atomic_store_n(&trace_state, TRACE_DISABLED, __ATOMIC_RELEASE);
+            return ;
+        }
+
+        if(!trace_was_opened) {
+            memory_trace_header_t header = {
+                .signature   = memory_trace_signature,
+                .version     = memory_trace_version,
+                .record_size = sizeof(memory_trace_record_t),
+                .load_bias   = trace_load_bias()
+            };
+            fwrite(&header, sizeof(header), 1, trace_file);
+            trace_was_opened = true;
+        }
+
+        //trace is written out at exit even if nobody calls _memory_destroy_log(...)
+        if(!trace_at_exit)
+            trace_at_exit = atexit(_memory_destroy_log) == 0;
+
+        __atomic_store_n(&trace_stopping, false, __ATOMIC_RELEASE);
+        if(!trace_thread_start()) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Error starting memory trace thread.\r\n");
+            fclose(trace_file);
+            trace_file = NULL;
+            __atomic_store_n(&trace_state, TRACE_DISABLED, __ATOMIC_RELEASE);
+            return ;
+        }
+
+        __atomic_store_n(&trace_state, TRACE_RUNNING, __ATOMIC_RELEASE);
+    }
+
+    //--------------------------------------------------------------------------
+    //STOP FLAG IS READ BEFORE PASS OVER RINGS, SO THE LAST PASS WRITES
+    //EVERYTHING WHAT WAS TRACED BEFORE _memory_destroy_log(...) CALL
+    //--------------------------------------------------------------------------
+    void trace_loop(void) {
+        while(true) {
+            bool   is_stopping = __atomic_load_n(&trace_stopping, __ATOMIC_ACQUIRE);
+            size_t drained     = 0;
+
+            for(trace_ring_t *ring = __atomic_load_n(&trace_rings, __ATOMIC_ACQUIRE);
+                ring != NULL;
+                ring = ring->next)
+                drained += trace_drain(ring);
+
+            if(is_stopping)
                 break;
-            }
+            if(drained == 0)
+                trace_sleep();
         }
-        va_end(args);
-        fflush(log_file);
+
+        fflush(trace_file);
     }
+
+    size_t trace_drain(trace_ring_t *ring) {
+        size_t head    = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        size_t tail    = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        size_t drained = tail - head;
+
+        while(head != tail) {
+            size_t index = head % trace_ring_size;
+            size_t count = tail - head;
+            if(count > trace_ring_size - index)
+                count = trace_ring_size - index;
+
+            fwrite(&ring->records[index], sizeof(memory_trace_record_t), count, trace_file);
+            head += count;
+            __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+        }
+
+        return drained;
+    }
+
+    #ifdef _WIN32
+        uint64_t trace_timestamp(void) {
+            LARGE_INTEGER counter   = {};
+            LARGE_INTEGER frequency = {};
+            QueryPerformanceCounter  (&counter);
+            QueryPerformanceFrequency(&frequency);
+
+            uint64_t ticks     = (uint64_t)counter.QuadPart;
+            uint64_t tick_rate = (uint64_t)frequency.QuadPart;
+            return ticks / tick_rate * 1000000000 + ticks % tick_rate * 1000000000 / tick_rate;
+        }
+
+        //preferred image base is read from file, because loader can write
+        //actual base to headers of loaded image when it relocates it
+        uint64_t trace_load_bias(void) {
+            char  path[MAX_PATH] = {};
+            DWORD length         = GetModuleFileNameA(NULL, path, MAX_PATH);
+            if(length == 0 || length == MAX_PATH)
+                return 0;
+
+            FILE *image = fopen(path, "rb");
+            if(image == NULL)
+                return 0;
+
+            IMAGE_DOS_HEADER dos_header = {};
+            IMAGE_NT_HEADERS nt_headers = {};
+            bool is_read = fread(&dos_header, sizeof(dos_header), 1, image) == 1 &&
+                           dos_header.e_magic   == IMAGE_DOS_SIGNATURE          &&
+                           fseek(image, dos_header.e_lfanew, SEEK_SET) == 0     &&
+                           fread(&nt_headers, sizeof(nt_headers), 1, image) == 1 &&
+                           nt_headers.Signature == IMAGE_NT_SIGNATURE;
+            fclose(image);
+            if(!is_read)
+                return 0;
+
+            return (uint64_t)(uintptr_t)GetModuleHandleA(NULL) -
+                   (uint64_t)nt_headers.OptionalHeader.ImageBase;
+        }
+
+        void trace_yield(void) { SwitchToThread(); }
+        void trace_sleep(void) { Sleep(1);         }
+
+        static DWORD WINAPI trace_routine(LPVOID /*argument*/) {
+            trace_loop();
+            return 0;
+        }
+
+        bool trace_thread_start(void) {
+            trace_thread = CreateThread(NULL, 0, trace_routine, NULL, 0, NULL);
+            return trace_thread != NULL;
+        }
+
+        void trace_thread_join(void) {
+            WaitForSingleObject(trace_thread, INFINITE);
+            CloseHandle(trace_thread);
+        }
+    #else
+        uint64_t trace_timestamp(void) {
+            timespec time = {};
+            clock_gettime(CLOCK_MONOTONIC, &time);
+            return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+        }
+
+        //the first object which dl_iterate_phdr(...) reports is executable
+        static int executable_bias(dl_phdr_info *info, size_t /*size*/, void *bias) {
+            *(uint64_t *)bias = (uint64_t)info->dlpi_addr;
+            return 1;
+        }
+
+        uint64_t trace_load_bias(void) {
+            uint64_t bias = 0;
+            dl_iterate_phdr(executable_bias, &bias);
+            return bias;
+        }
+
+        void trace_yield(void) { sched_yield(); }
+
+        void trace_sleep(void) {
+            timespec period = {.tv_sec = 0, .tv_nsec = 1000000};
+            nanosleep(&period, NULL);
+        }
+
+        static void *trace_routine(void */*argument*/) {
+            trace_loop();
+            return NULL;
+        }
+
+        //SIGPROF of sample timer must not stop background thread, so it is
+        //blocked in creator while thread is created and new thread inherits it
+        bool trace_thread_start(void) {
+            sigset_t blocked_signals  = {};
+            sigset_t previous_signals = {};
+            sigemptyset(&blocked_signals);
+            sigaddset  (&blocked_signals, SIGPROF);
+            pthread_sigmask(SIG_BLOCK, &blocked_signals, &previous_signals);
+
+            bool is_started = pthread_create(&trace_thread, NULL, trace_routine, NULL) == 0;
+
+            pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+            return is_started;
+        }
+
+        void trace_thread_join(void) {
+            pthread_join(trace_thread, NULL);
+        }
+    #endif
 #endif
 
+//------------------------------------------------------------------------------
+//WRITES ALL TRACED RECORDS AND STOPS BACKGROUND THREAD, NEXT ALLOCATION
+//STARTS IT AGAIN. IF SEVERAL THREADS CALL IT AT ONCE, ONLY ONE OF THEM JOINS
+//BACKGROUND THREAD AND CLOSES FILE, OTHERS RETURN AT ONCE
+//------------------------------------------------------------------------------
 void _memory_destroy_log(void) {
     #ifndef NDEBUG
-        MEMORY_LOG(MEMORY_LOG_CLOSE, NULL);
-        fclose(log_file);
+        int expected = TRACE_RUNNING;
+        if(!__atomic_compare_exchange_n(&trace_state, &expected, TRACE_CLOSING, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return ;
+
+        __atomic_store_n(&trace_stopping, true, __ATOMIC_RELEASE);
+        trace_thread_join();
+
+        fclose(trace_file);
+        trace_file = NULL;
+        __atomic_store_n(&trace_state, TRACE_CLOSED, __ATOMIC_RELEASE);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+//TOOLS WHICH READ TRACE TURN IT OFF SO THAT THEY DO NOT OVERWRITE IT
+//------------------------------------------------------------------------------
+void _memory_disable_log(void) {
+    #ifndef NDEBUG
+        _memory_destroy_log();
+        __atomic_store_n(&trace_state, TRACE_DISABLED, __ATOMIC_RELEASE);
     #endif
 }
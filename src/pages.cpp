@@ -0,0 +1,496 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <signal.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "pages.h"
+#include "custom_assert.h"
+
+/**
+======================================================================================================
+    @brief      Maximum number of simultaneously registered fault handlers.
+
+======================================================================================================
+*/
+static const size_t max_fault_handlers = 16;
+
+struct fault_handler_t {
+    pages_fault_handler_t handler;
+    void                 *context;
+};
+
+static fault_handler_t fault_handlers[max_fault_handlers] = {};
+static bool            fault_dispatcher_installed         = false;
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+static pages_error_t        install_fault_dispatcher(void);
+static pages_fault_action_t dispatch_fault          (void *fault_address);
+
+#ifdef _WIN32
+    static DWORD           get_protection    (pages_access_t access);
+    static LONG WINAPI     fault_dispatcher  (EXCEPTION_POINTERS *exception);
+#else
+    static int             get_protection    (pages_access_t access);
+    static void            fault_dispatcher  (int signal_number, siginfo_t *info, void *context);
+
+    static struct sigaction previous_segv_action = {};
+    static struct sigaction previous_bus_action  = {};
+#endif
+
+/**
+======================================================================================================
+    @brief      Returns size of memory page.
+
+======================================================================================================
+*/
+size_t pages_size(void) {
+    static size_t page_size = 0;
+    if(page_size != 0)
+        return page_size;
+
+    #ifdef _WIN32
+        SYSTEM_INFO system_info = {};
+        GetSystemInfo(&system_info);
+        page_size = system_info.dwPageSize;
+    #else
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+    #endif
+
+    return page_size;
+}
+
+/**
+======================================================================================================
+    @brief      Rounds size up to the whole number of pages.
+
+======================================================================================================
+*/
+size_t pages_round_up(size_t size) {
+    size_t page_size = pages_size();
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+/**
+======================================================================================================
+    @brief      Maps anonymous zeroed pages.
+
+    @details    Size is rounded up to the whole number of pages.
+                Pages are committed by system on the first touch. Pages without
+                access are only reserved, so they take address space but not
+                memory (on Windows they are committed by pages_protect(...)).
+
+    @param [in] size                Size of mapping in bytes.
+    @param [in] access              Access rights of mapped pages.
+
+    @return Pointer to the first page or NULL if mapping failed.
+
+======================================================================================================
+*/
+void *pages_map(size_t size, pages_access_t access) {
+    size = pages_round_up(size);
+
+    #ifdef _WIN32
+        DWORD allocation = access == PAGES_NO_ACCESS ? MEM_RESERVE : MEM_RESERVE | MEM_COMMIT;
+        return VirtualAlloc(NULL, size, allocation, get_protection(access));
+    #else
+        void *address = mmap(NULL, size, get_protection(access),
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(address == MAP_FAILED)
+            return NULL;
+
+        return address;
+    #endif
+}
+
+/**
+======================================================================================================
+    @brief      Changes access rights of pages.
+
+    @param [in] address             Page aligned address of the first page.
+    @param [in] size                Size of region in bytes.
+    @param [in] access              New access rights.
+
+    @return Error code
+
+======================================================================================================
+*/
+pages_error_t pages_protect(void *address, size_t size, pages_access_t access) {
+    C_ASSERT(address != NULL, return PAGES_PROTECTION_ERROR);
+
+    #ifdef _WIN32
+        //reserved pages must be committed before they are accessed
+        DWORD old_protection = 0;
+        if(access != PAGES_NO_ACCESS &&
+           VirtualAlloc(address, pages_round_up(size), MEM_COMMIT, get_protection(access)) == NULL)
+            return PAGES_PROTECTION_ERROR;
+        if(!VirtualProtect(address, pages_round_up(size), get_protection(access), &old_protection))
+            return PAGES_PROTECTION_ERROR;
+    #else
+        if(mprotect(address, pages_round_up(size), get_protection(access)) != 0)
+            return PAGES_PROTECTION_ERROR;
+    #endif
+
+    return PAGES_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Unmaps pages mapped by pages_map(...).
+
+    @param [in] address             Address returned by pages_map(...).
+    @param [in] size                Size passed to pages_map(...).
+
+    @return Error code
+
+======================================================================================================
+*/
+pages_error_t pages_unmap(void *address, size_t size) {
+    if(address == NULL)
+        return PAGES_SUCCESS;
+
+    #ifdef _WIN32
+        (void)size;
+        if(!VirtualFree(address, 0, MEM_RELEASE))
+            return PAGES_MAPPING_ERROR;
+    #else
+        if(munmap(address, pages_round_up(size)) != 0)
+            return PAGES_MAPPING_ERROR;
+    #endif
+
+    return PAGES_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Resizes mapping made by pages_map(...) with read-write access.
+
+    @details    On Linux page tables are moved by mremap without copying
+                memory, on other systems new pages are mapped and contents
+                are copied. Pages which are added to mapping are zeroed.
+
+    @param [in] address             Address returned by pages_map(...).
+    @param [in] old_size            Current size of mapping.
+    @param [in] new_size            New size of mapping.
+
+    @return Pointer to the first page or NULL if remapping failed, old
+            mapping is not changed in this case.
+
+======================================================================================================
+*/
+void *pages_remap(void *address, size_t old_size, size_t new_size) {
+    C_ASSERT(address != NULL, return NULL);
+
+    old_size = pages_round_up(old_size);
+    new_size = pages_round_up(new_size);
+    if(old_size == new_size)
+        return address;
+
+    #ifdef __linux__
+        void *new_address = mremap(address, old_size, new_size, MREMAP_MAYMOVE);
+        if(new_address == MAP_FAILED)
+            return NULL;
+
+        return new_address;
+    #else
+        void *new_address = pages_map(new_size, PAGES_READ_WRITE);
+        if(new_address == NULL)
+            return NULL;
+
+        memcpy(new_address, address, old_size < new_size ? old_size : new_size);
+        pages_unmap(address, old_size);
+        return new_address;
+    #endif
+}
+
+/**
+======================================================================================================
+    @brief      Maps file to memory.
+
+    @details    Mapping is shared, so changes are written to file by system and
+                file can be prepared or inspected by other programs. File is
+                created if it does not exist, if it is smaller than size it is
+                extended with zeros. Fixed address is supported only with mmap.
+
+    @param [in] file_name           Name of file.
+    @param [in] size                Size of mapping in bytes.
+    @param [in] address             Page aligned address of pages which are replaced
+                                    by mapping, or NULL.
+
+    @return Pointer to the first page or NULL if mapping failed.
+
+======================================================================================================
+*/
+void *pages_map_file(const char *file_name, size_t size, void *address) {
+    C_ASSERT(file_name != NULL, return NULL);
+
+    #ifdef _WIN32
+        if(address != NULL)
+            return NULL;
+
+        HANDLE file = CreateFileA(file_name, GENERIC_READ | GENERIC_WRITE,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                  OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file == INVALID_HANDLE_VALUE)
+            return NULL;
+
+        //mapping object extends file if it is smaller than size
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE,
+                                            (DWORD)((uint64_t)size >> 32),
+                                            (DWORD)size, NULL);
+        void  *view    = NULL;
+        if(mapping != NULL) {
+            view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+            CloseHandle(mapping);
+        }
+
+        CloseHandle(file);
+        return view;
+    #else
+        int file = open(file_name, O_RDWR | O_CREAT, 0644);
+        if(file < 0)
+            return NULL;
+
+        struct stat file_info = {};
+        if(fstat(file, &file_info) != 0 ||
+           ((size_t)file_info.st_size < size && ftruncate(file, (off_t)size) != 0)) {
+            close(file);
+            return NULL;
+        }
+
+        int   flags   = MAP_SHARED | (address != NULL ? MAP_FIXED : 0);
+        void *mapping = mmap(address, size, PROT_READ | PROT_WRITE, flags, file, 0);
+        close(file);
+        if(mapping == MAP_FAILED)
+            return NULL;
+
+        return mapping;
+    #endif
+}
+
+/**
+======================================================================================================
+    @brief      Unmaps file mapped by pages_map_file(...).
+
+    @details    Mapping with fixed address is unmapped together with pages
+                which it replaced if size covers them.
+
+    @param [in] address             Address returned by pages_map_file(...).
+    @param [in] size                Size of mapping.
+
+    @return Error code
+
+======================================================================================================
+*/
+pages_error_t pages_unmap_file(void *address, size_t size) {
+    if(address == NULL)
+        return PAGES_SUCCESS;
+
+    #ifdef _WIN32
+        (void)size;
+        if(!UnmapViewOfFile(address))
+            return PAGES_MAPPING_ERROR;
+    #else
+        if(munmap(address, pages_round_up(size)) != 0)
+            return PAGES_MAPPING_ERROR;
+    #endif
+
+    return PAGES_SUCCESS;
+}
+
+/**
+======================================================================================================
+    @brief      Advises system to use transparent huge pages for mapping.
+
+    @details    Makes sense for big mappings which are swept sequentially,
+                because TLB misses are reduced. Advice is supported only on Linux.
+
+    @param [in] address             Address returned by pages_map(...).
+    @param [in] size                Size of mapping.
+
+    @return Error code
+
+======================================================================================================
+*/
+pages_error_t pages_advise_huge(void *address, size_t size) {
+    C_ASSERT(address != NULL, return PAGES_ADVICE_ERROR);
+
+    #if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if(madvise(address, pages_round_up(size), MADV_HUGEPAGE) != 0)
+            return PAGES_ADVICE_ERROR;
+
+        return PAGES_SUCCESS;
+    #else
+        (void)size;
+        return PAGES_ADVICE_ERROR;
+    #endif
+}
+
+/**
+======================================================================================================
+    @brief      Registers handler of access violations.
+
+    @details    The first call installs process-wide SIGSEGV/SIGBUS handler
+                (vectored exception handler on Windows), which asks every registered
+                handler if faulting address belongs to it.
+
+    @param [in] handler             Fault handler.
+    @param [in] context             Pointer passed to handler.
+
+    @return Error code
+
+======================================================================================================
+*/
+pages_error_t pages_add_fault_handler(pages_fault_handler_t handler, void *context) {
+    C_ASSERT(handler != NULL, return PAGES_HANDLER_ERROR);
+
+    if(!fault_dispatcher_installed) {
+        pages_error_t error_code = install_fault_dispatcher();
+        if(error_code != PAGES_SUCCESS)
+            return error_code;
+    }
+
+    for(size_t index = 0; index < max_fault_handlers; index++) {
+        if(fault_handlers[index].handler == NULL) {
+            fault_handlers[index].context = context;
+            fault_handlers[index].handler = handler;
+            return PAGES_SUCCESS;
+        }
+    }
+
+    return PAGES_HANDLER_ERROR;
+}
+
+/**
+======================================================================================================
+    @brief      Removes handler registered with pages_add_fault_handler(...).
+
+======================================================================================================
+*/
+pages_error_t pages_remove_fault_handler(pages_fault_handler_t handler, void *context) {
+    for(size_t index = 0; index < max_fault_handlers; index++) {
+        if(fault_handlers[index].handler == handler &&
+           fault_handlers[index].context == context) {
+            fault_handlers[index].handler = NULL;
+            fault_handlers[index].context = NULL;
+            return PAGES_SUCCESS;
+        }
+    }
+
+    return PAGES_HANDLER_ERROR;
+}
+
+/**
+======================================================================================================
+    @brief      Asks registered handlers if fault address belongs to them.
+
+======================================================================================================
+*/
+pages_fault_action_t dispatch_fault(void *fault_address) {
+    for(size_t index = 0; index < max_fault_handlers; index++) {
+        if(fault_handlers[index].handler == NULL)
+            continue;
+
+        pages_fault_action_t action = fault_handlers[index].handler(fault_address,
+                                                                    fault_handlers[index].context);
+        if(action != PAGES_FAULT_IGNORED)
+            return action;
+    }
+
+    return PAGES_FAULT_IGNORED;
+}
+
+#ifdef _WIN32
+    pages_error_t install_fault_dispatcher(void) {
+        if(AddVectoredExceptionHandler(1, fault_dispatcher) == NULL)
+            return PAGES_HANDLER_ERROR;
+
+        fault_dispatcher_installed = true;
+        return PAGES_SUCCESS;
+    }
+
+    LONG WINAPI fault_dispatcher(EXCEPTION_POINTERS *exception) {
+        EXCEPTION_RECORD *record = exception->ExceptionRecord;
+        if(record->ExceptionCode != EXCEPTION_ACCESS_VIOLATION)
+            return EXCEPTION_CONTINUE_SEARCH;
+
+        switch(dispatch_fault((void *)record->ExceptionInformation[1])) {
+            case PAGES_FAULT_CONTINUE:
+                return EXCEPTION_CONTINUE_EXECUTION;
+            case PAGES_FAULT_TERMINATE:
+                ExitProcess(EXIT_FAILURE);
+            case PAGES_FAULT_IGNORED:
+            default:
+                return EXCEPTION_CONTINUE_SEARCH;
+        }
+    }
+
+    DWORD get_protection(pages_access_t access) {
+        switch(access) {
+            case PAGES_NO_ACCESS:
+                return PAGE_NOACCESS;
+            case PAGES_READ_ONLY:
+                return PAGE_READONLY;
+            case PAGES_READ_WRITE:
+                return PAGE_READWRITE;
+            default:
+                return PAGE_NOACCESS;
+        }
+    }
+#else
+    pages_error_t install_fault_dispatcher(void) {
+        struct sigaction action = {};
+        action.sa_sigaction = fault_dispatcher;
+        action.sa_flags     = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+
+        if(sigaction(SIGSEGV, &action, &previous_segv_action) != 0)
+            return PAGES_HANDLER_ERROR;
+
+        if(sigaction(SIGBUS,  &action, &previous_bus_action ) != 0)
+            return PAGES_HANDLER_ERROR;
+
+        fault_dispatcher_installed = true;
+        return PAGES_SUCCESS;
+    }
+
+    //------------------------------------------------------------------------------
+    //FAULTING INSTRUCTION IS EXECUTED AGAIN AFTER RETURN. IF HANDLER DID NOT MAKE
+    //ADDRESS ACCESSIBLE, PREVIOUS ACTION IS RESTORED BEFORE IT, SO PROCESS IS
+    //TERMINATED (OR HANDLED) AS WITHOUT US
+    //------------------------------------------------------------------------------
+    void fault_dispatcher(int signal_number, siginfo_t *info, void */*context*/) {
+        if(dispatch_fault(info->si_addr) == PAGES_FAULT_CONTINUE)
+            return ;
+
+        struct sigaction *previous_action = &previous_segv_action;
+        if(signal_number == SIGBUS)
+            previous_action = &previous_bus_action;
+
+        sigaction(signal_number, previous_action, NULL);
+    }
+
+    int get_protection(pages_access_t access) {
+        switch(access) {
+            case PAGES_NO_ACCESS:
+                return PROT_NONE;
+            case PAGES_READ_ONLY:
+                return PROT_READ;
+            case PAGES_READ_WRITE:
+                return PROT_READ | PROT_WRITE;
+            default:
+                return PROT_NONE;
+        }
+    }
+#endif
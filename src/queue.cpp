@@ -0,0 +1,611 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "queue.h"
+#include "memory.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//==============================================================================
+//PROTECTION MODES ON
+//==============================================================================
+#define QUEUE_CANARY_PROTECTION
+
+static const size_t cache_line_size = 64;
+
+//==============================================================================
+//CHECK IF QUEUE IS VALID, WRITE DUMP AND RETURN ERROR IF NOT
+//QUEUE IS SHARED BETWEEN THREADS, SO IT IS NOT DESTROYED HERE
+//ERROR IS KEPT IN LOCAL NAMED BY CALLER, SO RETURN VALUE CAN USE IT
+//==============================================================================
+#ifdef QUEUE_CANARY_PROTECTION
+    #define QUEUE_VERIFY(__queue_pointer, __error_code, __return_value) {\
+        queue_error_t __error_code = queue_verify(__queue_pointer);     \
+        if(__error_code != QUEUE_SUCCESS) {                             \
+            QUEUE_DUMP((__queue_pointer), (__error_code));              \
+            return (__return_value);                                    \
+        }                                                               \
+    }
+#else
+    #define QUEUE_VERIFY(__queue_pointer, __error_code, __return_value)
+#endif
+
+#ifndef STACK_WRITE_DUMP
+    #define QUEUE_DUMP(...)
+#endif
+
+//==============================================================================
+//PROTECTION OF QUEUE WITH CANARIES MODE
+//==============================================================================
+#ifdef QUEUE_CANARY_PROTECTION
+    typedef uint64_t canary_t;
+
+    static const canary_t CANARY_HEX_SPEAK = 0xC0FFEEC0FFEE;
+
+    static void          queue_update_canary(queue_t *queue);
+    static queue_error_t queue_verify       (queue_t *queue);
+#endif
+
+//==============================================================================
+//THE DEFINITION OF QUEUE STRUCTURE
+//CONSUMER AND PRODUCER INDICES ARE PLACED IN DIFFERENT CACHE LINES, EACH SIDE
+//KEEPS COPY OF OTHER SIDE INDEX TO READ SHARED CACHE LINE ONLY WHEN NEEDED.
+//IN MPMC QUEUE EVERY SLOT STARTS WITH SEQUENCE NUMBER WHICH TELLS IF SLOT IS
+//READY FOR ENQUEUE (SEQUENCE == POSITION) OR DEQUEUE (SEQUENCE == POSITION + 1)
+//==============================================================================
+struct queue_t {
+    #ifdef QUEUE_CANARY_PROTECTION
+        canary_t structure_left_canary;
+    #endif
+
+    alignas(cache_line_size) size_t head;
+    size_t                          cached_tail;
+
+    alignas(cache_line_size) size_t tail;
+    size_t                          cached_head;
+
+    alignas(cache_line_size) queue_kind_t kind;
+    size_t                                capacity;
+    size_t                                mask;
+    size_t                                element_size;
+    size_t                                slot_size;
+    char *                                data;
+
+    #ifdef QUEUE_CANARY_PROTECTION
+        canary_t *data_left_canary;
+        canary_t *data_right_canary;
+    #endif
+
+    #ifdef STACK_WRITE_DUMP
+        FILE *      dump_file;
+        const char *dump_filename;
+        const char *initialized_file;
+        const char *initialized_varname;
+        const char *initialized_function;
+        size_t      initialized_line;
+        int       (*print_func)(FILE *, void *);
+    #endif
+
+    #ifdef QUEUE_CANARY_PROTECTION
+        canary_t structure_right_canary;
+    #endif
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static char *         get_slot          (queue_t *queue,
+                                         size_t   position);
+static size_t *       get_sequence      (queue_t *queue,
+                                         size_t   position);
+static char *         get_element       (queue_t *queue,
+                                         size_t   position);
+static size_t         spsc_enqueue_batch(queue_t    *queue,
+                                         const char *elements,
+                                         size_t      count);
+static size_t         spsc_dequeue_batch(queue_t    *queue,
+                                         char       *output,
+                                         size_t      count);
+static size_t         mpmc_enqueue_batch(queue_t    *queue,
+                                         const char *elements,
+                                         size_t      count);
+static size_t         mpmc_dequeue_batch(queue_t    *queue,
+                                         char       *output,
+                                         size_t      count);
+
+//==============================================================================
+//GLOBAL FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//INITIALIZES QUEUE, CAPACITY MUST BE POWER OF TWO
+//------------------------------------------------------------------------------
+queue_t *queue_init(STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                        const char *initialized_file,
+                                        const char *initialized_varname,
+                                        const char *initialized_function,
+                                        size_t      initialized_line,
+                                        int       (*print_func)(FILE *, void *),)
+                    queue_kind_t kind,
+                    size_t       capacity,
+                    size_t       element_size) {
+    C_ASSERT(capacity != 0 && (capacity & (capacity - 1)) == 0, return NULL);
+    C_ASSERT(element_size != 0                                 , return NULL);
+    C_ASSERT(kind == QUEUE_SPSC || kind == QUEUE_MPMC          , return NULL);
+    #ifdef STACK_WRITE_DUMP
+        C_ASSERT(dump_filename        != NULL, return NULL);
+        C_ASSERT(initialized_file     != NULL, return NULL);
+        C_ASSERT(initialized_varname  != NULL, return NULL);
+        C_ASSERT(initialized_function != NULL, return NULL);
+        C_ASSERT(print_func           != NULL, return NULL);
+    #endif
+
+    queue_t *queue = (queue_t *)_aligned_calloc(1, sizeof(queue_t), cache_line_size);
+    if(queue == NULL)
+        return NULL;
+
+    queue->kind         = kind;
+    queue->capacity     = capacity;
+    queue->mask         = capacity - 1;
+    queue->element_size = element_size;
+    queue->slot_size    = (element_size + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+    if(kind == QUEUE_MPMC)
+        queue->slot_size += sizeof(size_t);
+
+    size_t allocated_size = capacity * queue->slot_size;
+    #ifdef QUEUE_CANARY_PROTECTION
+        allocated_size += 2 * sizeof(canary_t);
+    #endif
+
+    queue->data = (char *)_calloc(allocated_size, 1);
+    if(queue->data == NULL) {
+        queue_destroy(&queue);
+        return NULL;
+    }
+
+    #ifdef QUEUE_CANARY_PROTECTION
+        queue->data += sizeof(canary_t);
+    #endif
+
+    if(kind == QUEUE_MPMC)
+        for(size_t position = 0; position < capacity; position++)
+            *get_sequence(queue, position) = position;
+
+    #ifdef STACK_WRITE_DUMP
+        queue->dump_filename        = dump_filename       ;
+        queue->initialized_file     = initialized_file    ;
+        queue->initialized_varname  = initialized_varname ;
+        queue->initialized_function = initialized_function;
+        queue->initialized_line     = initialized_line    ;
+        queue->print_func           = print_func          ;
+
+        queue->dump_file = fopen(queue->dump_filename, "wb");
+        if(queue->dump_file == NULL) {
+            queue_destroy(&queue);
+            return NULL;
+        }
+    #endif
+
+    #ifdef QUEUE_CANARY_PROTECTION
+        queue_update_canary(queue);
+    #endif
+
+    return queue;
+}
+
+//------------------------------------------------------------------------------
+//PUTS ELEMENT IN THE END OF QUEUE
+//------------------------------------------------------------------------------
+queue_error_t queue_enqueue(queue_t    *queue,
+                            const void *element) {
+    C_ASSERT(queue   != NULL, return QUEUE_NULL         );
+    C_ASSERT(element != NULL, return QUEUE_INVALID_INPUT);
+
+    QUEUE_VERIFY(queue, error_code, error_code);
+
+    size_t enqueued = 0;
+    if(queue->kind == QUEUE_SPSC)
+        enqueued = spsc_enqueue_batch(queue, (const char *)element, 1);
+    else
+        enqueued = mpmc_enqueue_batch(queue, (const char *)element, 1);
+
+    if(enqueued == 0)
+        return QUEUE_FULL;
+
+    return QUEUE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//TAKES ELEMENT FROM THE BEGINNING OF QUEUE, WRITES ELEMENT TO OUTPUT
+//------------------------------------------------------------------------------
+queue_error_t queue_dequeue(queue_t *queue,
+                            void    *output) {
+    C_ASSERT(queue  != NULL, return QUEUE_NULL          );
+    C_ASSERT(output != NULL, return QUEUE_INVALID_OUTPUT);
+
+    QUEUE_VERIFY(queue, error_code, error_code);
+
+    size_t dequeued = 0;
+    if(queue->kind == QUEUE_SPSC)
+        dequeued = spsc_dequeue_batch(queue, (char *)output, 1);
+    else
+        dequeued = mpmc_dequeue_batch(queue, (char *)output, 1);
+
+    if(dequeued == 0)
+        return QUEUE_EMPTY;
+
+    return QUEUE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//PUTS UP TO COUNT ELEMENTS IN THE END OF QUEUE, RETURNS NUMBER OF PUT ELEMENTS
+//------------------------------------------------------------------------------
+size_t queue_enqueue_batch(queue_t    *queue,
+                           const void *elements,
+                           size_t      count) {
+    C_ASSERT(queue    != NULL, return 0);
+    C_ASSERT(elements != NULL, return 0);
+
+    QUEUE_VERIFY(queue, error_code, 0);
+
+    if(queue->kind == QUEUE_SPSC)
+        return spsc_enqueue_batch(queue, (const char *)elements, count);
+    else
+        return mpmc_enqueue_batch(queue, (const char *)elements, count);
+}
+
+//------------------------------------------------------------------------------
+//TAKES UP TO COUNT ELEMENTS FROM QUEUE, RETURNS NUMBER OF TAKEN ELEMENTS
+//------------------------------------------------------------------------------
+size_t queue_dequeue_batch(queue_t *queue,
+                           void    *output,
+                           size_t   count) {
+    C_ASSERT(queue  != NULL, return 0);
+    C_ASSERT(output != NULL, return 0);
+
+    QUEUE_VERIFY(queue, error_code, 0);
+
+    if(queue->kind == QUEUE_SPSC)
+        return spsc_dequeue_batch(queue, (char *)output, count);
+    else
+        return mpmc_dequeue_batch(queue, (char *)output, count);
+}
+
+//------------------------------------------------------------------------------
+//RETURNS NUMBER OF ELEMENTS IN QUEUE
+//WHILE OTHER THREADS USE QUEUE IT IS ONLY ESTIMATION
+//------------------------------------------------------------------------------
+size_t queue_size(queue_t *queue) {
+    C_ASSERT(queue != NULL, return 0);
+
+    size_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if(tail - head > queue->capacity)
+        return 0;
+
+    return tail - head;
+}
+
+//------------------------------------------------------------------------------
+//DESTROYS QUEUE, IT IS EXPECTED THAT NO THREAD USES IT ANYMORE
+//------------------------------------------------------------------------------
+queue_error_t queue_destroy(queue_t **queue) {
+    C_ASSERT(queue != NULL, return QUEUE_NULL);
+
+    if(*queue == NULL)
+        return QUEUE_SUCCESS;
+
+    char *allocated = (*queue)->data;
+    #ifdef QUEUE_CANARY_PROTECTION
+        if(allocated != NULL)
+            allocated -= sizeof(canary_t);
+    #endif
+    _free(allocated);
+
+    #ifdef STACK_WRITE_DUMP
+        if((*queue)->dump_file != NULL)
+            fclose((*queue)->dump_file);
+    #endif
+
+    _aligned_free(*queue);
+    *queue = NULL;
+    return QUEUE_SUCCESS;
+}
+
+//==============================================================================
+//STATIC FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//RETURNS SLOT OF POSITION, POSITIONS GROW INFINITELY AND ARE WRAPPED BY MASK
+//------------------------------------------------------------------------------
+char *get_slot(queue_t *queue,
+               size_t   position) {
+    return queue->data + (position & queue->mask) * queue->slot_size;
+}
+
+//------------------------------------------------------------------------------
+//RETURNS SEQUENCE NUMBER OF MPMC QUEUE SLOT
+//------------------------------------------------------------------------------
+size_t *get_sequence(queue_t *queue,
+                     size_t   position) {
+    return (size_t *)get_slot(queue, position);
+}
+
+//------------------------------------------------------------------------------
+//RETURNS ELEMENT STORAGE OF SLOT
+//------------------------------------------------------------------------------
+char *get_element(queue_t *queue,
+                  size_t   position) {
+    if(queue->kind == QUEUE_MPMC)
+        return get_slot(queue, position) + sizeof(size_t);
+
+    return get_slot(queue, position);
+}
+
+//------------------------------------------------------------------------------
+//SPSC ENQUEUE, ONLY PRODUCER WRITES TAIL AND CACHED HEAD
+//------------------------------------------------------------------------------
+size_t spsc_enqueue_batch(queue_t    *queue,
+                          const char *elements,
+                          size_t      count) {
+    size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+
+    if(queue->capacity - (tail - queue->cached_head) < count)
+        queue->cached_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    size_t free_slots = queue->capacity - (tail - queue->cached_head);
+    if(count > free_slots)
+        count = free_slots;
+
+    for(size_t index = 0; index < count; index++)
+        memcpy(get_element(queue, tail + index),
+               elements + index * queue->element_size,
+               queue->element_size);
+
+    __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+//------------------------------------------------------------------------------
+//SPSC DEQUEUE, ONLY CONSUMER WRITES HEAD AND CACHED TAIL
+//------------------------------------------------------------------------------
+size_t spsc_dequeue_batch(queue_t *queue,
+                          char    *output,
+                          size_t   count) {
+    size_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+
+    if(queue->cached_tail - head < count)
+        queue->cached_tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    size_t used_slots = queue->cached_tail - head;
+    if(count > used_slots)
+        count = used_slots;
+
+    for(size_t index = 0; index < count; index++)
+        memcpy(output + index * queue->element_size,
+               get_element(queue, head + index),
+               queue->element_size);
+
+    __atomic_store_n(&queue->head, head + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+//------------------------------------------------------------------------------
+//MPMC ENQUEUE: PRODUCER CLAIMS ALL CONSECUTIVE FREE SLOTS WITH ONE CAS ON TAIL.
+//SLOT SEQUENCE CAN BECOME EQUAL TO POSITION ONLY BEFORE TAIL PASSES POSITION,
+//SO IF CAS SUCCEEDS ALL CHECKED SLOTS ARE STILL FREE
+//------------------------------------------------------------------------------
+size_t mpmc_enqueue_batch(queue_t    *queue,
+                          const char *elements,
+                          size_t      count) {
+    size_t tail    = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    size_t claimed = 0;
+
+    while(true) {
+        claimed = 0;
+        while(claimed < count &&
+              __atomic_load_n(get_sequence(queue, tail + claimed), __ATOMIC_ACQUIRE) ==
+              tail + claimed)
+            claimed++;
+
+        if(claimed == 0) {
+            size_t sequence = __atomic_load_n(get_sequence(queue, tail), __ATOMIC_ACQUIRE);
+            if((intptr_t)(sequence - tail) < 0 || count == 0)
+                return 0;
+
+            tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if(__atomic_compare_exchange_n(&queue->tail, &tail, tail + claimed, true,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+
+    for(size_t index = 0; index < claimed; index++) {
+        memcpy(get_element(queue, tail + index),
+               elements + index * queue->element_size,
+               queue->element_size);
+        __atomic_store_n(get_sequence(queue, tail + index), tail + index + 1, __ATOMIC_RELEASE);
+    }
+
+    return claimed;
+}
+
+//------------------------------------------------------------------------------
+//MPMC DEQUEUE: CONSUMER CLAIMS ALL CONSECUTIVE FILLED SLOTS WITH ONE CAS ON
+//HEAD, AFTER COPYING SLOT IS MARKED FREE FOR POSITION OF THE NEXT LAP
+//------------------------------------------------------------------------------
+size_t mpmc_dequeue_batch(queue_t *queue,
+                          char    *output,
+                          size_t   count) {
+    size_t head    = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    size_t claimed = 0;
+
+    while(true) {
+        claimed = 0;
+        while(claimed < count &&
+              __atomic_load_n(get_sequence(queue, head + claimed), __ATOMIC_ACQUIRE) ==
+              head + claimed + 1)
+            claimed++;
+
+        if(claimed == 0) {
+            size_t sequence = __atomic_load_n(get_sequence(queue, head), __ATOMIC_ACQUIRE);
+            if((intptr_t)(sequence - (head + 1)) < 0 || count == 0)
+                return 0;
+
+            head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if(__atomic_compare_exchange_n(&queue->head, &head, head + claimed, true,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+
+    for(size_t index = 0; index < claimed; index++) {
+        memcpy(output + index * queue->element_size,
+               get_element(queue, head + index),
+               queue->element_size);
+        __atomic_store_n(get_sequence(queue, head + index),
+                         head + index + queue->capacity,
+                         __ATOMIC_RELEASE);
+    }
+
+    return claimed;
+}
+
+//==============================================================================
+//QUEUE CANARY PROTECTION MODE FUNCTIONS DEFINITION
+//==============================================================================
+#ifdef QUEUE_CANARY_PROTECTION
+    //------------------------------------------------------------------------------
+    //SETS CANARIES AROUND QUEUE STRUCTURE AND DATA
+    //------------------------------------------------------------------------------
+    void queue_update_canary(queue_t *queue) {
+        queue->data_left_canary  = (canary_t *)(queue->data - sizeof(canary_t));
+        queue->data_right_canary = (canary_t *)(queue->data +
+                                                queue->capacity *
+                                                queue->slot_size);
+
+        *(queue->data_left_canary ) = (canary_t)queue->data ^ CANARY_HEX_SPEAK;
+        *(queue->data_right_canary) = (canary_t)queue->data ^ CANARY_HEX_SPEAK;
+
+        queue->structure_left_canary  = (canary_t)queue ^ CANARY_HEX_SPEAK;
+        queue->structure_right_canary = (canary_t)queue ^ CANARY_HEX_SPEAK;
+    }
+
+    //------------------------------------------------------------------------------
+    //CHECKS CANARIES, ONLY FIELDS WHICH ARE NOT CHANGED AFTER INIT ARE READ
+    //------------------------------------------------------------------------------
+    queue_error_t queue_verify(queue_t *queue) {
+        if(queue->structure_left_canary  != ((canary_t)queue ^ CANARY_HEX_SPEAK))
+            return QUEUE_UNEXPECTED_LEFT_CANARY;
+
+        if(queue->structure_right_canary != ((canary_t)queue ^ CANARY_HEX_SPEAK))
+            return QUEUE_UNEXPECTED_RIGHT_CANARY;
+
+        if(*(queue->data_left_canary ) != ((canary_t)queue->data ^ CANARY_HEX_SPEAK))
+            return QUEUE_UNEXPECTED_DATA_LEFT_CANARY;
+
+        if(*(queue->data_right_canary) != ((canary_t)queue->data ^ CANARY_HEX_SPEAK))
+            return QUEUE_UNEXPECTED_DATA_RIGHT_CANARY;
+
+        return QUEUE_SUCCESS;
+    }
+#endif
+
+//==============================================================================
+//STACK WRITE DUMP MODE FUNCTIONS DEFINITION
+//==============================================================================
+#ifdef STACK_WRITE_DUMP
+    //------------------------------------------------------------------------------
+    //WRITES QUEUE INFORMATION IN DUMP FILE, ELEMENTS FROM HEAD TO TAIL.
+    //WHILE OTHER THREADS USE QUEUE ELEMENTS CAN BE CHANGED DURING DUMP
+    //------------------------------------------------------------------------------
+    queue_error_t queue_dump(queue_t      *queue,
+                             const char   *file_name,
+                             const char   *function_name,
+                             size_t        line,
+                             queue_error_t call_reason) {
+        if(queue == NULL)
+            return QUEUE_NULL;
+
+        if(queue->dump_file == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "MEMORY DUMP FILE ERROR\r\n"
+                         "called from: %s:%llu\r\n",
+                         file_name,
+                         line);
+            return QUEUE_DUMP_ERROR;
+        }
+
+        size_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+        if(fprintf(queue->dump_file,
+                   "queue_t[0x%p] initialized in %s:%llu as "
+                   "'queue_t %s' in function '%s'\r\n"
+                   "dump called from %s:%llu '%s'\r\n"
+                   "ERROR = %d\r\n"
+                   "{\r\n"
+                   "\tkind              =   %s;\r\n"
+                   "\thead              =   %llu;\r\n"
+                   "\ttail              =   %llu;\r\n"
+                   "\tcapacity          =   %llu;\r\n"
+                   "\telement_size      =   %llu;\r\n"
+                   "\tdata[0x%p];\r\n",
+                   queue,
+                   queue->initialized_file,
+                   queue->initialized_line,
+                   queue->initialized_varname,
+                   queue->initialized_function,
+                   file_name,
+                   line,
+                   function_name,
+                   call_reason,
+                   queue->kind == QUEUE_SPSC ? "SPSC" : "MPMC",
+                   head,
+                   tail,
+                   queue->capacity,
+                   queue->element_size,
+                   queue->data) < 0)
+            return QUEUE_DUMP_ERROR;
+
+        #ifdef QUEUE_CANARY_PROTECTION
+            if(fprintf(queue->dump_file,
+                       "\tcanary_left       = 0x%llx;\r\n"
+                       "\tdata_canary_left [0x%p] = 0x%llx;\r\n"
+                       "\tdata_canary_right[0x%p] = 0x%llx;\r\n"
+                       "\tcanary_right      = 0x%llx;\r\n",
+                       queue->structure_left_canary,
+                       queue->data_left_canary,
+                       *(queue->data_left_canary),
+                       queue->data_right_canary,
+                       *(queue->data_right_canary),
+                       queue->structure_right_canary) < 0)
+                return QUEUE_DUMP_ERROR;
+        #endif
+
+        for(size_t position = head; position != tail && position - head < queue->capacity; position++) {
+            if(fprintf(queue->dump_file, "\t    [%llu] = ", position & queue->mask) < 0)
+                return QUEUE_DUMP_ERROR;
+
+            if(queue->print_func(queue->dump_file, get_element(queue, position)) < 0)
+                return QUEUE_DUMP_ERROR;
+
+            if(fprintf(queue->dump_file, ";\r\n") < 0)
+                return QUEUE_DUMP_ERROR;
+        }
+
+        if(fprintf(queue->dump_file,
+                   "}\r\n\r\n") < 0)
+            return QUEUE_DUMP_ERROR;
+
+        fflush(queue->dump_file);
+        return QUEUE_SUCCESS;
+    }
+#endif
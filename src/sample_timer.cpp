@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <signal.h>
+    #include <sys/time.h>
+#endif
+
+#include "sample_timer.h"
+#include "custom_assert.h"
+
+/**
+======================================================================================================
+    @brief      Started timer, it is global because it is used by signal handler.
+
+======================================================================================================
+*/
+struct sample_timer_t {
+    sample_timer_callback_t  callback;
+    void                    *context;
+#ifdef _WIN32
+    HANDLE                   sampled_thread;
+    HANDLE                   timer_thread;
+    DWORD                    period;
+    volatile LONG            is_stopped;
+#else
+    struct sigaction         previous_action;
+    struct itimerval         previous_timer;
+#endif
+};
+
+static sample_timer_t sample_timer      = {};
+static bool           is_timer_started  = false;
+
+//====================================================================================================
+//FUNCTIONS PROTOTYPES
+//====================================================================================================
+#ifdef _WIN32
+    static DWORD WINAPI sample_timer_thread(void *parameter);
+#else
+    static void         sample_signal      (int   signal_number);
+#endif
+
+#ifdef _WIN32
+    /**
+    ======================================================================================================
+        @brief      Starts timer.
+
+        @details    Timer thread wakes up every period, suspends thread which
+                    started timer and calls callback. Period is rounded to
+                    milliseconds, so frequency is at most 1000 Hz.
+
+        @param [in] frequency           Frequency of callback calls in Hz.
+        @param [in] callback            Callback.
+        @param [in] context             Parameter of callback.
+
+        @return Error code
+
+    ======================================================================================================
+    */
+    sample_timer_error_t sample_timer_start(size_t                  frequency,
+                                            sample_timer_callback_t callback,
+                                            void                   *context) {
+        C_ASSERT(callback  != NULL, return SAMPLE_TIMER_START_ERROR);
+        C_ASSERT(frequency != 0   , return SAMPLE_TIMER_START_ERROR);
+        if(is_timer_started)
+            return SAMPLE_TIMER_STARTED_ERROR;
+
+        sample_timer.callback   = callback;
+        sample_timer.context    = context;
+        sample_timer.is_stopped = 0;
+        sample_timer.period     = (DWORD)(1000 / frequency);
+        if(sample_timer.period == 0)
+            sample_timer.period = 1;
+
+        if(!DuplicateHandle(GetCurrentProcess(),
+                            GetCurrentThread(),
+                            GetCurrentProcess(),
+                            &sample_timer.sampled_thread,
+                            0,
+                            FALSE,
+                            DUPLICATE_SAME_ACCESS))
+            return SAMPLE_TIMER_START_ERROR;
+
+        sample_timer.timer_thread = CreateThread(NULL, 0, sample_timer_thread, NULL, 0, NULL);
+        if(sample_timer.timer_thread == NULL) {
+            CloseHandle(sample_timer.sampled_thread);
+            return SAMPLE_TIMER_START_ERROR;
+        }
+
+        is_timer_started = true;
+        return SAMPLE_TIMER_SUCCESS;
+    }
+
+    /**
+    ======================================================================================================
+        @brief      Stops timer and waits for timer thread.
+
+    ======================================================================================================
+    */
+    void sample_timer_stop(void) {
+        if(!is_timer_started)
+            return ;
+
+        InterlockedExchange(&sample_timer.is_stopped, 1);
+        WaitForSingleObject(sample_timer.timer_thread, INFINITE);
+        CloseHandle(sample_timer.timer_thread);
+        CloseHandle(sample_timer.sampled_thread);
+        is_timer_started = false;
+    }
+
+    /**
+    ======================================================================================================
+        @brief      Timer thread.
+
+    ======================================================================================================
+    */
+    DWORD WINAPI sample_timer_thread(void *parameter) {
+        (void)parameter;
+        while(InterlockedCompareExchange(&sample_timer.is_stopped, 0, 0) == 0) {
+            Sleep(sample_timer.period);
+            if(SuspendThread(sample_timer.sampled_thread) == (DWORD)-1)
+                continue;
+
+            sample_timer.callback(sample_timer.context);
+            ResumeThread(sample_timer.sampled_thread);
+        }
+
+        return 0;
+    }
+#else
+    /**
+    ======================================================================================================
+        @brief      Starts timer.
+
+        @details    ITIMER_PROF counts processor time of process and sends SIGPROF,
+                    so process waiting for input is not sampled. Handler is
+                    installed with SA_RESTART, so interrupted input is restarted.
+
+        @param [in] frequency           Frequency of callback calls in Hz.
+        @param [in] callback            Callback.
+        @param [in] context             Parameter of callback.
+
+        @return Error code
+
+    ======================================================================================================
+    */
+    sample_timer_error_t sample_timer_start(size_t                  frequency,
+                                            sample_timer_callback_t callback,
+                                            void                   *context) {
+        C_ASSERT(callback  != NULL, return SAMPLE_TIMER_START_ERROR);
+        C_ASSERT(frequency != 0   , return SAMPLE_TIMER_START_ERROR);
+        if(is_timer_started)
+            return SAMPLE_TIMER_STARTED_ERROR;
+
+        sample_timer.callback = callback;
+        sample_timer.context  = context;
+
+        struct sigaction action = {};
+        action.sa_handler = sample_signal;
+        action.sa_flags   = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if(sigaction(SIGPROF, &action, &sample_timer.previous_action) != 0)
+            return SAMPLE_TIMER_START_ERROR;
+
+        size_t           period = 1000000 / frequency;
+        struct itimerval timer  = {};
+        if(period == 0)
+            period = 1;
+
+        timer.it_interval.tv_sec  = (time_t     )(period / 1000000);
+        timer.it_interval.tv_usec = (suseconds_t)(period % 1000000);
+        timer.it_value            = timer.it_interval;
+        if(setitimer(ITIMER_PROF, &timer, &sample_timer.previous_timer) != 0) {
+            sigaction(SIGPROF, &sample_timer.previous_action, NULL);
+            return SAMPLE_TIMER_START_ERROR;
+        }
+
+        is_timer_started = true;
+        return SAMPLE_TIMER_SUCCESS;
+    }
+
+    /**
+    ======================================================================================================
+        @brief      Stops timer and restores previous SIGPROF handler.
+
+    ======================================================================================================
+    */
+    void sample_timer_stop(void) {
+        if(!is_timer_started)
+            return ;
+
+        setitimer(ITIMER_PROF, &sample_timer.previous_timer, NULL);
+        sigaction(SIGPROF, &sample_timer.previous_action, NULL);
+        is_timer_started = false;
+    }
+
+    /**
+    ======================================================================================================
+        @brief      SIGPROF handler.
+
+    ======================================================================================================
+    */
+    void sample_signal(int signal_number) {
+        (void)signal_number;
+        if(is_timer_started)
+            sample_timer.callback(sample_timer.context);
+    }
+#endif
@@ -0,0 +1,318 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "segmented_stack.h"
+#include "memory.h"
+#include "colors.h"
+#include "custom_assert.h"
+
+//==============================================================================
+//THE DEFINITION OF CHUNK STRUCTURE
+//CHUNK DATA IS PLACED RIGHT AFTER STRUCTURE IN THE SAME ALLOCATION
+//==============================================================================
+struct stack_chunk_t {
+    stack_chunk_t *previous;
+    stack_chunk_t *next;
+    size_t         size;
+    char *         data;
+};
+
+//==============================================================================
+//THE DEFINITION OF SEGMENTED STACK STRUCTURE
+//==============================================================================
+struct segmented_stack_t {
+    #ifdef STACK_WRITE_DUMP
+        FILE *      dump_file;
+        const char *dump_filename;
+        const char *initialized_file;
+        const char *initialized_varname;
+        const char *initialized_function;
+        size_t      initialized_line;
+        int       (*print_func)(FILE *, void *);
+    #endif
+
+    stack_chunk_t *current;
+    size_t         size;
+    size_t         chunks_number;
+    size_t         chunk_capacity;
+    size_t         element_size;
+};
+
+//==============================================================================
+//FUNCTIONS PROTOTYPES
+//==============================================================================
+static stack_chunk_t *chunk_create(size_t chunk_capacity,
+                                   size_t element_size);
+
+//==============================================================================
+//GLOBAL FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//INITIALIZES SEGMENTED STACK WITH ONE EMPTY CHUNK
+//------------------------------------------------------------------------------
+segmented_stack_t *segmented_stack_init(STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                                            const char *initialized_file,
+                                                            const char *initialized_varname,
+                                                            const char *initialized_function,
+                                                            size_t      initialized_line,
+                                                            int       (*print_func)(FILE *, void *),)
+                                        size_t chunk_capacity,
+                                        size_t element_size) {
+    C_ASSERT(chunk_capacity != 0, return NULL);
+    C_ASSERT(element_size   != 0, return NULL);
+    #ifdef STACK_WRITE_DUMP
+        C_ASSERT(dump_filename        != NULL, return NULL);
+        C_ASSERT(initialized_file     != NULL, return NULL);
+        C_ASSERT(initialized_varname  != NULL, return NULL);
+        C_ASSERT(initialized_function != NULL, return NULL);
+        C_ASSERT(print_func           != NULL, return NULL);
+    #endif
+
+    //size of chunk with its data must fit in size_t
+    if(chunk_capacity > (SIZE_MAX - sizeof(stack_chunk_t)) / element_size)
+        return NULL;
+
+    segmented_stack_t *stack = (segmented_stack_t *)_calloc_tagged(MEMORY_TAG_STACK,
+                                                                   1,
+                                                                   sizeof(segmented_stack_t));
+    if(stack == NULL)
+        return NULL;
+
+    stack->chunk_capacity = chunk_capacity;
+    stack->element_size   = element_size  ;
+
+    stack->current = chunk_create(chunk_capacity, element_size);
+    if(stack->current == NULL) {
+        segmented_stack_destroy(&stack);
+        return NULL;
+    }
+    stack->chunks_number = 1;
+
+    #ifdef STACK_WRITE_DUMP
+        stack->dump_filename        = dump_filename       ;
+        stack->initialized_file     = initialized_file    ;
+        stack->initialized_varname  = initialized_varname ;
+        stack->initialized_function = initialized_function;
+        stack->initialized_line     = initialized_line    ;
+        stack->print_func           = print_func          ;
+
+        stack->dump_file = fopen(stack->dump_filename, "wb");
+        if(stack->dump_file == NULL) {
+            segmented_stack_destroy(&stack);
+            return NULL;
+        }
+    #endif
+
+    return stack;
+}
+
+//------------------------------------------------------------------------------
+//PUSHES ELEMENT IN STACK
+//WHEN CURRENT CHUNK IS FULL MOVES TO SPARE CHUNK OR LINKS A NEW ONE
+//------------------------------------------------------------------------------
+stack_error_t segmented_stack_push(segmented_stack_t *stack,
+                                   const void        *element) {
+    C_ASSERT(stack   != NULL, return STACK_NULL         );
+    C_ASSERT(element != NULL, return STACK_INVALID_INPUT);
+
+    stack_chunk_t *chunk = stack->current;
+    if(chunk->size == stack->chunk_capacity) {
+        if(chunk->next == NULL) {
+            chunk->next = chunk_create(stack->chunk_capacity,
+                                       stack->element_size);
+            if(chunk->next == NULL)
+                return STACK_MEMORY_ERROR;
+
+            chunk->next->previous = chunk;
+            stack->chunks_number++;
+        }
+        chunk          = chunk->next;
+        stack->current = chunk;
+    }
+
+    memcpy(chunk->data + chunk->size * stack->element_size,
+           element,
+           stack->element_size);
+    chunk->size++;
+    stack->size++;
+    return STACK_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//POPS ELEMENT FROM STACK, WRITES ELEMENT TO OUTPUT
+//WHEN CURRENT CHUNK IS EMPTY MOVES TO PREVIOUS ONE AND KEEPS ONLY ONE SPARE
+//CHUNK, SO PUSH/POP ON CHUNK BORDER DOES NOT ALLOCATE AND FREE EVERY TIME
+//------------------------------------------------------------------------------
+stack_error_t segmented_stack_pop(segmented_stack_t *stack,
+                                  void              *output) {
+    C_ASSERT(stack  != NULL, return STACK_NULL          );
+    C_ASSERT(output != NULL, return STACK_INVALID_OUTPUT);
+
+    stack_chunk_t *chunk = stack->current;
+    if(chunk->size == 0) {
+        if(chunk->previous == NULL)
+            return STACK_EMPTY;
+
+        if(chunk->next != NULL) {
+            _free(chunk->next);
+            chunk->next = NULL;
+            stack->chunks_number--;
+        }
+        chunk          = chunk->previous;
+        stack->current = chunk;
+    }
+
+    chunk->size--;
+    stack->size--;
+
+    char *stack_storage = chunk->data + chunk->size * stack->element_size;
+    memcpy(output, stack_storage, stack->element_size);
+    memset(stack_storage, 0, stack->element_size);
+    return STACK_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//RETURNS NUMBER OF ELEMENTS IN STACK
+//------------------------------------------------------------------------------
+size_t segmented_stack_size(segmented_stack_t *stack) {
+    C_ASSERT(stack != NULL, return 0);
+
+    return stack->size;
+}
+
+//------------------------------------------------------------------------------
+//DESTROYS STACK AND ALL ITS CHUNKS
+//------------------------------------------------------------------------------
+stack_error_t segmented_stack_destroy(segmented_stack_t **stack) {
+    C_ASSERT(stack != NULL, return STACK_NULL);
+
+    if(*stack == NULL)
+        return STACK_SUCCESS;
+
+    stack_chunk_t *chunk = (*stack)->current;
+    if(chunk != NULL && chunk->next != NULL)
+        chunk = chunk->next;
+
+    while(chunk != NULL) {
+        stack_chunk_t *previous = chunk->previous;
+        _free(chunk);
+        chunk = previous;
+    }
+
+    #ifdef STACK_WRITE_DUMP
+        if((*stack)->dump_file != NULL)
+            fclose((*stack)->dump_file);
+    #endif
+
+    _free(*stack);
+    *stack = NULL;
+    return STACK_SUCCESS;
+}
+
+//==============================================================================
+//STATIC FUNCTIONS
+//==============================================================================
+
+//------------------------------------------------------------------------------
+//ALLOCATES CHUNK WITH DATA PLACED RIGHT AFTER CHUNK STRUCTURE
+//------------------------------------------------------------------------------
+stack_chunk_t *chunk_create(size_t chunk_capacity,
+                            size_t element_size) {
+    stack_chunk_t *chunk = (stack_chunk_t *)_calloc_tagged(MEMORY_TAG_STACK,
+                                                           sizeof(stack_chunk_t) +
+                                                           chunk_capacity *
+                                                           element_size,
+                                                           1);
+    if(chunk == NULL)
+        return NULL;
+
+    chunk->data = (char *)(chunk + 1);
+    return chunk;
+}
+
+//==============================================================================
+//STACK WRITE DUMP MODE FUNCTIONS DEFINITION
+//==============================================================================
+#ifdef STACK_WRITE_DUMP
+    //------------------------------------------------------------------------------
+    //WRITES SEGMENTED STACK INFORMATION IN DUMP FILE, CHUNKS FROM BOTTOM TO TOP
+    //------------------------------------------------------------------------------
+    stack_error_t segmented_stack_dump(segmented_stack_t *stack,
+                                       const char        *file_name,
+                                       const char        *function_name,
+                                       size_t             line,
+                                       stack_error_t      call_reason) {
+        if(stack == NULL)
+            return STACK_NULL;
+
+        if(stack->dump_file == NULL) {
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "MEMORY DUMP FILE ERROR\r\n"
+                         "called from: %s:%llu\r\n",
+                         file_name,
+                         line);
+            return STACK_DUMP_ERROR;
+        }
+
+        if(fprintf(stack->dump_file,
+                   "segmented_stack_t[0x%p] initialized in %s:%llu as "
+                   "'segmented_stack_t %s' in function '%s'\r\n"
+                   "dump called from %s:%llu '%s'\r\n"
+                   "ERROR = %d\r\n"
+                   "{\r\n"
+                   "\tsize              =   %llu;\r\n"
+                   "\tchunks_number     =   %llu;\r\n"
+                   "\tchunk_capacity    =   %llu;\r\n"
+                   "\telement_size      =   %llu;\r\n",
+                   stack,
+                   stack->initialized_file,
+                   stack->initialized_line,
+                   stack->initialized_varname,
+                   stack->initialized_function,
+                   file_name,
+                   line,
+                   function_name,
+                   call_reason,
+                   stack->size,
+                   stack->chunks_number,
+                   stack->chunk_capacity,
+                   stack->element_size) < 0)
+            return STACK_DUMP_ERROR;
+
+        stack_chunk_t *chunk = stack->current;
+        while(chunk->previous != NULL)
+            chunk = chunk->previous;
+
+        size_t index = 0;
+        for(; chunk != NULL && chunk->size != 0; chunk = chunk->next) {
+            if(fprintf(stack->dump_file,
+                       "\t\t---CHUNK[0x%p]---\r\n",
+                       chunk) < 0)
+                return STACK_DUMP_ERROR;
+
+            for(size_t element = 0; element < chunk->size; element++, index++) {
+                if(fprintf(stack->dump_file, "\t    [%llu] = ", index) < 0)
+                    return STACK_DUMP_ERROR;
+
+                if(stack->print_func(stack->dump_file,
+                                     chunk->data +
+                                     element *
+                                     stack->element_size) < 0)
+                    return STACK_DUMP_ERROR;
+
+                if(fprintf(stack->dump_file, ";\r\n") < 0)
+                    return STACK_DUMP_ERROR;
+            }
+        }
+
+        if(fprintf(stack->dump_file,
+                   "}\r\n\r\n") < 0)
+            return STACK_DUMP_ERROR;
+
+        fflush(stack->dump_file);
+        return STACK_SUCCESS;
+    }
+#endif
@@ -7,6 +7,9 @@
 #include "memory.h"
 #include "colors.h"
 #include "custom_assert.h"
+#include "pages.h"
+#include "dump_writer.h"
+#include "stack_dump.h"
 
 //==============================================================================
 //PROTECTION MODES ON
@@ -14,6 +17,16 @@
 #define STACK_HASH_PROTECTION
 #define STACK_CANARY_PROTECTION
 #define STACK_WRITE_DUMP
+// #define STACK_BINARY_DUMP
+// #define STACK_GUARD_PAGE_PROTECTION
+
+#if defined(STACK_GUARD_PAGE_PROTECTION) && defined(STACK_CANARY_PROTECTION)
+    #error "Guard pages replace canaries, turn STACK_CANARY_PROTECTION off"
+#endif
+
+#if defined(STACK_BINARY_DUMP) && !defined(STACK_WRITE_DUMP)
+    #error "Binary dump is a format of dump, turn STACK_WRITE_DUMP on"
+#endif
 
 //==============================================================================
 //OPERATIONS WITH STACK
@@ -56,9 +69,22 @@ enum stack_operation_t {
 //==============================================================================
 //FUNCTIONS PROTOTYPES
 //==============================================================================
+static stack_t *     stack_construct (stack_t *stack,
+                                      STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                                          const char *initialized_file,
+                                                          const char *initialized_varname,
+                                                          const char *initialized_function,
+                                                          size_t      initialized_line,
+                                                          int       (*print_func)(FILE *, void *),)
+                                      size_t   capacity,
+                                      size_t   element_size);
 static stack_error_t stack_check_size(stack_t **        stack,
                                       stack_operation_t operation);
+static stack_error_t stack_resize    (stack_t **        stack,
+                                      size_t            new_capacity);
 static stack_error_t stack_verify    (stack_t *stack);
+static bool          policy_is_valid (const stack_policy_t *policy);
+static size_t        stack_max_capacity(size_t element_size);
 
 //==============================================================================
 //STACK WRITE DUMP MODE
@@ -82,10 +108,15 @@ static stack_error_t stack_verify    (stack_t *stack);
     static const char *TEXT_STACK_UNEXPECTED_DATA_RIGHT_CANARY = "STACK_UNEXPECTED_DATA_RIGHT_CANARY";
     static const char *TEXT_STACK_UNEXPECTED_STRUCTURE_HASH    = "STACK_UNEXPECTED_STRUCTURE_HASH"   ;
     static const char *TEXT_STACK_UNEXPECTED_DATA_HASH         = "STACK_UNEXPECTED_DATA_HASH"        ;
+    static const char *TEXT_STACK_OVERFLOW                     = "STACK_OVERFLOW"                    ;
+    static const char *TEXT_STACK_INVALID_POLICY               = "STACK_INVALID_POLICY"              ;
 
-    static const char *  get_error_text           (stack_error_t error);
-    static stack_error_t stack_write_members      (stack_t *stack);
-    static stack_error_t write_stack_members_flags(stack_t *stack);
+    #ifdef STACK_BINARY_DUMP
+        static const size_t stack_dump_buffer_size = 256 * 1024;
+    #else
+        static stack_error_t stack_write_members      (stack_t *stack);
+        static stack_error_t write_stack_members_flags(stack_t *stack);
+    #endif
 #else
     #define STACK_DUMP(...)
 #endif
@@ -135,6 +166,23 @@ static stack_error_t stack_verify    (stack_t *stack);
     #define STACK_UPDATE_CANARY(__stack_pointer)
 #endif
 
+//==============================================================================
+//PROTECTION OF STACK WITH GUARD PAGES MODE
+//DATA IS PLACED ON ITS OWN PAGES BETWEEN TWO NO ACCESS PAGES, SO OVERFLOW AND
+//UNDERFLOW WRITES FAULT IMMEDIATELY WITHOUT ANY CHECKS ON STACK OPERATIONS
+//==============================================================================
+#ifdef STACK_GUARD_PAGE_PROTECTION
+    static stack_error_t        stack_map_data   (stack_t *stack,
+                                                  size_t   capacity);
+    static stack_error_t        stack_add_guarded(stack_t *stack);
+    static void                 stack_del_guarded(stack_t *stack);
+    static pages_fault_action_t stack_guard_fault(void    *fault_address,
+                                                  void    *context);
+
+    static stack_t *guarded_stacks       = NULL ;
+    static bool     guard_handler_is_set = false;
+#endif
+
 //==============================================================================
 //THE DEFINITION OF STACK STRUCTURE
 //==============================================================================
@@ -152,7 +200,11 @@ struct stack_t {
     #endif
 
     #ifdef STACK_WRITE_DUMP
-        FILE *      dump_file;
+        #ifdef STACK_BINARY_DUMP
+            dump_writer_t *dump_writer;
+        #else
+            FILE *         dump_file;
+        #endif
         const char *dump_filename;
         const char *initialized_file;
         const char *initialized_varname;
@@ -161,11 +213,21 @@ struct stack_t {
         int       (*print_func)(FILE *, void *);
     #endif
 
-    size_t size;
-    size_t capacity;
-    size_t init_capacity;
-    size_t element_size;
-    char * data;
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        char *   mapping;
+        size_t   mapping_size;
+        stack_t *next_guarded;
+    #endif
+
+    size_t         size;
+    size_t         capacity;
+    size_t         init_capacity;
+    size_t         peak_size;
+    size_t         reallocations;
+    size_t         element_size;
+    stack_policy_t policy;
+    bool           is_external_storage;
+    char *         data;
 
     #ifdef STACK_CANARY_PROTECTION
         canary_t structure_right_canary;
@@ -196,61 +258,104 @@ stack_t *stack_init(STACK_WRITE_DUMP_ON(const char *dump_filename,
         C_ASSERT(print_func           != NULL, return NULL);
     #endif
 
-    size_t allocation_size = sizeof(stack_t) + capacity * element_size;
-
-    #ifdef STACK_CANARY_PROTECTION
-        size_t alignment_offset = calculate_alignment_offset(capacity, element_size);
-        allocation_size += alignment_offset + 2 * sizeof(canary_t);
-    #endif
+    if(capacity > stack_max_capacity(element_size))
+        return NULL;
 
-    stack_t *stack = (stack_t *)_calloc(allocation_size, 1);
+    stack_t *stack = (stack_t *)_calloc_tagged(MEMORY_TAG_STACK,
+                                                stack_storage_size(capacity, element_size),
+                                                1);
     if(stack == NULL)
         return NULL;
 
-    stack->capacity      = capacity    ;
-    stack->element_size  = element_size;
-    stack->init_capacity = capacity    ;
-    stack->data = (char *)stack + sizeof(stack_t);
-
-    #ifdef STACK_CANARY_PROTECTION
-        stack->data              = stack->data + sizeof(canary_t);
-        stack->alignment_offset  = alignment_offset;
-    #endif
+    return stack_construct(stack,
+                           STACK_WRITE_DUMP_ON(dump_filename,
+                                               initialized_file,
+                                               initialized_varname,
+                                               initialized_function,
+                                               initialized_line,
+                                               print_func,)
+                           capacity,
+                           element_size);
+}
 
+//------------------------------------------------------------------------------
+//INITIALIZES STACK IN CALLER-OWNED STORAGE
+//STACK GETS THE BIGGEST CAPACITY THAT FITS STORAGE AND IS PINNED TO IT,
+//PUSH TO FULL STACK RETURNS STACK_OVERFLOW, DESTROY DOES NOT FREE STORAGE
+//------------------------------------------------------------------------------
+stack_t *stack_init_in_place(STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                                 const char *initialized_file,
+                                                 const char *initialized_varname,
+                                                 const char *initialized_function,
+                                                 size_t      initialized_line,
+                                                 int       (*print_func)(FILE *, void *),)
+                             void * storage,
+                             size_t storage_size,
+                             size_t element_size) {
+    C_ASSERT(storage      != NULL, return NULL);
+    C_ASSERT(element_size != 0   , return NULL);
     #ifdef STACK_WRITE_DUMP
-        stack->dump_filename        = dump_filename       ;
-        stack->initialized_file     = initialized_file    ;
-        stack->initialized_varname  = initialized_varname ;
-        stack->initialized_function = initialized_function;
-        stack->initialized_line     = initialized_line    ;
-        stack->print_func           = print_func          ;
+        C_ASSERT(dump_filename        != NULL, return NULL);
+        C_ASSERT(initialized_file     != NULL, return NULL);
+        C_ASSERT(initialized_varname  != NULL, return NULL);
+        C_ASSERT(initialized_function != NULL, return NULL);
+        C_ASSERT(print_func           != NULL, return NULL);
+    #endif
 
-        stack->dump_file = fopen(stack->dump_filename, "wb");
-        if(stack->dump_file == NULL) {
-            stack_destroy(&stack);
-            return NULL;
-        }
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        //guarded data always lives on its own pages
+        return NULL;
     #endif
 
-    #ifdef STACK_HASH_PROTECTION
-        if(stack_update_hash(stack) != STACK_SUCCESS) {
-            stack_destroy(&stack);
-            return NULL;
-        }
+    if((uintptr_t)storage % alignof(stack_t) != 0)
+        return NULL;
+
+    if(storage_size < stack_storage_size(0, element_size))
+        return NULL;
+
+    size_t capacity = (storage_size - stack_storage_size(0, element_size)) / element_size;
+    if(capacity > stack_max_capacity(element_size))
+        capacity = stack_max_capacity(element_size);
+    while(stack_storage_size(capacity, element_size) > storage_size)
+        capacity--;
+
+    if(memset(storage, 0, stack_storage_size(capacity, element_size)) != storage)
+        return NULL;
+
+    stack_t *stack = (stack_t *)storage;
+    stack->is_external_storage = true;
+
+    return stack_construct(stack,
+                           STACK_WRITE_DUMP_ON(dump_filename,
+                                               initialized_file,
+                                               initialized_varname,
+                                               initialized_function,
+                                               initialized_line,
+                                               print_func,)
+                           capacity,
+                           element_size);
+}
+
+//------------------------------------------------------------------------------
+//RETURNS NUMBER OF BYTES NEEDED FOR STACK WITH CAPACITY ELEMENTS
+//------------------------------------------------------------------------------
+size_t stack_storage_size(size_t capacity, size_t element_size) {
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        return sizeof(stack_t);
     #endif
 
+    //too big stack can not be allocated, the biggest size fails allocation
+    if(element_size != 0 && capacity > stack_max_capacity(element_size))
+        return SIZE_MAX;
+
+    size_t storage_size = sizeof(stack_t) + capacity * element_size;
+
     #ifdef STACK_CANARY_PROTECTION
-        if(stack_update_canary(stack) != STACK_SUCCESS) {
-            stack_destroy(&stack);
-            return NULL;
-        }
+        storage_size += calculate_alignment_offset(capacity, element_size) +
+                        2 * sizeof(canary_t);
     #endif
 
-    if(stack_verify(stack) != STACK_SUCCESS) {
-        stack_destroy(&stack);
-        return NULL;
-    }
-    return stack;
+    return storage_size;
 }
 
 //------------------------------------------------------------------------------
@@ -261,6 +366,11 @@ stack_error_t stack_push(stack_t **stack, void *element) {
     C_ASSERT(element != NULL, return STACK_INVALID_INPUT);
 
     STACK_VERIFY(*stack);
+
+    if((*stack)->policy.is_pinned &&
+       (*stack)->size == (*stack)->capacity)
+        return STACK_OVERFLOW;
+
     STACK_CHECK_SIZE(stack, STACK_OPERATION_PUSH);
 
     char *stack_storage = (*stack)->data +
@@ -272,6 +382,8 @@ stack_error_t stack_push(stack_t **stack, void *element) {
         STACK_RETURN_ERROR(*stack, STACK_MEMORY_ERROR);
 
     (*stack)->size++;
+    if((*stack)->peak_size < (*stack)->size)
+        (*stack)->peak_size = (*stack)->size;
 
     STACK_UPDATE_HASH  (*stack);
     STACK_UPDATE_CANARY(*stack);
@@ -331,18 +443,188 @@ stack_error_t stack_destroy(stack_t **stack) {
     if(*stack == NULL)
         return STACK_SUCCESS;
 
-    STACK_WRITE_DUMP_ON(fclose((*stack)->dump_file));
-    _free(*stack);
-    _memory_destroy_log();
+    #ifdef STACK_BINARY_DUMP
+        dump_writer_close(&(*stack)->dump_writer);
+    #elif defined(STACK_WRITE_DUMP)
+        if((*stack)->dump_file != NULL)
+            fclose((*stack)->dump_file);
+    #endif
+
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        stack_del_guarded(*stack);
+        pages_unmap((*stack)->mapping, (*stack)->mapping_size);
+    #endif
+
+    if(!(*stack)->is_external_storage)
+        _free(*stack);
 
     *stack = NULL;
     return STACK_SUCCESS;
 }
 
+//------------------------------------------------------------------------------
+//RETURNS NUMBER OF ELEMENTS IN STACK
+//------------------------------------------------------------------------------
+size_t stack_get_size(const stack_t *stack) {
+    C_ASSERT(stack != NULL, return 0);
+
+    return stack->size;
+}
+
+//------------------------------------------------------------------------------
+//WRITES PEAK SIZE AND NUMBER OF REALLOCATIONS OF STACK TO STATS
+//------------------------------------------------------------------------------
+stack_error_t stack_get_stats(const stack_t *stack, stack_stats_t *stats) {
+    C_ASSERT(stack != NULL, return STACK_NULL          );
+    C_ASSERT(stats != NULL, return STACK_INVALID_OUTPUT);
+
+    stats->peak_size     = stack->peak_size;
+    stats->reallocations = stack->reallocations;
+    return STACK_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+//EXPANDS STACK SO THAT IT CAN HOLD AT LEAST CAPACITY ELEMENTS
+//------------------------------------------------------------------------------
+stack_error_t stack_reserve(stack_t **stack, size_t capacity) {
+    C_ASSERT(stack != NULL, return STACK_NULL);
+
+    STACK_VERIFY(*stack);
+
+    if(capacity <= (*stack)->capacity)
+        return STACK_SUCCESS;
+
+    if((*stack)->is_external_storage)
+        return STACK_OVERFLOW;
+
+    return stack_resize(stack, capacity);
+}
+
+//------------------------------------------------------------------------------
+//SHRINKS STACK CAPACITY TO ITS SIZE, BUT NOT BELOW POLICY MIN CAPACITY
+//------------------------------------------------------------------------------
+stack_error_t stack_shrink_to_fit(stack_t **stack) {
+    C_ASSERT(stack != NULL, return STACK_NULL);
+
+    STACK_VERIFY(*stack);
+
+    size_t new_capacity = (*stack)->size;
+    if(new_capacity < (*stack)->policy.min_capacity)
+        new_capacity = (*stack)->policy.min_capacity;
+
+    if(new_capacity >= (*stack)->capacity ||
+       (*stack)->is_external_storage)
+        return STACK_SUCCESS;
+
+    return stack_resize(stack, new_capacity);
+}
+
+//------------------------------------------------------------------------------
+//SETS CAPACITY POLICY, RESERVES MIN CAPACITY OF POLICY
+//------------------------------------------------------------------------------
+stack_error_t stack_set_policy(stack_t **stack, const stack_policy_t *policy) {
+    C_ASSERT(stack  != NULL, return STACK_NULL         );
+    C_ASSERT(policy != NULL, return STACK_INVALID_INPUT);
+
+    STACK_VERIFY(*stack);
+
+    if(!policy_is_valid(policy))
+        return STACK_INVALID_POLICY;
+
+    if((*stack)->is_external_storage && !policy->is_pinned)
+        return STACK_INVALID_POLICY;
+
+    (*stack)->policy = *policy;
+    STACK_UPDATE_HASH(*stack);
+
+    return stack_reserve(stack, policy->min_capacity);
+}
+
 //==============================================================================
 //STATIC FUNCTIONS
 //==============================================================================
 
+//------------------------------------------------------------------------------
+//FILLS STACK STRUCTURE IN ZEROED MEMORY OF stack_storage_size(...) BYTES,
+//ARGUMENTS ARE CHECKED BY CALLER BEFORE MEMORY IS TAKEN
+//------------------------------------------------------------------------------
+stack_t *stack_construct(stack_t *stack,
+                         STACK_WRITE_DUMP_ON(const char *dump_filename,
+                                             const char *initialized_file,
+                                             const char *initialized_varname,
+                                             const char *initialized_function,
+                                             size_t      initialized_line,
+                                             int       (*print_func)(FILE *, void *),)
+                         size_t   capacity,
+                         size_t   element_size) {
+    stack->capacity            = capacity            ;
+    stack->element_size        = element_size        ;
+    stack->init_capacity       = capacity            ;
+    stack->policy              = stack_default_policy;
+    stack->policy.min_capacity = capacity            ;
+    stack->policy.is_pinned    = stack->is_external_storage;
+    stack->data = (char *)stack + sizeof(stack_t);
+
+    #ifdef STACK_CANARY_PROTECTION
+        stack->data              = stack->data + sizeof(canary_t);
+        stack->alignment_offset  = calculate_alignment_offset(capacity, element_size);
+    #endif
+
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        stack->data = NULL;
+        if(stack_map_data(stack, capacity) != STACK_SUCCESS ||
+           stack_add_guarded(stack)        != STACK_SUCCESS) {
+            stack_destroy(&stack);
+            return NULL;
+        }
+        stack->init_capacity       = stack->capacity;
+        stack->policy.min_capacity = stack->capacity;
+    #endif
+
+    #ifdef STACK_WRITE_DUMP
+        stack->dump_filename        = dump_filename       ;
+        stack->initialized_file     = initialized_file    ;
+        stack->initialized_varname  = initialized_varname ;
+        stack->initialized_function = initialized_function;
+        stack->initialized_line     = initialized_line    ;
+        stack->print_func           = print_func          ;
+
+        #ifdef STACK_BINARY_DUMP
+            stack->dump_writer = dump_writer_open(stack->dump_filename, stack_dump_buffer_size);
+            if(stack->dump_writer == NULL) {
+                stack_destroy(&stack);
+                return NULL;
+            }
+        #else
+            stack->dump_file = fopen(stack->dump_filename, "wb");
+            if(stack->dump_file == NULL) {
+                stack_destroy(&stack);
+                return NULL;
+            }
+        #endif
+    #endif
+
+    #ifdef STACK_HASH_PROTECTION
+        if(stack_update_hash(stack) != STACK_SUCCESS) {
+            stack_destroy(&stack);
+            return NULL;
+        }
+    #endif
+
+    #ifdef STACK_CANARY_PROTECTION
+        if(stack_update_canary(stack) != STACK_SUCCESS) {
+            stack_destroy(&stack);
+            return NULL;
+        }
+    #endif
+
+    if(stack_verify(stack) != STACK_SUCCESS) {
+        stack_destroy(&stack);
+        return NULL;
+    }
+    return stack;
+}
+
 //------------------------------------------------------------------------------
 //CHECKS IF SIZE OF STACK IS SUFFICIENT
 //------------------------------------------------------------------------------
@@ -353,21 +635,34 @@ stack_error_t stack_check_size(stack_t **        stack,
 
     STACK_VERIFY(*stack);
 
-    size_t new_capacity = 0;
+    const stack_policy_t *policy       = &(*stack)->policy;
+    size_t                new_capacity = 0;
+
+    if(policy->is_pinned)
+        return STACK_SUCCESS;
 
     switch(operation) {
         case STACK_OPERATION_PUSH: {
             if((*stack)->size < (*stack)->capacity)
                 return STACK_SUCCESS;
-            new_capacity = (*stack)->capacity * 2;
+            if((*stack)->capacity >= stack_max_capacity((*stack)->element_size))
+                return STACK_OVERFLOW;
+            new_capacity = (*stack)->capacity * policy->growth_factor;
+            if((*stack)->capacity > stack_max_capacity((*stack)->element_size) / policy->growth_factor)
+                new_capacity = stack_max_capacity((*stack)->element_size);
+            if(new_capacity < policy->min_capacity)
+                new_capacity = policy->min_capacity;
+            if(new_capacity <= (*stack)->size)
+                new_capacity = (*stack)->size + 1;
             break;
         }
         case STACK_OPERATION_POP:  {
-            if((*stack)->size % 4      != 0 ||
-               (*stack)->size * 4      >= (*stack)->capacity ||
-               (*stack)->init_capacity == (*stack)->capacity)
+            if((*stack)->size > (*stack)->capacity / policy->shrink_threshold ||
+               (*stack)->capacity <= policy->min_capacity)
                 return STACK_SUCCESS;
-            new_capacity = (*stack)->capacity / 4;
+            new_capacity = (*stack)->capacity / policy->shrink_factor;
+            if(new_capacity < policy->min_capacity)
+                new_capacity = policy->min_capacity;
             break;
         }
         default:                   {
@@ -375,6 +670,34 @@ stack_error_t stack_check_size(stack_t **        stack,
         }
     }
 
+    return stack_resize(stack, new_capacity);
+}
+
+//------------------------------------------------------------------------------
+//REALLOCATES STACK TO NEW CAPACITY
+//------------------------------------------------------------------------------
+stack_error_t stack_resize(stack_t **stack,
+                           size_t    new_capacity) {
+    if(stack == NULL)
+        return STACK_NULL;
+
+    if(new_capacity < (*stack)->size)
+        return STACK_INVALID_CAPACITY;
+
+    if(new_capacity > stack_max_capacity((*stack)->element_size))
+        return STACK_OVERFLOW;
+
+    #ifdef STACK_GUARD_PAGE_PROTECTION
+        stack_error_t mapping_error = stack_map_data(*stack, new_capacity);
+        if(mapping_error != STACK_SUCCESS)
+            return mapping_error;
+
+        (*stack)->reallocations++;
+        STACK_UPDATE_HASH(*stack);
+        STACK_VERIFY     (*stack);
+        return STACK_SUCCESS;
+    #endif
+
     #ifdef STACK_CANARY_PROTECTION
         size_t offset = calculate_alignment_offset(new_capacity,
                                                    (*stack)->element_size);
@@ -398,11 +721,12 @@ stack_error_t stack_check_size(stack_t **        stack,
         return STACK_MEMORY_ERROR;
 
     #ifdef STACK_CANARY_PROTECTION
-        if(operation == STACK_OPERATION_PUSH) {
+        if(new_capacity > new_stack->capacity) {
             canary_t *old_canary = (canary_t *)((char *)(new_stack + 1) +
                                                 sizeof(canary_t) +
                                                 new_stack->capacity *
-                                                new_stack->element_size);
+                                                new_stack->element_size +
+                                                new_stack->alignment_offset);
             *old_canary = 0;
         }
     #endif
@@ -410,6 +734,7 @@ stack_error_t stack_check_size(stack_t **        stack,
     *stack = new_stack;
     new_stack->capacity = new_capacity           ;
     new_stack->data     = (char *)(new_stack + 1);
+    new_stack->reallocations++;
 
     #ifdef STACK_CANARY_PROTECTION
         new_stack->data             += sizeof(canary_t);
@@ -422,6 +747,31 @@ stack_error_t stack_check_size(stack_t **        stack,
     return STACK_SUCCESS;
 }
 
+//------------------------------------------------------------------------------
+//RETURNS THE BIGGEST CAPACITY, HALF OF ADDRESS SPACE LEAVES ROOM FOR STRUCTURE,
+//CANARIES AND GUARD PAGES, SO SIZES OF STACK NEVER OVERFLOW
+//------------------------------------------------------------------------------
+size_t stack_max_capacity(size_t element_size) {
+    return SIZE_MAX / 2 / element_size;
+}
+
+//------------------------------------------------------------------------------
+//CHECKS THAT POLICY CAN NOT SHRINK STACK RIGHT AFTER GROWTH AND VICE VERSA
+//------------------------------------------------------------------------------
+bool policy_is_valid(const stack_policy_t *policy) {
+    if(policy->growth_factor < 2)
+        return false;
+
+    if(policy->shrink_factor < 2)
+        return false;
+
+    if(policy->shrink_threshold <= policy->growth_factor ||
+       policy->shrink_threshold <= policy->shrink_factor)
+        return false;
+
+    return true;
+}
+
 //------------------------------------------------------------------------------
 //CHECKS IF STACK IS VALID
 //------------------------------------------------------------------------------
@@ -442,8 +792,13 @@ stack_error_t stack_verify(stack_t *stack) {
         stack_error_t canary_state = stack_verify_canaries(stack);
         if(canary_state != STACK_SUCCESS)
             return canary_state;
+    #elif defined(STACK_GUARD_PAGE_PROTECTION)
+        if(stack->data <  stack->mapping + pages_size() ||
+           stack->data +  stack->capacity * stack->element_size >
+           stack->mapping + stack->mapping_size - pages_size())
+            return STACK_INVALID_DATA;
     #else
-        if(stack->data != stack + 1)
+        if(stack->data != (char *)(stack + 1))
             return STACK_INVALID_DATA;
     #endif
 
@@ -453,7 +808,10 @@ stack_error_t stack_verify(stack_t *stack) {
             return hash_state;
     #endif
 
-    #ifdef STACK_WRITE_DUMP
+    #ifdef STACK_BINARY_DUMP
+        if(stack->dump_writer == NULL)
+            return STACK_DUMP_ERROR;
+    #elif defined(STACK_WRITE_DUMP)
         if(stack->dump_file == NULL)
             return STACK_DUMP_ERROR;
     #endif
@@ -465,174 +823,274 @@ stack_error_t stack_verify(stack_t *stack) {
 //STACK WRITE DUMP MODE FUNCTIONS DEFINITION
 //==============================================================================
 #ifdef STACK_WRITE_DUMP
-    //------------------------------------------------------------------------------
-    //WRITES STACK INFORMATION IN DUMP FILE
-    //------------------------------------------------------------------------------
-    stack_error_t stack_dump(stack_t *stack,
-                             const char *file_name,
-                             const char *function_name,
-                             size_t line,
-                             stack_error_t call_reason) {
-        if(stack->dump_file == NULL) {
-            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
-                         "MEMORY DUMP FILE ERROR\r\n"
-                         "called from: %s:%llu\r\n",
-                         file_name,
-                         line);
-            return STACK_DUMP_ERROR;
-        }
-
-        if(fprintf(stack->dump_file,
-                   "stack_t[0x%p] initialized in %s:%llu as "
-                   "'stack_t %s' in function '%s'\r\n"
-                   "dump called from %s:%llu '%s'\r\n"
-                   "ERROR = ",
-                   stack,
-                   stack->initialized_file,
-                   stack->initialized_line,
-                   stack->initialized_varname,
-                   stack->initialized_function,
-                   file_name,
-                   line,
-                   function_name) < 0)
-            return STACK_DUMP_ERROR;
-
-        const char *error_definition = get_error_text(call_reason);
-        if(error_definition == NULL)
-            error_definition = "'unknown error'";
+    #ifdef STACK_BINARY_DUMP
+        //------------------------------------------------------------------------------
+        //WRITES STACK INFORMATION AS BINARY RECORD, HEADER, STRINGS AND DATA ARE
+        //COPIED TO DUMP WRITER BUFFER WITH ONE WRITE, FILE IS WRITTEN BY BACKGROUND
+        //THREAD. TEXT FORM IS RENDERED BY DUMP_VIEWER
+        //------------------------------------------------------------------------------
+        stack_error_t stack_dump(stack_t      *stack,
+                                 const char   *file_name,
+                                 const char   *function_name,
+                                 size_t        line,
+                                 stack_error_t call_reason) {
+            if(stack == NULL)
+                return STACK_NULL;
+
+            if(stack->dump_writer == NULL) {
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "MEMORY DUMP FILE ERROR\r\n"
+                             "called from: %s:%llu\r\n",
+                             file_name,
+                             line);
+                return STACK_DUMP_ERROR;
+            }
 
-        if(fprintf(stack->dump_file,
-                   "'%s'\r\n",
-                   error_definition) < 0)
-            return STACK_DUMP_ERROR;
+            stack_dump_record_t record = {};
+            record.signature                   = stack_dump_signature;
+            record.stack_address               = (uint64_t)(uintptr_t)stack;
+            record.data_address                = (uint64_t)(uintptr_t)stack->data;
+            record.call_reason                 = call_reason;
+            record.initialized_line            = stack->initialized_line;
+            record.line                        = line;
+            record.size                        = stack->size;
+            record.capacity                    = stack->capacity;
+            record.element_size                = stack->element_size;
+            record.growth_factor               = stack->policy.growth_factor;
+            record.shrink_threshold            = stack->policy.shrink_threshold;
+            record.shrink_factor               = stack->policy.shrink_factor;
+            record.min_capacity                = stack->policy.min_capacity;
+            record.is_pinned                   = stack->policy.is_pinned;
+            record.initialized_file_length     = strlen(stack->initialized_file    );
+            record.initialized_varname_length  = strlen(stack->initialized_varname );
+            record.initialized_function_length = strlen(stack->initialized_function);
+            record.file_name_length            = strlen(file_name                  );
+            record.function_name_length        = strlen(function_name              );
+
+            #ifdef STACK_CANARY_PROTECTION
+                record.flags                    |= STACK_DUMP_HAS_CANARIES;
+                record.structure_left_canary     = stack->structure_left_canary;
+                record.data_left_canary_address  = (uint64_t)(uintptr_t)stack->data_left_canary;
+                record.data_left_canary          = *(stack->data_left_canary);
+                record.data_right_canary_address = (uint64_t)(uintptr_t)stack->data_right_canary;
+                record.data_right_canary         = *(stack->data_right_canary);
+                record.structure_right_canary    = stack->structure_right_canary;
+            #endif
+
+            #ifdef STACK_HASH_PROTECTION
+                record.flags                    |= STACK_DUMP_HAS_HASHES;
+                record.structure_hash            = stack->structure_hash;
+                record.data_hash                 = stack->data_hash;
+            #endif
+
+            size_t data_size = 0;
+            if(stack->data != NULL && stack->size <= stack->capacity) {
+                record.flags |= STACK_DUMP_HAS_DATA;
+                data_size     = stack->capacity * stack->element_size;
+            }
 
-        if(stack == NULL)
-            return STACK_NULL;
+            dump_writer_part_t parts[] = {
+                {&record                    , sizeof(record)                    },
+                {stack->initialized_file    , record.initialized_file_length    },
+                {stack->initialized_varname , record.initialized_varname_length },
+                {stack->initialized_function, record.initialized_function_length},
+                {file_name                  , record.file_name_length           },
+                {function_name              , record.function_name_length       },
+                {stack->data                , data_size                         },
+            };
+
+            for(size_t part = 0; part < sizeof(parts) / sizeof(parts[0]); part++)
+                record.record_size += parts[part].size;
+
+            if(dump_writer_write(stack->dump_writer,
+                                 parts,
+                                 sizeof(parts) / sizeof(parts[0])) != DUMP_WRITER_SUCCESS)
+                return STACK_DUMP_ERROR;
 
-        #ifdef STACK_CANARY_PROTECTION
-            if(fprintf(stack->dump_file,
-                       "{\r\n"
-                       "\t\t---CANARIES---\r\n"
-                       "\tcanary_left       = 0x%llx;\r\n"
-                       "\tdata_canary_left [0x%p] = 0x%llx;\r\n"
-                       "\tdata_canary_right[0x%p] = 0x%llx;\r\n"
-                       "\tcanary_right      = 0x%llx;\r\n",
-                       stack->structure_left_canary,
-                       stack->data_left_canary,
-                       *(stack->data_left_canary),
-                       stack->data_right_canary,
-                       *(stack->data_right_canary),
-                       stack->structure_right_canary) < 0)
+            return STACK_SUCCESS;
+        }
+    #else
+        //------------------------------------------------------------------------------
+        //WRITES STACK INFORMATION IN DUMP FILE
+        //------------------------------------------------------------------------------
+        stack_error_t stack_dump(stack_t *stack,
+                                 const char *file_name,
+                                 const char *function_name,
+                                 size_t line,
+                                 stack_error_t call_reason) {
+            if(stack->dump_file == NULL) {
+                color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                             "MEMORY DUMP FILE ERROR\r\n"
+                             "called from: %s:%llu\r\n",
+                             file_name,
+                             line);
                 return STACK_DUMP_ERROR;
-        #endif
+            }
 
-        #ifdef STACK_HASH_PROTECTION
             if(fprintf(stack->dump_file,
-                       "\t\t---HASHES---\r\n"
-                       "\tstructure_hash    = 0x%llx;\r\n"
-                       "\tdata_hash         = 0x%llx;\r\n",
-                       stack->structure_hash,
-                       stack->data_hash) < 0)
+                       "stack_t[0x%p] initialized in %s:%llu as "
+                       "'stack_t %s' in function '%s'\r\n"
+                       "dump called from %s:%llu '%s'\r\n"
+                       "ERROR = ",
+                       stack,
+                       stack->initialized_file,
+                       stack->initialized_line,
+                       stack->initialized_varname,
+                       stack->initialized_function,
+                       file_name,
+                       line,
+                       function_name) < 0)
                 return STACK_DUMP_ERROR;
-        #endif
 
-        if(fprintf(stack->dump_file,
-                   "\t\t---DEFAULT_INFO---\r\n"
-                   "\tsize              =   %llu;\r\n"
-                   "\tcapacity          =   %llu;\r\n"
-                   "\telement_size      =   %llu;\r\n"
-                   "\t\t---MEMBERS---\r\n"
-                   "\tdata[0x%p]:\r\n",
-                   stack->size,
-                   stack->capacity,
-                   stack->element_size,
-                   stack->data) < 0)
-            return STACK_DUMP_ERROR;
+            const char *error_definition = stack_error_text(call_reason);
+            if(error_definition == NULL)
+                error_definition = "'unknown error'";
 
-        stack_error_t members_writing_state = stack_write_members(stack);
-        if(members_writing_state != STACK_SUCCESS)
-            return members_writing_state;
+            if(fprintf(stack->dump_file,
+                       "'%s'\r\n",
+                       error_definition) < 0)
+                return STACK_DUMP_ERROR;
 
-        if(fprintf(stack->dump_file,
-                   "}\r\n\r\n") < 0)
-            return STACK_DUMP_ERROR;
+            if(stack == NULL)
+                return STACK_NULL;
+
+            #ifdef STACK_CANARY_PROTECTION
+                if(fprintf(stack->dump_file,
+                           "{\r\n"
+                           "\t\t---CANARIES---\r\n"
+                           "\tcanary_left       = 0x%llx;\r\n"
+                           "\tdata_canary_left [0x%p] = 0x%llx;\r\n"
+                           "\tdata_canary_right[0x%p] = 0x%llx;\r\n"
+                           "\tcanary_right      = 0x%llx;\r\n",
+                           stack->structure_left_canary,
+                           stack->data_left_canary,
+                           *(stack->data_left_canary),
+                           stack->data_right_canary,
+                           *(stack->data_right_canary),
+                           stack->structure_right_canary) < 0)
+                    return STACK_DUMP_ERROR;
+            #endif
+
+            #ifdef STACK_HASH_PROTECTION
+                if(fprintf(stack->dump_file,
+                           "\t\t---HASHES---\r\n"
+                           "\tstructure_hash    = 0x%llx;\r\n"
+                           "\tdata_hash         = 0x%llx;\r\n",
+                           stack->structure_hash,
+                           stack->data_hash) < 0)
+                    return STACK_DUMP_ERROR;
+            #endif
 
-        fflush(stack->dump_file);
-        return STACK_SUCCESS;
-    }
-
-    //------------------------------------------------------------------------------
-    //WRITES STACK MEMBERS
-    //------------------------------------------------------------------------------
-    stack_error_t stack_write_members(stack_t *stack) {
-        if(stack->data == NULL          ) {
             if(fprintf(stack->dump_file,
-                       "\t\t--- (POISON)\r\n") < 0)
+                       "\t\t---DEFAULT_INFO---\r\n"
+                       "\tsize              =   %llu;\r\n"
+                       "\tcapacity          =   %llu;\r\n"
+                       "\telement_size      =   %llu;\r\n"
+                       "\t\t---POLICY---\r\n"
+                       "\tgrowth_factor     =   %llu;\r\n"
+                       "\tshrink_threshold  =   %llu;\r\n"
+                       "\tshrink_factor     =   %llu;\r\n"
+                       "\tmin_capacity      =   %llu;\r\n"
+                       "\tis_pinned         =   %d;\r\n"
+                       "\t\t---MEMBERS---\r\n"
+                       "\tdata[0x%p]:\r\n",
+                       stack->size,
+                       stack->capacity,
+                       stack->element_size,
+                       stack->policy.growth_factor,
+                       stack->policy.shrink_threshold,
+                       stack->policy.shrink_factor,
+                       stack->policy.min_capacity,
+                       stack->policy.is_pinned,
+                       stack->data) < 0)
                 return STACK_DUMP_ERROR;
 
-            return STACK_SUCCESS;
-        }
-        if(stack->size > stack->capacity) {
+            stack_error_t members_writing_state = stack_write_members(stack);
+            if(members_writing_state != STACK_SUCCESS)
+                return members_writing_state;
+
             if(fprintf(stack->dump_file,
-                       "\t\tincorrect size\r\n") < 0)
+                       "}\r\n\r\n") < 0)
                 return STACK_DUMP_ERROR;
 
+            fflush(stack->dump_file);
             return STACK_SUCCESS;
         }
 
-        stack_error_t printing_error = write_stack_members_flags(stack);
-        if(printing_error != STACK_SUCCESS)
-            return printing_error;
+        //------------------------------------------------------------------------------
+        //WRITES STACK MEMBERS
+        //------------------------------------------------------------------------------
+        stack_error_t stack_write_members(stack_t *stack) {
+            if(stack->data == NULL          ) {
+                if(fprintf(stack->dump_file,
+                           "\t\t--- (POISON)\r\n") < 0)
+                    return STACK_DUMP_ERROR;
 
-        return STACK_SUCCESS;
-    }
-
-    //------------------------------------------------------------------------------
-    //WRITES STACK MEMBERS WITH * BEFORE INDEX AND (POISON) AFTER ELEMENT IF IT IS
-    //------------------------------------------------------------------------------
-    stack_error_t write_stack_members_flags(stack_t *stack) {
-        const char * const POISON_ELEMENT_FLAG = " (POISON)";
-        const char * const NORMAL_ELEMENT_FLAG = ""         ;
-        const char * const POISON_INDEX_FLAG   = "*"        ;
-        const char * const NORMAL_INDEX_FLAG   = " "        ;
-
-        for(size_t element = 0; element < stack->capacity; element++) {
-            const char *index_flag = NULL;
-            const char *element_flag = NULL;
-
-            if(element < stack->size) {
-                index_flag = NORMAL_INDEX_FLAG;
-                element_flag = NORMAL_ELEMENT_FLAG;
+                return STACK_SUCCESS;
             }
-            else{
-                index_flag = POISON_INDEX_FLAG;
-                element_flag = POISON_ELEMENT_FLAG;
+            if(stack->size > stack->capacity) {
+                if(fprintf(stack->dump_file,
+                           "\t\tincorrect size\r\n") < 0)
+                    return STACK_DUMP_ERROR;
+
+                return STACK_SUCCESS;
             }
 
-            if(fprintf(stack->dump_file,
-                       "\t   %s[%llu] = ",
-                       index_flag,
-                       element) < 0)
-                return STACK_DUMP_ERROR;
+            stack_error_t printing_error = write_stack_members_flags(stack);
+            if(printing_error != STACK_SUCCESS)
+                return printing_error;
 
-            if(stack->print_func(stack->dump_file,
-                                 (char *)stack->data +
-                                 element *
-                                 stack->element_size) < 0)
-                return STACK_DUMP_ERROR;
+            return STACK_SUCCESS;
+        }
 
-            if(fprintf(stack->dump_file,
-                       "%s;\r\n",
-                       element_flag) < 0)
-                return STACK_DUMP_ERROR;
+        //------------------------------------------------------------------------------
+        //WRITES STACK MEMBERS WITH * BEFORE INDEX AND (POISON) AFTER ELEMENT IF IT IS
+        //------------------------------------------------------------------------------
+        stack_error_t write_stack_members_flags(stack_t *stack) {
+            const char * const POISON_ELEMENT_FLAG = " (POISON)";
+            const char * const NORMAL_ELEMENT_FLAG = ""         ;
+            const char * const POISON_INDEX_FLAG   = "*"        ;
+            const char * const NORMAL_INDEX_FLAG   = " "        ;
+
+            for(size_t element = 0; element < stack->capacity; element++) {
+                const char *index_flag = NULL;
+                const char *element_flag = NULL;
+
+                if(element < stack->size) {
+                    index_flag = NORMAL_INDEX_FLAG;
+                    element_flag = NORMAL_ELEMENT_FLAG;
+                }
+                else{
+                    index_flag = POISON_INDEX_FLAG;
+                    element_flag = POISON_ELEMENT_FLAG;
+                }
+
+                if(fprintf(stack->dump_file,
+                           "\t   %s[%llu] = ",
+                           index_flag,
+                           element) < 0)
+                    return STACK_DUMP_ERROR;
+
+                if(stack->print_func(stack->dump_file,
+                                     (char *)stack->data +
+                                     element *
+                                     stack->element_size) < 0)
+                    return STACK_DUMP_ERROR;
+
+                if(fprintf(stack->dump_file,
+                           "%s;\r\n",
+                           element_flag) < 0)
+                    return STACK_DUMP_ERROR;
+            }
+            return STACK_SUCCESS;
         }
-        return STACK_SUCCESS;
-    }
+
+    #endif
 
     //------------------------------------------------------------------------------
     //RETURNS STRING WITH TEXT DEFINITION OF ERROR
     //------------------------------------------------------------------------------
-    const char *get_error_text(stack_error_t error) {
+    const char *stack_error_text(stack_error_t error) {
         switch(error) {
             case STACK_SUCCESS:
                 return TEXT_STACK_SUCCESS;
@@ -670,6 +1128,10 @@ stack_error_t stack_verify(stack_t *stack) {
                 return TEXT_STACK_UNEXPECTED_STRUCTURE_HASH;
             case STACK_UNEXPECTED_DATA_HASH:
                 return TEXT_STACK_UNEXPECTED_DATA_HASH;
+            case STACK_OVERFLOW:
+                return TEXT_STACK_OVERFLOW;
+            case STACK_INVALID_POLICY:
+                return TEXT_STACK_INVALID_POLICY;
             default:
                 return NULL;
         }
@@ -744,6 +1206,115 @@ stack_error_t stack_verify(stack_t *stack) {
     }
 #endif
 
+//==============================================================================
+//STACK GUARD PAGE PROTECTION MODE FUNCTIONS DEFINITION
+//==============================================================================
+#ifdef STACK_GUARD_PAGE_PROTECTION
+    //------------------------------------------------------------------------------
+    //MAPS DATA PAGES WITH NO ACCESS PAGE ON BOTH SIDES AND MOVES ELEMENTS THERE
+    //CAPACITY IS ROUNDED UP TO FILL DATA PAGES, DATA END TOUCHES RIGHT GUARD
+    //------------------------------------------------------------------------------
+    stack_error_t stack_map_data(stack_t *stack,
+                                 size_t   capacity) {
+        size_t page_size    = pages_size();
+        size_t data_size    = pages_round_up(capacity * stack->element_size);
+        size_t mapping_size = data_size + 2 * page_size;
+
+        char *mapping = (char *)pages_map(mapping_size, PAGES_NO_ACCESS);
+        if(mapping == NULL)
+            return STACK_MEMORY_ERROR;
+
+        if(data_size != 0 &&
+           pages_protect(mapping + page_size,
+                         data_size,
+                         PAGES_READ_WRITE) != PAGES_SUCCESS) {
+            pages_unmap(mapping, mapping_size);
+            return STACK_MEMORY_ERROR;
+        }
+
+        size_t new_capacity = data_size / stack->element_size;
+        char * new_data     = mapping + page_size + data_size -
+                              new_capacity * stack->element_size;
+
+        if(stack->data != NULL)
+            memcpy(new_data, stack->data, stack->size * stack->element_size);
+
+        pages_unmap(stack->mapping, stack->mapping_size);
+
+        stack->mapping      = mapping     ;
+        stack->mapping_size = mapping_size;
+        stack->data         = new_data    ;
+        stack->capacity     = new_capacity;
+        return STACK_SUCCESS;
+    }
+
+    //------------------------------------------------------------------------------
+    //ADDS STACK TO LIST OF STACKS CHECKED BY FAULT HANDLER
+    //------------------------------------------------------------------------------
+    stack_error_t stack_add_guarded(stack_t *stack) {
+        if(!guard_handler_is_set) {
+            if(pages_add_fault_handler(stack_guard_fault, NULL) != PAGES_SUCCESS)
+                return STACK_UNEXPECTED_ERROR;
+
+            guard_handler_is_set = true;
+        }
+
+        stack->next_guarded = guarded_stacks;
+        guarded_stacks      = stack;
+        return STACK_SUCCESS;
+    }
+
+    //------------------------------------------------------------------------------
+    //REMOVES STACK FROM LIST OF STACKS CHECKED BY FAULT HANDLER
+    //------------------------------------------------------------------------------
+    void stack_del_guarded(stack_t *stack) {
+        stack_t **link = &guarded_stacks;
+        while(*link != NULL) {
+            if(*link == stack) {
+                *link = stack->next_guarded;
+                return ;
+            }
+            link = &(*link)->next_guarded;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    //CALLED ON ACCESS VIOLATION, TREATS HIT OF GUARD PAGE AS BROKEN DATA CANARY
+    //DUMP IS WRITTEN FROM SIGNAL HANDLER, IT IS FINE AS PROCESS IS TERMINATED
+    //------------------------------------------------------------------------------
+    pages_fault_action_t stack_guard_fault(void *fault_address,
+                                           void */*context*/) {
+        char *address = (char *)fault_address;
+
+        for(stack_t *stack = guarded_stacks; stack != NULL; stack = stack->next_guarded) {
+            char *left_guard  = stack->mapping;
+            char *right_guard = stack->mapping + stack->mapping_size - pages_size();
+
+            stack_error_t error = STACK_SUCCESS;
+            if(address >= left_guard  && address < left_guard  + pages_size())
+                error = STACK_UNEXPECTED_DATA_LEFT_CANARY;
+
+            if(address >= right_guard && address < right_guard + pages_size())
+                error = STACK_UNEXPECTED_DATA_RIGHT_CANARY;
+
+            if(error == STACK_SUCCESS)
+                continue;
+
+            color_printf(RED_TEXT, BOLD_TEXT, DEFAULT_BACKGROUND,
+                         "Stack guard page was hit at 0x%p.\r\n",
+                         fault_address);
+            fflush(stdout);
+            STACK_DUMP(stack, error);
+            #ifdef STACK_BINARY_DUMP
+                dump_writer_flush(stack->dump_writer);
+            #endif
+            return PAGES_FAULT_TERMINATE;
+        }
+
+        return PAGES_FAULT_IGNORED;
+    }
+#endif
+
 //==============================================================================
 //STACK HASH PROTECTION MODE FUNCTIONS DEFINITION
 //==============================================================================
@@ -762,7 +1333,8 @@ stack_error_t stack_verify(stack_t *stack) {
     }
 
     //------------------------------------------------------------------------------
-    //FUNCTION WRITES HASHES OF STRUCTURE AND DATA
+    //FUNCTION WRITES HASHES OF STRUCTURE AND DATA. ONLY ELEMENTS IN STACK ARE
+    //HASHED, SO EVERY OPERATION DOES NOT COST THE WHOLE CAPACITY
     //------------------------------------------------------------------------------
     stack_error_t stack_calculate_hashes(stack_t *stack,
                                          hash_t * structure_hash,
@@ -775,7 +1347,7 @@ stack_error_t stack_verify(stack_t *stack) {
 
         *data_hash      = hash_function(stack->data,
                                         stack->data +
-                                        stack->capacity *
+                                        stack->size *
                                         stack->element_size);
         return STACK_SUCCESS;
     }
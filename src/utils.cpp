@@ -12,3 +12,11 @@ size_t file_size(FILE *file) {
 int file_print_double(FILE *output, void *item) {
     return fprintf(output, "%lg", *(double *)item);
 }
+
+uint64_t bytes_hash(const void *bytes, size_t size) {
+    uint64_t       hash  = 5381;
+    const uint8_t *start = (const uint8_t *)bytes;
+    for(const uint8_t *byte = start; byte < start + size; byte++)
+        hash = (hash << 5) + hash + *byte;
+    return hash;
+}